@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Compare two results.json files written by run_benchmarks.py.
+
+Prints the change of every metric per scenario and exits with 1 when any
+metric got worse by more than the threshold, so it can gate CI.
+
+    python compare_benchmarks.py baseline/results.json candidate/results.json --threshold 5
+"""
+
+import argparse
+import json
+import sys
+
+# (label, path into a scenario result). Lower is better for all of them.
+METRICS = [
+    ("cpu avg ms", ("cpuFrameMilliseconds", "avg")),
+    ("cpu p50 ms", ("cpuFrameMilliseconds", "p50")),
+    ("cpu p99 ms", ("cpuFrameMilliseconds", "p99")),
+    ("gpu avg ms", ("gpuMilliseconds", "Frame", "avg")),
+    ("gpu p99 ms", ("gpuMilliseconds", "Frame", "p99")),
+    ("allocations", ("memory", "allocationCount")),
+    ("peak MiB", ("memory", "peakBytes")),
+]
+
+
+def lookup(result, path):
+    for key in path:
+        if not isinstance(result, dict) or key not in result:
+            return None
+        result = result[key]
+    return result
+
+
+def format_value(label, value):
+    if value is None:
+        return "-"
+    if label == "peak MiB":
+        return "%.1f" % (value / (1024.0 * 1024.0))
+    if label == "allocations":
+        return "%d" % value
+    return "%.3f" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0, help="allowed regression in percent")
+    args = parser.parse_args()
+
+    with open(args.baseline) as baseline_file:
+        baseline = json.load(baseline_file)
+    with open(args.candidate) as candidate_file:
+        candidate = json.load(candidate_file)
+
+    print("baseline %s, candidate %s, threshold %.1f%%" % (
+        baseline.get("revision", "?"), candidate.get("revision", "?"), args.threshold))
+
+    regressions = []
+
+    for scenario in sorted(set(baseline["scenarios"]) & set(candidate["scenarios"])):
+        print("\n%s" % scenario)
+        print("  %-12s %12s %12s %9s" % ("metric", "baseline", "candidate", "change"))
+
+        for label, path in METRICS:
+            old = lookup(baseline["scenarios"][scenario], path)
+            new = lookup(candidate["scenarios"][scenario], path)
+
+            change = ""
+            if old is not None and new is not None:
+                if old:
+                    percent = (new - old) * 100.0 / old
+                    change = "%+8.1f%%" % percent
+                    if percent > args.threshold:
+                        change += " !"
+                        regressions.append((scenario, label, percent))
+                elif new:
+                    change = "     new !"
+                    regressions.append((scenario, label, float("inf")))
+
+            print("  %-12s %12s %12s %s" % (label, format_value(label, old), format_value(label, new), change))
+
+    for scenario in sorted(set(baseline["scenarios"]) ^ set(candidate["scenarios"])):
+        print("\n%s is only in one of the results, not compared" % scenario)
+
+    if regressions:
+        print("\n%d regression(s) above %.1f%%" % (len(regressions), args.threshold))
+        return 1
+
+    print("\nNo regressions above %.1f%%" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "MicroBenchmark.h"
+#include "SyntheticData.h"
+#include "VulkanTexture.h"
+#include "VulkanUtils.h"
+
+namespace
+{
+	// Inputs written to disk are generated once per argument, the runner calls each benchmark many times
+	std::string const &getCachedFile(std::map<int64_t, std::string> &cache, int64_t argument, std::function<std::string()> const &write)
+	{
+		auto file = cache.find(argument);
+		if (file == cache.end())
+		{
+			file = cache.emplace(argument, write()).first;
+		}
+		return file->second;
+	}
+}
+
+// vkTextureUtils::loadTextureImage on a square PNG. The argument is the edge length in texels.
+static void BM_DecodePng(microbench::State &state)
+{
+	static std::map<int64_t, std::string> files;
+
+	uint32_t extent = static_cast<uint32_t>(state.getArgument());
+	std::string const &fileName = getCachedFile(files, state.getArgument(), [extent]() {
+		return synthetic::writeTemporaryPng(
+			"texture_" + std::to_string(extent) + ".png", synthetic::makeImage(extent, extent), extent, extent);
+	});
+
+	while (state.keepRunning())
+	{
+		int width, height, channels;
+		unsigned char *pixels = vkTextureUtils::loadTextureImage(fileName, &width, &height, &channels);
+		microbench::doNotOptimize(pixels);
+		stbi_image_free(pixels);
+	}
+
+	state.setBytesProcessed(state.getIterations() * extent * extent * 4);
+}
+MICRO_BENCHMARK(BM_DecodePng).arg(256).arg(1024);
+
+// vkutils::readFile as used for SPIR-V. The argument is the file size in bytes.
+static void BM_ReadFile(microbench::State &state)
+{
+	static std::map<int64_t, std::string> files;
+
+	size_t size = static_cast<size_t>(state.getArgument());
+	std::string const &fileName = getCachedFile(files, state.getArgument(), [size]() {
+		std::vector<char> data(size);
+		synthetic::Random random(size);
+		for (char &byte : data)
+		{
+			byte = static_cast<char>(random.next());
+		}
+		return synthetic::writeTemporaryFile("file_" + std::to_string(size) + ".spv", data);
+	});
+
+	while (state.keepRunning())
+	{
+		std::vector<char> code = vkutils::readFile(fileName);
+		microbench::doNotOptimize(code.data());
+	}
+
+	state.setBytesProcessed(state.getIterations() * size);
+}
+MICRO_BENCHMARK(BM_ReadFile).arg(4 * 1024).arg(64 * 1024).arg(1024 * 1024);
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "MatrixMath.h"
+#include "MicroBenchmark.h"
+#include "SyntheticData.h"
+
+namespace
+{
+	std::vector<glm::mat4> makeWorldTransforms(size_t count)
+	{
+		synthetic::Random random(count);
+
+		std::vector<glm::mat4> transforms(count);
+		for (glm::mat4 &transform : transforms)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				for (int row = 0; row < 4; ++row)
+				{
+					transform[column][row] = random.nextFloat() * 2.0f - 1.0f;
+				}
+			}
+		}
+		return transforms;
+	}
+
+	glm::mat4 makeViewProj()
+	{
+		Camera camera;
+		camera.setLookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		camera.setPerspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 10.0f);
+		camera.update();
+		return camera.getViewProj();
+	}
+}
+
+// The per-frame camera update done on the update thread. Argument 0 keeps the camera still, 1 moves it every frame.
+static void BM_CameraUpdate(microbench::State &state)
+{
+	bool moving = state.getArgument() != 0;
+
+	Camera camera;
+	float offset = 0.0f;
+
+	while (state.keepRunning())
+	{
+		// Move the camera so the math can't be hoisted out of the loop
+		if (moving)
+		{
+			offset += 1e-6f;
+		}
+		camera.setLookAt(glm::vec3(2.0f + offset, 2.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		camera.setPerspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 10.0f);
+		camera.update();
+
+		glm::mat4 viewProj = camera.getViewProj();
+		microbench::doNotOptimize(viewProj);
+	}
+
+	state.setItemsProcessed(state.getIterations());
+}
+MICRO_BENCHMARK(BM_CameraUpdate).arg(0).arg(1);
+
+// mathutils::multiplyMatrices over the world matrices of a scene. The argument is the number of matrices.
+static void BM_MultiplyMatrices(microbench::State &state)
+{
+	std::vector<glm::mat4> worldTransforms = makeWorldTransforms(static_cast<size_t>(state.getArgument()));
+	std::vector<glm::mat4> modelViewProjs(worldTransforms.size());
+	glm::mat4 viewProj = makeViewProj();
+
+	while (state.keepRunning())
+	{
+		mathutils::multiplyMatrices(viewProj, worldTransforms.data(), modelViewProjs.data(), worldTransforms.size());
+		microbench::doNotOptimize(modelViewProjs.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * worldTransforms.size());
+}
+MICRO_BENCHMARK(BM_MultiplyMatrices).arg(1024).arg(65536);
+
+// The same products with glm's operator*, to compare against
+static void BM_MultiplyMatricesGlm(microbench::State &state)
+{
+	std::vector<glm::mat4> worldTransforms = makeWorldTransforms(static_cast<size_t>(state.getArgument()));
+	std::vector<glm::mat4> modelViewProjs(worldTransforms.size());
+	glm::mat4 viewProj = makeViewProj();
+
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < worldTransforms.size(); ++i)
+		{
+			modelViewProjs[i] = viewProj * worldTransforms[i];
+		}
+		microbench::doNotOptimize(modelViewProjs.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * worldTransforms.size());
+}
+MICRO_BENCHMARK(BM_MultiplyMatricesGlm).arg(1024).arg(65536);
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "MicroBenchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "ChromeTrace.h"
+
+namespace microbench
+{
+	namespace
+	{
+		struct Result
+		{
+			std::string name;
+			uint64_t iterations = 0;
+			double medianNanoseconds = 0.0;
+			double minNanoseconds = 0.0;
+			double itemsPerSecond = 0.0;
+			double bytesPerSecond = 0.0;
+
+			std::vector<std::pair<std::string, double>> counters;
+			std::string error;
+		};
+
+		std::vector<std::unique_ptr<Benchmark>> &getRegistry()
+		{
+			static std::vector<std::unique_ptr<Benchmark>> registry;
+			return registry;
+		}
+
+		State runOnce(Function function, int64_t argument, uint64_t iterations)
+		{
+			State state(argument, iterations);
+			function(state);
+			return state;
+		}
+
+		// Grow the iteration count until a single run takes at least minSeconds
+		uint64_t calibrate(Function function, int64_t argument, double minSeconds, std::string &error)
+		{
+			uint64_t iterations = 1;
+
+			while (true)
+			{
+				State state = runOnce(function, argument, iterations);
+				double elapsed = state.getElapsedSeconds();
+
+				if (state.hasError())
+				{
+					error = state.getError();
+					return iterations;
+				}
+
+				if (elapsed >= minSeconds || iterations >= 1000000000ull)
+				{
+					return iterations;
+				}
+
+				// Aim a little past the minimum so the next run is likely the last, without growing more than 100x
+				double scale = elapsed > 0.0 ? 1.4 * minSeconds / elapsed : 100.0;
+				scale = std::min(std::max(scale, 2.0), 100.0);
+				iterations = static_cast<uint64_t>(iterations * scale);
+			}
+		}
+
+		Result measure(Benchmark const &benchmark, int64_t argument, bool hasArgument, double minSeconds, uint32_t repetitions)
+		{
+			Result result;
+			result.name = benchmark.getName() + (hasArgument ? "/" + std::to_string(argument) : "");
+			result.iterations = calibrate(benchmark.getFunction(), argument, minSeconds, result.error);
+
+			if (!result.error.empty())
+			{
+				return result;
+			}
+
+			std::vector<State> runs;
+			for (uint32_t i = 0; i < std::max(repetitions, 1u); ++i)
+			{
+				runs.push_back(runOnce(benchmark.getFunction(), argument, result.iterations));
+			}
+
+			std::sort(runs.begin(), runs.end(), [](State const &a, State const &b) {
+				return a.getElapsedSeconds() < b.getElapsedSeconds();
+			});
+
+			State const &median = runs[runs.size() / 2];
+			double iterations = static_cast<double>(result.iterations);
+
+			result.medianNanoseconds = median.getElapsedSeconds() * 1e9 / iterations;
+			result.minNanoseconds = runs.front().getElapsedSeconds() * 1e9 / iterations;
+			result.counters = median.getCounters();
+
+			if (median.getElapsedSeconds() > 0.0)
+			{
+				result.itemsPerSecond = median.getItemsProcessed() / median.getElapsedSeconds();
+				result.bytesPerSecond = median.getBytesProcessed() / median.getElapsedSeconds();
+			}
+
+			return result;
+		}
+
+		std::string toJson(std::vector<Result> const &results, double minSeconds, uint32_t repetitions)
+		{
+			std::ostringstream out;
+			out.precision(6);
+			out << std::fixed;
+
+			out << "{\n\t\"minTimeSeconds\": " << minSeconds << ",\n\t\"repetitions\": " << repetitions << ",\n\t\"benchmarks\": [";
+
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				Result const &result = results[i];
+				out << (i ? "," : "") << "\n\t\t{\"name\": \"" << ChromeTraceWriter::escape(result.name) << "\"";
+
+				if (!result.error.empty())
+				{
+					out << ", \"error\": \"" << ChromeTraceWriter::escape(result.error) << "\"}";
+					continue;
+				}
+
+				out << ", \"iterations\": " << result.iterations
+					<< ", \"medianNanoseconds\": " << result.medianNanoseconds
+					<< ", \"minNanoseconds\": " << result.minNanoseconds
+					<< ", \"itemsPerSecond\": " << result.itemsPerSecond
+					<< ", \"bytesPerSecond\": " << result.bytesPerSecond;
+
+				if (!result.counters.empty())
+				{
+					out << ", \"counters\": {";
+					for (size_t j = 0; j < result.counters.size(); ++j)
+					{
+						out << (j ? ", " : "") << "\"" << ChromeTraceWriter::escape(result.counters[j].first) << "\": " << result.counters[j].second;
+					}
+					out << "}";
+				}
+
+				out << "}";
+			}
+
+			out << "\n\t]\n}\n";
+
+			return out.str();
+		}
+	}
+
+	Benchmark &registerBenchmark(char const *name, Function function)
+	{
+		getRegistry().push_back(std::make_unique<Benchmark>(name, function));
+		return *getRegistry().back();
+	}
+
+	int runBenchmarks(int argc, char **argv)
+	{
+		std::string filter;
+		std::string jsonPath;
+		double minSeconds = 0.25;
+		uint32_t repetitions = 5;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (argument == "--filter" && hasValue)
+			{
+				filter = argv[++i];
+			}
+			else if (argument == "--min-time" && hasValue)
+			{
+				minSeconds = std::stod(argv[++i]);
+			}
+			else if (argument == "--repetitions" && hasValue)
+			{
+				repetitions = static_cast<uint32_t>(std::stoul(argv[++i]));
+			}
+			else if (argument == "--json" && hasValue)
+			{
+				jsonPath = argv[++i];
+			}
+			else
+			{
+				throw std::runtime_error("[ERROR] Unknown argument " + argument + "!");
+			}
+		}
+
+		std::printf("%-40s %14s %14s %14s %12s %12s\n", "benchmark", "iterations", "median ns", "min ns", "items/s", "MiB/s");
+
+		std::vector<Result> results;
+
+		for (std::unique_ptr<Benchmark> const &pBenchmark : getRegistry())
+		{
+			std::vector<int64_t> arguments = pBenchmark->getArguments();
+			bool hasArgument = !arguments.empty();
+			if (!hasArgument)
+			{
+				arguments.push_back(0);
+			}
+
+			for (int64_t argument : arguments)
+			{
+				std::string name = pBenchmark->getName() + (hasArgument ? "/" + std::to_string(argument) : "");
+				if (!filter.empty() && name.find(filter) == std::string::npos)
+				{
+					continue;
+				}
+
+				Result result = measure(*pBenchmark, argument, hasArgument, minSeconds, repetitions);
+
+				if (!result.error.empty())
+				{
+					std::printf("%-40s skipped: %s\n", result.name.c_str(), result.error.c_str());
+					std::fflush(stdout);
+					results.push_back(result);
+					continue;
+				}
+
+				std::printf("%-40s %14llu %14.1f %14.1f %12.4g %12.4g\n",
+					result.name.c_str(),
+					static_cast<unsigned long long>(result.iterations),
+					result.medianNanoseconds,
+					result.minNanoseconds,
+					result.itemsPerSecond,
+					result.bytesPerSecond / (1024.0 * 1024.0));
+
+				for (std::pair<std::string, double> const &counter : result.counters)
+				{
+					std::printf("%-40s %14s %s = %.6g\n", "", "", counter.first.c_str(), counter.second);
+				}
+				std::fflush(stdout);
+
+				results.push_back(result);
+			}
+		}
+
+		if (!jsonPath.empty())
+		{
+			std::ofstream file(jsonPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				throw std::runtime_error("[ERROR] Failed to open " + jsonPath + "!");
+			}
+
+			file << toJson(results, minSeconds, repetitions);
+			std::cout << "[INFO] Wrote " << results.size() << " results to " << jsonPath << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A small harness in the style of Google Benchmark, so the micro-benchmarks need nothing beyond the
+ *  renderer's own dependencies. Benchmarks register themselves with MICRO_BENCHMARK and loop on
+ *  State::keepRunning(); the runner picks the iteration count so each repetition runs for at least
+ *  the minimum time, and reports the median of several repetitions.
+ */
+namespace microbench
+{
+	class State
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		State(int64_t argument, uint64_t iterations) : mArgument(argument), mRemaining(iterations), mIterations(iterations) {}
+
+		// Loop condition of the timed loop. The timer starts on the first call and stops on the last.
+		bool keepRunning()
+		{
+			if (mRemaining == 0 || hasError())
+			{
+				stopTimer();
+				return false;
+			}
+
+			if (!mStarted)
+			{
+				mStarted = true;
+				startTimer();
+			}
+
+			--mRemaining;
+			return true;
+		}
+
+		// Exclude setup inside the loop from the measurement
+		void pauseTiming() { stopTimer(); }
+		void resumeTiming() { startTimer(); }
+
+		int64_t getArgument() const { return mArgument; }
+		uint64_t getIterations() const { return mIterations; }
+
+		// Totals over all iterations, reported as throughput
+		void setItemsProcessed(uint64_t items) { mItemsProcessed = items; }
+		void setBytesProcessed(uint64_t bytes) { mBytesProcessed = bytes; }
+
+		// Extra named results, like a collision rate. The value should not depend on the iteration count.
+		void setCounter(std::string const &name, double value)
+		{
+			for (std::pair<std::string, double> &counter : mCounters)
+			{
+				if (counter.first == name)
+				{
+					counter.second = value;
+					return;
+				}
+			}
+			mCounters.emplace_back(name, value);
+		}
+
+		// Report the benchmark as skipped, for inputs that are not available. Call before the timed loop.
+		void skipWithError(std::string message) { mError = std::move(message); }
+
+		bool hasError() const { return !mError.empty(); }
+		std::string const &getError() const { return mError; }
+		std::vector<std::pair<std::string, double>> const &getCounters() const { return mCounters; }
+
+		double getElapsedSeconds() const { return mElapsedSeconds; }
+		uint64_t getItemsProcessed() const { return mItemsProcessed; }
+		uint64_t getBytesProcessed() const { return mBytesProcessed; }
+
+	private:
+		void startTimer()
+		{
+			if (!mRunning)
+			{
+				mRunning = true;
+				mStart = Clock::now();
+			}
+		}
+
+		void stopTimer()
+		{
+			if (mRunning)
+			{
+				mRunning = false;
+				mElapsedSeconds += std::chrono::duration<double>(Clock::now() - mStart).count();
+			}
+		}
+
+		int64_t mArgument;
+		uint64_t mRemaining;
+		uint64_t mIterations;
+
+		bool mStarted = false;
+		bool mRunning = false;
+		Clock::time_point mStart;
+		double mElapsedSeconds = 0.0;
+
+		uint64_t mItemsProcessed = 0;
+		uint64_t mBytesProcessed = 0;
+
+		std::vector<std::pair<std::string, double>> mCounters;
+		std::string mError;
+	};
+
+	using Function = void (*)(State &);
+
+	class Benchmark
+	{
+	public:
+		Benchmark(std::string name, Function function) : mName(std::move(name)), mFunction(function) {}
+
+		// Run once more with this argument, available through State::getArgument
+		Benchmark &arg(int64_t argument)
+		{
+			mArguments.push_back(argument);
+			return *this;
+		}
+
+		std::string const &getName() const { return mName; }
+		Function getFunction() const { return mFunction; }
+		std::vector<int64_t> const &getArguments() const { return mArguments; }
+
+	private:
+		std::string mName;
+		Function mFunction;
+		std::vector<int64_t> mArguments;
+	};
+
+	Benchmark &registerBenchmark(char const *name, Function);
+
+	// Runs every registered benchmark. Options: --filter <substring> --min-time <seconds> --repetitions <n> --json <file>
+	int runBenchmarks(int argc, char **argv);
+
+	// Keep the compiler from optimizing away a result that is otherwise unused
+	template <typename T>
+	inline void doNotOptimize(T const &value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static_cast<void>(*reinterpret_cast<char const volatile *>(&value));
+#endif
+	}
+}
+
+#define MICRO_BENCHMARK_CONCAT_(a, b) a##b
+#define MICRO_BENCHMARK_CONCAT(a, b) MICRO_BENCHMARK_CONCAT_(a, b)
+
+// MICRO_BENCHMARK(function).arg(1024).arg(4096);
+#define MICRO_BENCHMARK(function) \
+	static microbench::Benchmark &MICRO_BENCHMARK_CONCAT(function##_registration_, __LINE__) = \
+		microbench::registerBenchmark(#function, function)
+
+#endif // MICRO_BENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "SyntheticData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <stb_image_write.h>
+
+namespace synthetic
+{
+	namespace
+	{
+		std::filesystem::path getTemporaryPath(std::string const &name)
+		{
+			std::filesystem::path directory = std::filesystem::temp_directory_path() / "vulkan_renderer_micro_benchmarks";
+			std::filesystem::create_directories(directory);
+			return directory / name;
+		}
+	}
+
+	std::vector<Vertex> makeGridCornerVertices(uint32_t vertexCount, uint64_t seed)
+	{
+		Random random(seed);
+
+		uint32_t side = std::max(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(vertexCount)))), 2u);
+
+		std::vector<Vertex> gridVertices(static_cast<size_t>(side) * side);
+		for (uint32_t y = 0; y < side; ++y)
+		{
+			for (uint32_t x = 0; x < side; ++x)
+			{
+				Vertex &vertex = gridVertices[y * side + x];
+				vertex.position = { static_cast<float>(x), static_cast<float>(y), 0.1f * random.nextFloat() };
+				vertex.color = { 1.0f, 1.0f, 1.0f };
+				vertex.texCoord = { x / static_cast<float>(side - 1), y / static_cast<float>(side - 1) };
+			}
+		}
+
+		std::vector<Vertex> corners;
+		corners.reserve(static_cast<size_t>(side - 1) * (side - 1) * 6);
+
+		for (uint32_t y = 0; y + 1 < side; ++y)
+		{
+			for (uint32_t x = 0; x + 1 < side; ++x)
+			{
+				uint32_t i00 = y * side + x;
+				uint32_t i10 = i00 + 1;
+				uint32_t i01 = i00 + side;
+				uint32_t i11 = i01 + 1;
+
+				for (uint32_t index : { i00, i10, i11, i00, i11, i01 })
+				{
+					corners.push_back(gridVertices[index]);
+				}
+			}
+		}
+
+		return corners;
+	}
+
+	std::vector<Vertex> makeRandomVertices(uint32_t count, uint64_t seed)
+	{
+		Random random(seed);
+
+		std::vector<Vertex> vertices(count);
+		for (Vertex &vertex : vertices)
+		{
+			vertex.position = { random.nextFloat(), random.nextFloat(), random.nextFloat() };
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+			vertex.texCoord = { random.nextFloat(), random.nextFloat() };
+		}
+
+		return vertices;
+	}
+
+	std::vector<unsigned char> makeImage(uint32_t width, uint32_t height, uint64_t seed)
+	{
+		Random random(seed);
+
+		std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				unsigned char *texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+				uint32_t noise = static_cast<uint32_t>(random.next() & 0x0F);
+
+				texel[0] = static_cast<unsigned char>((x * 255 / std::max(width - 1, 1u) + noise) & 0xFF);
+				texel[1] = static_cast<unsigned char>((y * 255 / std::max(height - 1, 1u) + noise) & 0xFF);
+				texel[2] = static_cast<unsigned char>(((x ^ y) & 0x3F) + noise);
+				texel[3] = 255;
+			}
+		}
+
+		return pixels;
+	}
+
+	std::string writeTemporaryFile(std::string const &name, std::vector<char> const &data)
+	{
+		std::filesystem::path path = getTemporaryPath(name);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("[ERROR] Failed to open " + path.string() + "!");
+		}
+
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+		return path.string();
+	}
+
+	std::string writeTemporaryPng(std::string const &name, std::vector<unsigned char> const &pixels, uint32_t width, uint32_t height)
+	{
+		std::filesystem::path path = getTemporaryPath(name);
+
+		if (!stbi_write_png(path.string().c_str(), width, height, 4, pixels.data(), width * 4))
+		{
+			throw std::runtime_error("[ERROR] Failed to write " + path.string() + "!");
+		}
+
+		return path.string();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef SYNTHETIC_DATA_H
+#define SYNTHETIC_DATA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Vertex.h"
+
+/**
+ * Deterministic inputs for the micro-benchmarks. Everything is derived from a seed with a fixed
+ *  generator and fixed float conversion, so the data is identical across compilers and standard
+ *  libraries (unlike the std distributions).
+ */
+namespace synthetic
+{
+	class Random
+	{
+	public:
+		explicit Random(uint64_t seed) : mState(seed) {}
+
+		// splitmix64
+		uint64_t next()
+		{
+			uint64_t z = (mState += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// Uniform in [0, 1)
+		float nextFloat() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+
+	private:
+		uint64_t mState;
+	};
+
+	// A triangulated, slightly bumpy grid of about vertexCount unique vertices, as a triangle list with one
+	//  vertex per corner, the way Mesh::loadModel sees an OBJ file
+	std::vector<Vertex> makeGridCornerVertices(uint32_t vertexCount, uint64_t seed = 1);
+
+	std::vector<Vertex> makeRandomVertices(uint32_t count, uint64_t seed = 1);
+
+	// RGBA8 gradients with noise, which compresses about as well as a photographic texture
+	std::vector<unsigned char> makeImage(uint32_t width, uint32_t height, uint64_t seed = 1);
+
+	// Write to a file in a temporary directory and return its path. The same name is overwritten.
+	std::string writeTemporaryFile(std::string const &name, std::vector<char> const &data);
+	std::string writeTemporaryPng(std::string const &name, std::vector<unsigned char> const &pixels, uint32_t width, uint32_t height);
+}
+
+#endif // SYNTHETIC_DATA_H
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/geometric.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include "Mesh.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "MicroBenchmark.h"
+#include "SyntheticData.h"
+#include "Vertex.h"
+
+#ifdef _MSC_VER
+constexpr char resource_dir[] = "../../resources/";
+#else
+constexpr char resource_dir[] = "../resources/";
+#endif
+
+namespace
+{
+	// The glm hash_combine based hash that std::hash<Vertex> used before, kept to compare against
+	struct LegacyVertexHash
+	{
+		size_t operator()(Vertex const &vertex) const
+		{
+			return ((std::hash<glm::vec3>()(vertex.position)
+				^ (std::hash<glm::vec3>()(vertex.color) << 1)) >> 1)
+				^ (std::hash<glm::vec2>()(vertex.texCoord) << 1);
+		}
+	};
+
+	/**
+	 * Corner vertices of a triangle list. Argument 0 is the viking room model the renderer draws,
+	 *  anything else is a synthetic grid with about that many unique vertices. An empty result means
+	 *  the model file was not found.
+	 */
+	std::vector<Vertex> const &getCornerVertices(int64_t argument)
+	{
+		static std::map<int64_t, std::vector<Vertex>> cache;
+
+		auto corners = cache.find(argument);
+		if (corners == cache.end())
+		{
+			std::vector<Vertex> vertices = argument == 0
+				? Mesh::readCornerVertices(std::string(resource_dir) + "models/viking_room.obj")
+				: synthetic::makeGridCornerVertices(static_cast<uint32_t>(argument));
+			corners = cache.emplace(argument, std::move(vertices)).first;
+		}
+
+		return corners->second;
+	}
+
+	std::vector<Vertex> getUniqueVertices(std::vector<Vertex> const &cornerVertices)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Mesh::deduplicateVertices(cornerVertices, vertices, indices);
+		return vertices;
+	}
+
+	/**
+	 * Collisions of the unique vertices under a hash. Full collisions are distinct vertices with equal
+	 *  64 bit hashes; bucket collisions are vertices whose low bits land on an already taken slot of a
+	 *  power of two table at most half full, which is what an open addressing map actually sees.
+	 */
+	template<typename Hash>
+	void setCollisionCounters(microbench::State &state, std::vector<Vertex> const &vertices)
+	{
+		Hash hasher;
+
+		size_t tableSize = 1;
+		while (tableSize < 2 * vertices.size())
+		{
+			tableSize *= 2;
+		}
+
+		std::unordered_set<size_t> hashes;
+		std::vector<bool> buckets(tableSize, false);
+		size_t bucketCollisions = 0;
+
+		for (Vertex const &vertex : vertices)
+		{
+			size_t hash = hasher(vertex);
+			hashes.insert(hash);
+
+			size_t bucket = hash & (tableSize - 1);
+			bucketCollisions += buckets[bucket] ? 1 : 0;
+			buckets[bucket] = true;
+		}
+
+		double count = static_cast<double>(vertices.size());
+		state.setCounter("uniqueVertices", count);
+		state.setCounter("fullCollisionRate", (count - hashes.size()) / count);
+		state.setCounter("bucketCollisionRate", bucketCollisions / count);
+	}
+
+	template<typename Hash>
+	void runVertexHash(microbench::State &state)
+	{
+		std::vector<Vertex> const &corners = getCornerVertices(state.getArgument());
+		if (corners.empty())
+		{
+			state.skipWithError("viking_room.obj not found");
+			return;
+		}
+
+		std::vector<Vertex> vertices = getUniqueVertices(corners);
+		setCollisionCounters<Hash>(state, vertices);
+
+		Hash hasher;
+
+		while (state.keepRunning())
+		{
+			size_t combined = 0;
+			for (Vertex const &vertex : vertices)
+			{
+				combined += hasher(vertex);
+			}
+			microbench::doNotOptimize(combined);
+		}
+
+		state.setItemsProcessed(state.getIterations() * vertices.size());
+	}
+}
+
+static void BM_VertexHash(microbench::State &state)
+{
+	runVertexHash<std::hash<Vertex>>(state);
+}
+MICRO_BENCHMARK(BM_VertexHash).arg(0).arg(4096).arg(262144);
+
+static void BM_VertexHashLegacy(microbench::State &state)
+{
+	runVertexHash<LegacyVertexHash>(state);
+}
+MICRO_BENCHMARK(BM_VertexHashLegacy).arg(0).arg(4096).arg(262144);
+
+// The index building loop of Mesh::loadModel, without the OBJ parsing
+static void BM_MeshDeduplicateVertices(microbench::State &state)
+{
+	std::vector<Vertex> const &corners = getCornerVertices(state.getArgument());
+	if (corners.empty())
+	{
+		state.skipWithError("viking_room.obj not found");
+		return;
+	}
+
+	while (state.keepRunning())
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Mesh::deduplicateVertices(corners, vertices, indices);
+		microbench::doNotOptimize(vertices.data());
+		microbench::doNotOptimize(indices.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * corners.size());
+}
+MICRO_BENCHMARK(BM_MeshDeduplicateVertices).arg(0).arg(1024).arg(16384).arg(262144);
+
+// The previous deduplication, std::unordered_map with the legacy hash and no reservation
+static void BM_DeduplicateVerticesUnorderedMap(microbench::State &state)
+{
+	std::vector<Vertex> const &corners = getCornerVertices(state.getArgument());
+	if (corners.empty())
+	{
+		state.skipWithError("viking_room.obj not found");
+		return;
+	}
+
+	while (state.keepRunning())
+	{
+		std::unordered_map<Vertex, uint32_t, LegacyVertexHash> uniqueVertices;
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		for (Vertex const &vertex : corners)
+		{
+			if (uniqueVertices.count(vertex) == 0)
+			{
+				uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+				vertices.push_back(vertex);
+			}
+
+			indices.push_back(uniqueVertices[vertex]);
+		}
+
+		microbench::doNotOptimize(vertices.data());
+		microbench::doNotOptimize(indices.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * corners.size());
+}
+MICRO_BENCHMARK(BM_DeduplicateVerticesUnorderedMap).arg(0).arg(1024).arg(16384).arg(262144);
+
+// MeshletBuilder::build on the deduplicated mesh. The output is validated once before timing.
+static void BM_BuildMeshlets(microbench::State &state)
+{
+	std::vector<Vertex> const &corners = getCornerVertices(state.getArgument());
+	if (corners.empty())
+	{
+		state.skipWithError("viking_room.obj not found");
+		return;
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	Mesh::deduplicateVertices(corners, vertices, indices);
+
+	MeshletData meshlets = MeshletBuilder::build(vertices, indices);
+	std::string error = MeshletBuilder::validate(meshlets, vertices, indices);
+	if (!error.empty())
+	{
+		state.skipWithError("invalid meshlets, " + error);
+		return;
+	}
+
+	double triangleCount = static_cast<double>(indices.size() / 3);
+	state.setCounter("meshlets", static_cast<double>(meshlets.meshlets.size()));
+	state.setCounter("trianglesPerMeshlet", triangleCount / meshlets.meshlets.size());
+	state.setCounter("verticesPerMeshlet", static_cast<double>(meshlets.vertexIndices.size()) / meshlets.meshlets.size());
+
+	while (state.keepRunning())
+	{
+		MeshletData built = MeshletBuilder::build(vertices, indices);
+		microbench::doNotOptimize(built.meshlets.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * indices.size() / 3);
+}
+MICRO_BENCHMARK(BM_BuildMeshlets).arg(0).arg(16384).arg(262144);
+
+// MeshSimplifier::buildLodChain with the default settings. The bounding radius is taken from the positions.
+static void BM_BuildLodChain(microbench::State &state)
+{
+	std::vector<Vertex> const &corners = getCornerVertices(state.getArgument());
+	if (corners.empty())
+	{
+		state.skipWithError("viking_room.obj not found");
+		return;
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	Mesh::deduplicateVertices(corners, vertices, indices);
+
+	float radius = 0.0f;
+	for (Vertex const &vertex : vertices)
+	{
+		radius = std::max(radius, glm::length(vertex.position));
+	}
+
+	std::vector<uint32_t> chainIndices = indices;
+	std::vector<MeshLod> lods = MeshSimplifier::buildLodChain(vertices, chainIndices, radius);
+
+	state.setCounter("levels", static_cast<double>(lods.size()));
+	state.setCounter("coarsestTriangleRatio", static_cast<double>(lods.back().indexCount) / indices.size());
+	state.setCounter("coarsestRelativeError", lods.back().error / radius);
+
+	while (state.keepRunning())
+	{
+		state.pauseTiming();
+		chainIndices = indices;
+		state.resumeTiming();
+
+		std::vector<MeshLod> built = MeshSimplifier::buildLodChain(vertices, chainIndices, radius);
+		microbench::doNotOptimize(built.data());
+	}
+
+	state.setItemsProcessed(state.getIterations() * indices.size() / 3);
+}
+MICRO_BENCHMARK(BM_BuildLodChain).arg(0).arg(16384);
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+#include "CpuProfiler.h"
+#include "MicroBenchmark.h"
+
+int main(int argc, char **argv)
+{
+	// Profiling scopes in the measured code would otherwise be part of the results
+	CpuProfiler::get().setEnabled(false);
+
+	try {
+		return microbench::runBenchmarks(argc, argv);
+	} catch (const std::exception &thrownException) {
+		std::cerr << thrownException.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Run the renderer's benchmark scenarios headless and collect their results.
+
+Every scenario is rendered for a fixed number of frames, several times, and the
+run with the median CPU frame time is kept. The combined results are written to
+<output-dir>/results.json, which compare_benchmarks.py takes as input.
+
+Run from the directory the renderer is normally started from, so it finds its
+resources, or use the CMake "benchmark" target which does so.
+
+    python run_benchmarks.py --executable ./VulkanRenderer --output-dir results
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+SCENARIOS = ["baseline", "instances", "textures", "resize-storm", "upload-burst"]
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "--short", "HEAD"],
+            cwd=os.path.dirname(os.path.abspath(__file__)),
+            stderr=subprocess.DEVNULL,
+            text=True,
+        ).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def run_scenario(args, scenario, run):
+    result_path = os.path.join(args.output_dir, "%s-run%d.json" % (scenario, run))
+    command = [
+        args.executable,
+        "--headless",
+        "--scenario", scenario,
+        "--frames", str(args.frames),
+        "--warmup", str(args.warmup),
+        "--width", str(args.width),
+        "--height", str(args.height),
+        "--benchmark", result_path,
+    ]
+
+    print("[BENCHMARK] " + " ".join(command), flush=True)
+    completed = subprocess.run(command, stdout=subprocess.DEVNULL if args.quiet else None)
+    if completed.returncode != 0:
+        raise RuntimeError("%s failed with exit code %d" % (scenario, completed.returncode))
+
+    with open(result_path) as result_file:
+        return json.load(result_file)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--executable", required=True)
+    parser.add_argument("--output-dir", default="benchmark_results")
+    parser.add_argument("--scenarios", nargs="+", default=SCENARIOS, choices=SCENARIOS)
+    parser.add_argument("--frames", type=int, default=600)
+    parser.add_argument("--warmup", type=int, default=60)
+    parser.add_argument("--width", type=int, default=800)
+    parser.add_argument("--height", type=int, default=600)
+    parser.add_argument("--repeat", type=int, default=3, help="runs per scenario, the median one is kept")
+    parser.add_argument("--quiet", action="store_true", help="hide the renderer's output")
+    args = parser.parse_args()
+
+    os.makedirs(args.output_dir, exist_ok=True)
+
+    results = {
+        "revision": git_revision(),
+        "frames": args.frames,
+        "warmup": args.warmup,
+        "repeat": args.repeat,
+        "scenarios": {},
+    }
+
+    for scenario in args.scenarios:
+        runs = [run_scenario(args, scenario, run) for run in range(args.repeat)]
+        runs.sort(key=lambda result: result["cpuFrameMilliseconds"]["avg"])
+        median = runs[len(runs) // 2]
+        median["runCpuFrameAverages"] = [result["cpuFrameMilliseconds"]["avg"] for result in runs]
+        median["runSpread"] = statistics.pstdev(median["runCpuFrameAverages"])
+        results["scenarios"][scenario] = median
+
+    results_path = os.path.join(args.output_dir, "results.json")
+    with open(results_path, "w") as results_file:
+        json.dump(results, results_file, indent=2)
+
+    print("[BENCHMARK] Wrote " + results_path)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
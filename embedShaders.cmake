@@ -0,0 +1,36 @@
+# Run by embedShaders in utils.cmake as cmake -DSHADER_FILES=a.spv;b.spv -DHEADER_FILE=EmbeddedShaders.h -P embedShaders.cmake
+# Writes every SPIR-V file as an array of words, and EMBEDDED_SHADERS listing them by file name.
+cmake_minimum_required(VERSION 3.10)
+
+set(HEADER "// Generated from the compiled shaders by embedShaders.cmake, don't edit\n")
+string(APPEND HEADER "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n")
+string(APPEND HEADER "struct EmbeddedShader\n{\n\tchar const *fileName;\n\tuint32_t const *pWords;\n\tsize_t wordCount;\n};\n\n")
+
+set(ENTRIES "")
+set(INDEX 0)
+
+foreach(SHADER_FILE ${SHADER_FILES})
+	get_filename_component(FILE_NAME "${SHADER_FILE}" NAME)
+	file(READ "${SHADER_FILE}" HEX HEX)
+
+	string(LENGTH "${HEX}" HEX_LENGTH)
+	math(EXPR REMAINDER "${HEX_LENGTH} % 8")
+	if(HEX_LENGTH EQUAL 0 OR NOT REMAINDER EQUAL 0)
+		message(FATAL_ERROR "${SHADER_FILE} is not SPIR-V, its size must be a multiple of 4 bytes!")
+	endif()
+
+	# SPIR-V files are little endian, so the bytes of each word are reversed into a hex literal
+	string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," WORDS "${HEX}")
+	# Eight words to a line, CMake regular expressions have no repetition counts
+	set(WORD "0x[0-9a-f]+,")
+	string(REGEX REPLACE "(${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD})" "\\1\n\t" WORDS "${WORDS}")
+
+	string(APPEND HEADER "static uint32_t const EMBEDDED_SHADER_${INDEX}[] = {\n\t${WORDS}\n};\n\n")
+	string(APPEND ENTRIES "\t{ \"${FILE_NAME}\", EMBEDDED_SHADER_${INDEX}, sizeof(EMBEDDED_SHADER_${INDEX}) / sizeof(uint32_t) },\n")
+
+	math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+string(APPEND HEADER "static EmbeddedShader const EMBEDDED_SHADERS[] = {\n${ENTRIES}};\n")
+
+file(WRITE "${HEADER_FILE}" "${HEADER}")
\ No newline at end of file
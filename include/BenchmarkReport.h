@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef BENCHMARK_REPORT_H
+#define BENCHMARK_REPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkScenario.h"
+#include "VulkanMemoryStats.h"
+
+/**
+ * Results of one benchmark run, written as JSON for benchmarks/compare_benchmarks.py. CPU frame times and
+ *  GPU scope times are kept for every measured frame, so both cover the same frames.
+ */
+class BenchmarkReport
+{
+public:
+	explicit BenchmarkReport(BenchmarkScenario const &scenario) : mScenario(scenario) {}
+
+	// Extra context for the reader, e.g. the device name. Not compared.
+	void setInfo(std::string const &key, std::string const &value);
+	void setInfo(std::string const &key, double value);
+
+	void addFrameTime(double milliseconds) { mFrameMilliseconds.push_back(milliseconds); }
+	size_t getFrameCount() const { return mFrameMilliseconds.size(); }
+
+	void addGpuTime(std::string const &scopeName, double milliseconds) { mGpuMilliseconds[scopeName].push_back(milliseconds); }
+	void setMemoryStats(VulkanMemoryStats::Snapshot const &snapshot) { mMemoryStats = snapshot; }
+
+	std::string toJson() const;
+	void write(std::string const &fileName) const;
+
+private:
+	BenchmarkScenario mScenario;
+	std::vector<std::pair<std::string, std::string>> mInfo;	// Values are already JSON
+	std::vector<double> mFrameMilliseconds;
+	std::map<std::string, std::vector<double>> mGpuMilliseconds;	// By GPU scope name
+	VulkanMemoryStats::Snapshot mMemoryStats;
+};
+
+#endif // BENCHMARK_REPORT_H
\ No newline at end of file
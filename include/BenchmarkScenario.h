@@ -0,0 +1,27 @@
+#pragma once
+
+#ifndef BENCHMARK_SCENARIO_H
+#define BENCHMARK_SCENARIO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A scripted workload for benchmark runs. Every scenario renders the same scene for a fixed number of
+ *  frames, with one kind of load turned up so its cost shows in the results.
+ */
+struct BenchmarkScenario
+{
+	std::string name = "baseline";
+	uint32_t instanceCount = 1;		// Draws of the mesh per frame
+	uint32_t textureCount = 1;		// Distinct textures the draws cycle through
+	uint32_t resizeInterval = 0;	// Frames between render size changes, 0 for none
+	uint32_t uploadInterval = 0;	// Frames between re-uploads of the mesh buffers, 0 for none
+
+	// Throws for names not in getNames()
+	static BenchmarkScenario fromName(std::string const &);
+	static std::vector<std::string> getNames();
+};
+
+#endif // BENCHMARK_SCENARIO_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <cstdint>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * A perspective camera that keeps its matrices around between frames. The setters only record what
+ *  changed, and update recomputes the view, projection and view projection matrices that depend on it,
+ *  so a camera that doesn't move costs nothing per frame. The version is bumped every time a matrix
+ *  changes, letting consumers like the per-object MVPs skip their own work too.
+ */
+class Camera
+{
+public:
+	void setLookAt(glm::vec3 const &position, glm::vec3 const &target, glm::vec3 const &up);
+
+	// fovY is in radians. The projection has Vulkan's flipped clip space Y.
+	void setPerspective(float fovY, float aspectRatio, float nearPlane, float farPlane);
+
+	// Recompute the matrices made stale by the setters. Returns whether any of them changed.
+	bool update();
+
+	glm::vec3 const &getPosition() const { return mPosition; }
+
+	glm::mat4 const &getView() const { return mView; }
+	glm::mat4 const &getProj() const { return mProj; }
+	glm::mat4 const &getViewProj() const { return mViewProj; }
+
+	// 0 until the first update
+	uint64_t getVersion() const { return mVersion; }
+
+private:
+	glm::vec3 mPosition = glm::vec3(0.0f);
+	glm::vec3 mTarget = glm::vec3(0.0f, 0.0f, -1.0f);
+	glm::vec3 mUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+	float mFovY = 0.0f, mAspectRatio = 1.0f, mNearPlane = 0.1f, mFarPlane = 10.0f;
+
+	glm::mat4 mView = glm::mat4(1.0f);
+	glm::mat4 mProj = glm::mat4(1.0f);
+	glm::mat4 mViewProj = glm::mat4(1.0f);
+
+	bool mViewDirty = true;
+	bool mProjDirty = true;
+	uint64_t mVersion = 0;
+};
+
+#endif // CAMERA_H
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef CHROME_TRACE_H
+#define CHROME_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * One complete ("X" phase) event of a Chrome trace. Times are in microseconds since the trace epoch.
+ */
+struct ChromeTraceEvent
+{
+	std::string name;
+	std::string category;
+	uint32_t threadId = 0;
+	double timestampMicroseconds = 0.0;
+	double durationMicroseconds = 0.0;
+};
+
+/**
+ * Collects timed events from the CPU and GPU profilers and writes them in the Chrome trace event
+ *  format, which chrome://tracing and ui.perfetto.dev both load. Every source converts its times to
+ *  the same epoch with toMicroseconds so the tracks line up.
+ */
+class ChromeTraceWriter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Microseconds since program start, shared by every event source in the process
+	static double toMicroseconds(Clock::time_point);
+
+	void setThreadName(uint32_t threadId, std::string const &name);
+
+	void addEvent(ChromeTraceEvent const &);
+	void addEvents(std::vector<ChromeTraceEvent> const &);
+
+	size_t getEventCount() const { return mEvents.size(); }
+
+	std::string toJson() const;
+	void write(std::string const &fileName) const;
+
+	void clear();
+
+	// Escape a string for use inside a JSON string literal
+	static std::string escape(std::string const &);
+
+private:
+
+	std::vector<ChromeTraceEvent> mEvents;
+	std::map<uint32_t, std::string> mThreadNames;
+};
+
+#endif // CHROME_TRACE_H
\ No newline at end of file
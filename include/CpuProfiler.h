@@ -0,0 +1,121 @@
+#pragma once
+
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ChromeTrace.h"
+
+/**
+ * Collects timed CPU scopes into one ring buffer per thread, for export as a Chrome trace next to the
+ *  GPU scopes. Recording only touches the calling thread's buffer; its mutex is contended only while
+ *  a trace is being exported. When the ring is full the oldest scopes are overwritten.
+ *
+ * Scopes are normally recorded with the PROFILE_SCOPE macro. Building without VULKAN_RENDERER_PROFILING
+ *  removes every scope at compile time. When compiled in, setEnabled(false) reduces a scope to a
+ *  relaxed atomic load.
+ *
+ * Scope names are not copied, they must be string literals or otherwise outlive the profiler.
+ */
+class CpuProfiler
+{
+public:
+	using Clock = ChromeTraceWriter::Clock;
+
+	static constexpr size_t EVENTS_PER_THREAD = 16384;
+
+	static CpuProfiler &get();
+
+	CpuProfiler(CpuProfiler const &) = delete;
+	CpuProfiler &operator=(CpuProfiler const &) = delete;
+
+	void setEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+	bool isEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+	// Name of the calling thread's track in the trace
+	void setThreadName(std::string const &);
+
+	void record(char const *name, Clock::time_point begin, Clock::time_point end);
+
+	void appendTraceEvents(ChromeTraceWriter &);
+	void clear();
+
+private:
+	struct Event
+	{
+		char const *name;
+		Clock::time_point begin;
+		Clock::time_point end;
+	};
+
+	struct ThreadBuffer
+	{
+		std::mutex mutex;
+		uint32_t threadId = 0;
+		std::string name;
+		std::vector<Event> events;	// Ring buffer of EVENTS_PER_THREAD entries
+		uint64_t writeCount = 0;	// Total events recorded, the ring position is this modulo the capacity
+	};
+
+	CpuProfiler() = default;
+
+	ThreadBuffer &getThreadBuffer();
+
+	std::atomic<bool> mEnabled{ true };
+
+	std::mutex mBuffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> mBuffers; // Kept after their threads exit so their scopes can still be exported
+};
+
+/**
+ * Records the lifetime of a C++ scope. Prefer the PROFILE_SCOPE macro, which compiles away.
+ */
+class CpuProfileScope
+{
+public:
+	explicit CpuProfileScope(char const *name)
+	{
+		if (CpuProfiler::get().isEnabled())
+		{
+			mName = name;
+			mBegin = CpuProfiler::Clock::now();
+		}
+	}
+
+	~CpuProfileScope()
+	{
+		if (mName)
+		{
+			CpuProfiler::get().record(mName, mBegin, CpuProfiler::Clock::now());
+		}
+	}
+
+	CpuProfileScope(CpuProfileScope const &) = delete;
+	CpuProfileScope &operator=(CpuProfileScope const &) = delete;
+
+private:
+	char const *mName = nullptr;
+	CpuProfiler::Clock::time_point mBegin;
+};
+
+#define CPU_PROFILER_CONCAT_IMPL(a, b) a##b
+#define CPU_PROFILER_CONCAT(a, b) CPU_PROFILER_CONCAT_IMPL(a, b)
+
+#ifdef VULKAN_RENDERER_PROFILING
+	// Time the rest of the enclosing block
+	#define PROFILE_SCOPE(name) CpuProfileScope CPU_PROFILER_CONCAT(cpuProfileScope, __LINE__)(name)
+	// Record a region measured elsewhere
+	#define PROFILE_RECORD(name, begin, end) \
+		do { if (CpuProfiler::get().isEnabled()) { CpuProfiler::get().record((name), (begin), (end)); } } while (0)
+#else
+	#define PROFILE_SCOPE(name) ((void) 0)
+	#define PROFILE_RECORD(name, begin, end) ((void) 0)
+#endif
+
+#endif // CPU_PROFILER_H
\ No newline at end of file
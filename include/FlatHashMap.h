@@ -0,0 +1,154 @@
+#pragma once
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * Insert-only open addressing hash map with linear probing, for building lookup tables like the vertex
+ *  deduplication map. Entries live in one array, so there is no allocation per entry, and reserve()
+ *  up front avoids rehashing altogether.
+ *
+ * Each slot has a control byte that is 0 when empty and otherwise holds the top 7 bits of the hash, so
+ *  most probes of other keys are rejected without comparing keys. The hash's low bits pick the slot,
+ *  which needs a hash with well mixed low bits (std::hash of integers won't do).
+ *
+ * Key and Value must be default constructible.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap
+{
+public:
+	FlatHashMap() = default;
+
+	// Make room for count entries without rehashing
+	void reserve(size_t count)
+	{
+		size_t capacity = MIN_CAPACITY;
+		while (capacity * MAX_LOAD_NUMERATOR < count * MAX_LOAD_DENOMINATOR)
+		{
+			capacity *= 2;
+		}
+
+		if (capacity > mControl.size())
+		{
+			rehash(capacity);
+		}
+	}
+
+	// Insert the value if the key is not in the map yet. Returns the mapped value and whether it was inserted.
+	std::pair<Value *, bool> tryEmplace(Key const &key, Value const &value)
+	{
+		if ((mSize + 1) * MAX_LOAD_DENOMINATOR > mControl.size() * MAX_LOAD_NUMERATOR)
+		{
+			rehash(mControl.empty() ? MIN_CAPACITY : mControl.size() * 2);
+		}
+
+		size_t hash = mHash(key);
+		uint8_t control = getControl(hash);
+		size_t index = hash & mMask;
+
+		while (mControl[index])
+		{
+			if (mControl[index] == control && mEqual(mSlots[index].first, key))
+			{
+				return { &mSlots[index].second, false };
+			}
+			index = (index + 1) & mMask;
+		}
+
+		mControl[index] = control;
+		mSlots[index].first = key;
+		mSlots[index].second = value;
+		++mSize;
+
+		return { &mSlots[index].second, true };
+	}
+
+	Value *find(Key const &key)
+	{
+		if (mControl.empty())
+		{
+			return nullptr;
+		}
+
+		size_t hash = mHash(key);
+		uint8_t control = getControl(hash);
+
+		for (size_t index = hash & mMask; mControl[index]; index = (index + 1) & mMask)
+		{
+			if (mControl[index] == control && mEqual(mSlots[index].first, key))
+			{
+				return &mSlots[index].second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	Value const *find(Key const &key) const
+	{
+		return const_cast<FlatHashMap *>(this)->find(key);
+	}
+
+	size_t size() const { return mSize; }
+	size_t getCapacity() const { return mControl.size(); }
+
+	void clear()
+	{
+		mControl.assign(mControl.size(), 0);
+		mSize = 0;
+	}
+
+private:
+	// Grow before the table is 7/8 full, linear probing degrades quickly past that
+	static constexpr size_t MAX_LOAD_NUMERATOR = 7;
+	static constexpr size_t MAX_LOAD_DENOMINATOR = 8;
+	static constexpr size_t MIN_CAPACITY = 16;
+
+	static uint8_t getControl(size_t hash)
+	{
+		return static_cast<uint8_t>(0x80 | (static_cast<uint64_t>(hash) >> 57));
+	}
+
+	void rehash(size_t capacity)
+	{
+		std::vector<uint8_t> oldControl(capacity, 0);
+		std::vector<std::pair<Key, Value>> oldSlots(capacity);
+		oldControl.swap(mControl);
+		oldSlots.swap(mSlots);
+		mMask = capacity - 1;
+
+		for (size_t i = 0; i < oldControl.size(); ++i)
+		{
+			if (!oldControl[i])
+			{
+				continue;
+			}
+
+			size_t index = mHash(oldSlots[i].first) & mMask;
+			while (mControl[index])
+			{
+				index = (index + 1) & mMask;
+			}
+
+			mControl[index] = oldControl[i];
+			mSlots[index] = std::move(oldSlots[i]);
+		}
+	}
+
+	std::vector<uint8_t> mControl;	// Power of two size
+	std::vector<std::pair<Key, Value>> mSlots;
+	size_t mMask = 0;
+	size_t mSize = 0;
+
+	Hash mHash;
+	KeyEqual mEqual;
+};
+
+#endif // FLAT_HASH_MAP_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * One indexed draw. The update thread fills these in, the render thread turns them into commands. The
+ *  index range and vertex offset are relative to the mesh's place in the geometry pool, which only the
+ *  render thread knows.
+ */
+struct DrawItem
+{
+	uint32_t meshIndex = 0;
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	int32_t vertexOffset = 0;
+	uint32_t materialIndex = 0;
+
+	// The scene node's world matrix premultiplied by the camera's view projection, pushed to the vertex shader
+	glm::mat4 modelViewProj = glm::mat4(1.0f);
+
+	// For texture streaming: which texture the draw samples and how large it appears on screen, in pixels
+	uint32_t textureHandle = 0;
+	float screenSpacePixels = 0.0f;
+};
+
+/**
+ * Everything the render thread needs to draw a frame, produced ahead of time by the update thread.
+ */
+struct FramePacket
+{
+	uint64_t frameIndex = 0;
+
+	glm::vec3 cameraPosition = glm::vec3(0.0f);
+
+	std::vector<DrawItem> drawList;
+
+	double updateMilliseconds = 0.0; // CPU time the update thread spent producing this packet
+};
+
+#endif // FRAME_PACKET_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef FRAME_STAGE_TIMINGS_H
+#define FRAME_STAGE_TIMINGS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "CpuProfiler.h"
+
+enum class FrameStage : uint32_t
+{
+	Update,		// Update thread producing a frame packet
+	PacketWait,	// Render thread waiting for a packet
+	FenceWait,	// Waiting for the GPU to release the frame's resources
+	Acquire,	// vkAcquireNextImageKHR
+	Record,		// Uniform upload and command buffer recording
+	Submit,		// vkQueueSubmit
+	Present,	// vkQueuePresentKHR
+	Count
+};
+
+/**
+ * Averages the CPU time spent in each stage of the frame pipeline over a reporting interval.
+ *  Only the render thread touches this; the update thread's time travels in the frame packet.
+ */
+class FrameStageTimings
+{
+public:
+	using Clock = CpuProfiler::Clock;
+
+	void record(FrameStage, double milliseconds);
+
+	// Record the time elapsed since start. The stage also shows up as a CPU profiler scope.
+	void record(FrameStage stage, Clock::time_point start)
+	{
+		Clock::time_point end = Clock::now();
+		record(stage, std::chrono::duration<double, std::milli>(end - start).count());
+		PROFILE_RECORD(getStageName(stage), start, end);
+	}
+
+	void endFrame() { ++mFrameCount; }
+
+	bool shouldReport(double intervalSeconds = 2.0) const;
+
+	// Averages per frame since the last report, naming the stage that bounds throughput. Resets the counters.
+	std::string report();
+
+	static char const *getStageName(FrameStage);
+
+private:
+	std::array<double, static_cast<size_t>(FrameStage::Count)> mTotals{};
+	uint64_t mFrameCount = 0;
+	Clock::time_point mIntervalStart = Clock::now();
+};
+
+#endif // FRAME_STAGE_TIMINGS_H
\ No newline at end of file
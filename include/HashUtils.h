@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+/**
+ * Hashing for small fixed size keys, after wyhash: the words are folded in pairs with a 64x64 to 128 bit
+ *  multiply whose halves are xored together. Every input bit affects every output bit, so the low bits
+ *  are good enough to index a power of two table directly.
+ */
+namespace hashutils
+{
+	constexpr uint64_t SECRET0 = 0xa0761d6478bd642full;
+	constexpr uint64_t SECRET1 = 0xe7037ed1a0b428dbull;
+	constexpr uint64_t SECRET2 = 0x8ebc6af09c88c6e3ull;
+
+	inline uint64_t mix(uint64_t a, uint64_t b)
+	{
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high;
+		uint64_t low = _umul128(a, b, &high);
+		return low ^ high;
+#else
+		uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+		uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+		uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+		uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+		uint64_t low = (middle << 32) | static_cast<uint32_t>(lowLow);
+		uint64_t high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+		return low ^ high;
+#endif
+	}
+
+	inline uint64_t hashWords(uint32_t const *words, size_t count, uint64_t seed = 0)
+	{
+		seed ^= SECRET0;
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			uint64_t a = (static_cast<uint64_t>(words[i]) << 32) | words[i + 1];
+			uint64_t b = (static_cast<uint64_t>(words[i + 2]) << 32) | words[i + 3];
+			seed = mix(a ^ SECRET1, b ^ seed);
+		}
+
+		// Up to 3 words left
+		uint64_t a = 0, b = 0;
+		if (i < count)		a = static_cast<uint64_t>(words[i]) << 32;
+		if (i + 1 < count)	a |= words[i + 1];
+		if (i + 2 < count)	b = words[i + 2];
+
+		return mix(SECRET1 ^ (count * 4), mix(a ^ SECRET2, b ^ seed));
+	}
+
+	// Fold one more value into a running hash
+	inline void combine(uint64_t &seed, uint64_t value)
+	{
+		seed = mix(seed ^ SECRET1, value ^ SECRET2);
+	}
+
+	// The bits of a float, with -0.0 mapped to +0.0 so that values comparing equal hash equally
+	inline uint32_t floatBits(float value)
+	{
+		if (value == 0.0f)
+		{
+			return 0;
+		}
+
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+}
+
+#endif // HASH_UTILS_H
\ No newline at end of file
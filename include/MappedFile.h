@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A whole file mapped read-only into memory. Pages are read in by the OS as they are touched and
+ *  shared with the file cache, so nothing is copied. The mapping starts on a page boundary, which
+ *  satisfies the alignment of any word sized data read from it.
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(std::string const &fileName);
+	~MappedFile();
+
+	MappedFile(MappedFile const &) = delete;
+	MappedFile &operator=(MappedFile const &) = delete;
+
+	MappedFile(MappedFile &&) noexcept;
+	MappedFile &operator=(MappedFile &&) noexcept;
+
+	void const *getData() const { return mpData; }
+	size_t getSize() const { return mSize; }
+
+private:
+	void unmap();
+
+	void *mpData = nullptr;
+	size_t mSize = 0;
+
+#ifdef _WIN32
+	void *mFileHandle = nullptr;
+	void *mMappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
\ No newline at end of file
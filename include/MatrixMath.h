@@ -0,0 +1,20 @@
+#pragma once
+
+#ifndef MATRIX_MATH_H
+#define MATRIX_MATH_H
+
+#include <cstddef>
+
+#include <glm/mat4x4.hpp>
+
+namespace mathutils
+{
+	/**
+	 * results[i] = left * rights[i] for count matrices, e.g. a view projection matrix times every world matrix
+	 *  of the scene. Uses AVX when the compiler targets it and SSE otherwise, falling back to glm elsewhere.
+	 *  The arrays may alias as long as results[i] and rights[i] are the same matrix or do not overlap.
+	 */
+	void multiplyMatrices(glm::mat4 const &left, glm::mat4 const *rights, glm::mat4 *results, size_t count);
+}
+
+#endif // MATRIX_MATH_H
\ No newline at end of file
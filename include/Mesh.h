@@ -3,28 +3,76 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
 #include "Vertex.h"
 
+/**
+ * A part of a level of detail drawn with one indexed draw. Its indices are relative to vertexOffset, so
+ *  meshes with more vertices than 16 bit indices can address still get 16 bit index buffers.
+ */
+struct MeshSection
+{
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	int32_t vertexOffset = 0;
+};
+
 class Mesh
 {
 public:
 	Mesh() = default;
 
-	void lazyInit(std::string, VkPhysicalDevice, VkDevice);
+	void lazyInit(std::string, VkPhysicalDevice, VkDevice, LodChainSettings const & = LodChainSettings());
+
+	std::vector<Vertex> const &getVertices() const { return mVertices; }
+
+	// The index lists of every level of detail, one after the other
+	std::vector<uint32_t> const &getIndices() const { return mIndices; }
+
+	// Level 0 is the full mesh, each further level is coarser and indexes the same vertices
+	std::vector<MeshLod> const &getLods() const { return mLods; }
 
-	std::vector<Vertex> getVertices() const { return mVertices; }
-	std::vector<uint32_t> getIndices() const { return mIndices; }
+	// The index buffer contents for the GPU, in getIndexType's format. Draw them by section.
+	std::vector<uint8_t> const &getIndexData() const { return mIndexData; }
+	VkIndexType getIndexType() const { return mIndexType; }
+	std::vector<MeshSection> const &getSections(uint32_t lodIndex) const { return mLodSections[lodIndex]; }
+
+	// Read an obj file as a triangle list with one vertex per corner
+	static std::vector<Vertex> readCornerVertices(std::string const &);
+
+	// Index a triangle list given as one vertex per corner, merging identical vertices. Appends to the outputs.
+	static void deduplicateVertices(std::vector<Vertex> const &cornerVertices, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+	// Clusters of the full resolution mesh with their culling bounds, built at load time
+	MeshletData const &getMeshlets() const { return mMeshlets; }
+
+	// Bounding sphere of the vertex positions in model space
+	glm::vec3 getBoundingCenter() const { return mBoundingCenter; }
+	float getBoundingRadius() const { return mBoundingRadius; }
 
 private:
 	void loadModel();
+	void computeBoundingSphere();
+	void buildIndexData();
 	void createVertexBuffer();
 	void createIndexBuffer();
 
 	std::vector<Vertex> mVertices;
 	std::vector<uint32_t> mIndices;
+	std::vector<MeshLod> mLods;
+
+	std::vector<uint8_t> mIndexData;
+	VkIndexType mIndexType = VK_INDEX_TYPE_UINT32;
+	std::vector<std::vector<MeshSection>> mLodSections;
+	MeshletData mMeshlets;
+
+	glm::vec3 mBoundingCenter = glm::vec3(0.0f);
+	float mBoundingRadius = 0.0f;
 
 	std::string mModelDir;
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Vertex.h"
+
+// One level of detail: a range of the mesh's index buffer and how far it deviates from the full mesh
+struct MeshLod
+{
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	float error = 0.0f;		// In model space units
+};
+
+struct LodChainSettings
+{
+	uint32_t maxLodCount = 5;			// Including the full mesh
+	float triangleRatio = 0.5f;			// Target triangle count of each level relative to the previous one
+	float maxRelativeError = 0.05f;		// Give up on coarser levels past this error, relative to the bounding radius
+};
+
+/**
+ * Simplifies triangle meshes with quadric error metrics (Garland and Heckbert). Collapses only move a
+ *  vertex onto one of its neighbours, never to a new position, so every level indexes the original
+ *  vertex buffer and a whole LOD chain can share it.
+ *
+ * Vertices are welded by position first, so UV seams don't stop the simplification; when a welded
+ *  vertex collapses, each of its copies moves to the copy of the target with the closest texture
+ *  coordinates. Vertices on open borders are locked to keep silhouettes and holes intact.
+ */
+class MeshSimplifier
+{
+public:
+	/**
+	 * Reduce the mesh to at most targetIndexCount indices, or as close as collapses with an error
+	 *  below maxError allow. Returns the new index list and, in resultError, the largest error taken.
+	 *  The error of a collapse is the root mean square distance of the moved vertex to the planes of
+	 *  its triangles, weighted by their areas, so it is in model space units.
+	 */
+	static std::vector<uint32_t> simplify(std::vector<Vertex> const &, std::vector<uint32_t> const &,
+		size_t targetIndexCount, float maxError, float *resultError = nullptr);
+
+	/**
+	 * Append successively coarser levels to indices, which holds the full mesh as level 0. Stops early
+	 *  when a level can't get meaningfully smaller within the error budget.
+	 */
+	static std::vector<MeshLod> buildLodChain(std::vector<Vertex> const &, std::vector<uint32_t> &indices,
+		float boundingRadius, LodChainSettings const & = LodChainSettings());
+
+	/**
+	 * The coarsest level whose error covers at most maxPixelError pixels. pixelsPerUnit is the screen
+	 *  size of one model space unit at the mesh's distance.
+	 */
+	static uint32_t selectLod(std::vector<MeshLod> const &, float pixelsPerUnit, float maxPixelError = 1.0f);
+};
+
+#endif // MESH_SIMPLIFIER_H
\ No newline at end of file
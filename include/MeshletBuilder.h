@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "Vertex.h"
+
+/**
+ * A cluster of at most MAX_VERTICES vertices and MAX_TRIANGLES triangles. Its vertices are a range of
+ *  MeshletData::vertexIndices, which index the mesh's vertex buffer, and its triangles a range of
+ *  MeshletData::triangleIndices, 3 bytes each, which index the meshlet's own vertices. 16 bytes, laid
+ *  out to be uploaded as is to a storage buffer (std430).
+ */
+struct Meshlet
+{
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;	// In bytes, 3 per triangle
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+};
+
+/**
+ * Culling data of a meshlet in model space, also std430 compatible. The normal cone is stored as an
+ *  axis and the cutoff for the view direction, see MeshletBuilder::isBackfacing. A cone with a cutoff
+ *  of 1 never culls, which is what clusters whose normals span more than a hemisphere get.
+ */
+struct MeshletBounds
+{
+	glm::vec3 center;
+	float radius;
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+struct MeshletData
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> bounds;		// One per meshlet
+	std::vector<uint32_t> vertexIndices;
+	std::vector<uint8_t> triangleIndices;
+};
+
+/**
+ * Splits an indexed triangle list into meshlets for finer grained culling and, later, mesh shaders.
+ *  Triangles are taken in index order and a meshlet is closed when the next triangle would not fit, so
+ *  the clusters are only as coherent as the index order. Deduplicated OBJ data is ordered by face, which
+ *  keeps neighbouring triangles together well enough.
+ *
+ * Nothing here touches Vulkan, so the builder can be exercised on its own.
+ */
+class MeshletBuilder
+{
+public:
+	// The limits recommended for mesh shaders on most hardware. Local indices have to fit a byte.
+	static constexpr uint32_t MAX_VERTICES = 64;
+	static constexpr uint32_t MAX_TRIANGLES = 124;
+
+	static MeshletData build(std::vector<Vertex> const &, std::vector<uint32_t> const &,
+		uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+	/**
+	 * Check that the meshlets reproduce the index list exactly, respect the limits and that every
+	 *  vertex lies inside its meshlet's sphere. Returns an empty string on success, otherwise what is
+	 *  wrong with the first bad meshlet.
+	 */
+	static std::string validate(MeshletData const &, std::vector<Vertex> const &, std::vector<uint32_t> const &,
+		uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+	// True when every triangle of the meshlet faces away from a camera at cameraPosition, in model space
+	static bool isBackfacing(MeshletBounds const &, glm::vec3 const &cameraPosition);
+
+private:
+	static MeshletBounds computeBounds(MeshletData const &, Meshlet const &, std::vector<Vertex> const &);
+};
+
+#endif // MESHLET_BUILDER_H
\ No newline at end of file
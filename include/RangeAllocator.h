@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef RANGE_ALLOCATOR_H
+#define RANGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+/**
+ * Hands out ranges of a linear address space, like the elements of a large buffer. Free ranges are
+ *  kept sorted by offset and merged with their neighbours when a range is freed, so fragmentation only
+ *  comes from the order of frees, and compaction (done by the owner of the memory) undoes it.
+ *
+ * Allocation is first fit, which is linear in the number of free ranges. Sizes and offsets are in
+ *  whatever unit the owner uses.
+ */
+class RangeAllocator
+{
+public:
+	static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+	explicit RangeAllocator(uint64_t capacity = 0) { reset(capacity); }
+
+	// Forget every allocation
+	void reset(uint64_t capacity);
+
+	// Returns INVALID_OFFSET when no free range is large enough
+	uint64_t allocate(uint64_t size);
+	void free(uint64_t offset, uint64_t size);
+
+	uint64_t getCapacity() const { return mCapacity; }
+	uint64_t getUsedSize() const { return mUsedSize; }
+	uint64_t getLargestFreeRange() const;
+	size_t getFreeRangeCount() const { return mFreeRanges.size(); }
+
+private:
+	std::map<uint64_t, uint64_t> mFreeRanges;	// Offset to size
+	uint64_t mCapacity = 0;
+	uint64_t mUsedSize = 0;
+};
+
+#endif // RANGE_ALLOCATOR_H
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+/**
+ * The objects to draw, as a hierarchy of nodes with a transform each and optionally a mesh and a
+ *  material. Every property lives in its own array indexed by node, so passes that only need world
+ *  matrices or only mesh indices walk one dense array.
+ *
+ * Nodes are only ever appended and a parent has to exist before its children, so parents always come
+ *  first. That makes world matrix propagation a single forward pass, and changing a transform only
+ *  recomputes the subtree below it.
+ */
+class Scene
+{
+public:
+	static constexpr uint32_t NO_PARENT = UINT32_MAX;
+	static constexpr uint32_t NO_MESH = UINT32_MAX;
+
+	uint32_t addNode(uint32_t parent = NO_PARENT, glm::mat4 const &localTransform = glm::mat4(1.0f));
+
+	void setLocalTransform(uint32_t node, glm::mat4 const &localTransform);
+
+	// meshIndex indexes the renderer's meshes, materialIndex the texture registry slot of textureHandle
+	void setMesh(uint32_t node, uint32_t meshIndex);
+	void setMaterial(uint32_t node, uint32_t materialIndex, uint32_t textureHandle);
+
+	// Bring the world matrices of changed nodes and their descendants up to date. Returns how many were recomputed.
+	uint32_t updateWorldTransforms();
+
+	void clear();
+
+	uint32_t getNodeCount() const { return static_cast<uint32_t>(mParents.size()); }
+
+	std::vector<uint32_t> const &getParents() const { return mParents; }
+	std::vector<glm::mat4> const &getLocalTransforms() const { return mLocalTransforms; }
+	std::vector<glm::mat4> const &getWorldTransforms() const { return mWorldTransforms; }
+	std::vector<uint32_t> const &getMeshIndices() const { return mMeshIndices; }
+	std::vector<uint32_t> const &getMaterialIndices() const { return mMaterialIndices; }
+	std::vector<uint32_t> const &getTextureHandles() const { return mTextureHandles; }
+
+	// Nodes whose world matrix changed in the last updateWorldTransforms, for keeping derived data like bounds in sync
+	std::vector<uint8_t> const &getWorldChangedFlags() const { return mWorldChanged; }
+
+private:
+	std::vector<uint32_t> mParents;
+	std::vector<glm::mat4> mLocalTransforms;
+	std::vector<glm::mat4> mWorldTransforms;
+	std::vector<uint32_t> mMeshIndices;
+	std::vector<uint32_t> mMaterialIndices;
+	std::vector<uint32_t> mTextureHandles;
+
+	// Bytes rather than std::vector<bool>, which is slower to scan
+	std::vector<uint8_t> mLocalDirty;
+	std::vector<uint8_t> mWorldChanged;
+	bool mAnyDirty = false;
+};
+
+#endif // SCENE_H
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <string>
+
+namespace shadercompiler
+{
+	// The GLSL compiler to run: $VULKAN_RENDERER_GLSL_COMPILER if set, else the one configured at build time, else glslc from the PATH
+	std::string getCompilerPath();
+
+	// Compile a GLSL source file to SPIR-V, the stage follows from the file extension. The compiler's output is
+	//  appended to log. Returns whether the compilation succeeded.
+	bool compileGlsl(std::string const &sourceFile, std::string const &outputFile, std::string &log);
+}
+
+#endif // SHADER_COMPILER_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanLayoutCache.h"
+
+struct ShaderDescriptorBinding
+{
+	static constexpr uint32_t NO_SPECIALIZATION = UINT32_MAX;
+
+	uint32_t set = 0;
+	uint32_t binding = 0;
+	VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uint32_t descriptorCount = 1;		// 0 for a runtime sized array
+	uint32_t countSpecializationId = NO_SPECIALIZATION; // constant_id of the array size, if it is a specialization constant
+	VkShaderStageFlags stageFlags = 0;
+};
+
+struct ShaderVertexInput
+{
+	uint32_t location = 0;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
+/**
+ * The interface of one or more shader stages, read straight from their SPIR-V: which descriptors they
+ *  bind, which push constant ranges they read and, for a vertex shader, which attributes they consume.
+ *  Layouts built from this always agree with the shaders, so adding a binding to a shader doesn't need
+ *  a matching edit on the C++ side.
+ *
+ * Only what the renderer's shaders use is understood: buffers, images, samplers and input attachments,
+ *  scalar and vector vertex inputs of 32 bit components, and one push constant block per stage.
+ */
+struct ShaderReflection
+{
+	VkShaderStageFlags stages = 0;
+	std::vector<ShaderDescriptorBinding> descriptorBindings;	// Sorted by set, then binding
+	std::vector<VkPushConstantRange> pushConstantRanges;		// One per stage at most
+	std::vector<ShaderVertexInput> vertexInputs;				// Sorted by location
+
+	// Parse a SPIR-V module as loaded by vkutils::readFile
+	static ShaderReflection reflect(std::vector<char> const &code);
+	static ShaderReflection reflect(uint32_t const *words, size_t wordCount);
+
+	// Add another stage of the same pipeline. Bindings used by both stages must agree.
+	void merge(ShaderReflection const &);
+
+	// Fix the descriptor count of every array sized by the given specialization constant
+	void specialize(uint32_t specializationId, uint32_t value);
+
+	uint32_t getSetCount() const;
+	DescriptorSetLayoutDescription getDescriptorSetLayoutDescription(uint32_t set) const;
+
+	// Whether pipelines built from either reflection can share descriptor set and pipeline layouts
+	bool hasSameLayoutAs(ShaderReflection const &) const;
+
+	// Whether a vkCmdPushConstants with these stages and range is covered by what the shaders declare
+	bool coversPushConstants(VkShaderStageFlags, uint32_t offset, uint32_t size) const;
+
+	// The vertex attributes the shader consumes, picked by location from those the vertex format provides
+	std::vector<VkVertexInputAttributeDescription> selectVertexAttributes(VkVertexInputAttributeDescription const *, size_t) const;
+};
+
+#endif // SHADER_REFLECTION_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <vector>
+
+#ifndef __linux__
+#include <filesystem>
+#endif
+
+/**
+ * Reports which of the watched shader sources were written since the last poll, for hot reloading. On
+ *  Linux the directory is watched with inotify, elsewhere the files' modification times are compared on
+ *  every poll. Either way poll never blocks, so it can be called once a frame.
+ *
+ * Editors often save by writing a new file and renaming it over the old one, so a rename into the
+ *  directory counts as a write.
+ */
+class ShaderWatcher
+{
+public:
+	ShaderWatcher() = default;
+
+	ShaderWatcher(ShaderWatcher const &) = delete;
+	ShaderWatcher &operator=(ShaderWatcher const &) = delete;
+
+	void lazyInit(std::string const &directory, std::vector<std::string> const &fileNames);
+
+	// Names of the watched files written since the last call, each listed once
+	std::vector<std::string> poll();
+
+	void cleanUp();
+
+private:
+	void addChanged(std::string const &, std::vector<std::string> &) const;
+
+	std::string mDirectory;
+	std::vector<std::string> mFileNames;
+
+#ifdef __linux__
+	int mInotifyFd = -1;
+#else
+	std::vector<std::filesystem::file_time_type> mWriteTimes;	// Of each file in mFileNames
+#endif
+};
+
+#endif // SHADER_WATCHER_H
\ No newline at end of file
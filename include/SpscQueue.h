@@ -0,0 +1,142 @@
+#pragma once
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread. The producer
+ *  only writes mTail and the consumer only writes mHead, so acquire/release ordering on those two
+ *  indices is all the synchronization needed.
+ *
+ * One slot is kept empty to tell a full queue from an empty one.
+ *
+ * push and pop are the blocking versions, for a side that has nothing else to do until the other
+ *  catches up. They sleep on a condition variable instead of spinning, and close wakes both sides
+ *  for good, e.g. to stop the producer.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity = 1)
+		: mSlots(capacity + 1) {}
+
+	SpscQueue(SpscQueue const &) = delete;
+	SpscQueue &operator=(SpscQueue const &) = delete;
+
+	// Only call while neither thread is using the queue
+	void reset(size_t capacity)
+	{
+		mSlots.clear();
+		mSlots.resize(capacity + 1);
+		mHead.store(0, std::memory_order_relaxed);
+		mTail.store(0, std::memory_order_relaxed);
+		mClosed = false;
+	}
+
+	// Producer only. The value is moved from only if there was room for it.
+	bool tryPush(T &value)
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		size_t nextTail = increment(tail);
+
+		if (nextTail == mHead.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		mSlots[tail] = std::move(value);
+		mTail.store(nextTail, std::memory_order_release);
+
+		return true;
+	}
+
+	// Consumer only
+	bool tryPop(T &value)
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+
+		if (head == mTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		value = std::move(mSlots[head]);
+		mHead.store(increment(head), std::memory_order_release);
+
+		return true;
+	}
+
+	// Producer only. Waits for room, returns false without pushing once the queue is closed.
+	bool push(T &value)
+	{
+		bool pushed = false;
+		{
+			std::unique_lock<std::mutex> lock(mWaitMutex);
+			mWaitCondition.wait(lock, [&] { return mClosed || (pushed = tryPush(value)); });
+		}
+
+		if (pushed)
+		{
+			mWaitCondition.notify_all();
+		}
+
+		return pushed;
+	}
+
+	// Consumer only. Waits for a value, returns false without one once the queue is closed.
+	bool pop(T &value)
+	{
+		bool popped = false;
+		{
+			std::unique_lock<std::mutex> lock(mWaitMutex);
+			mWaitCondition.wait(lock, [&] { return (popped = tryPop(value)) || mClosed; });
+		}
+
+		if (popped)
+		{
+			mWaitCondition.notify_all();
+		}
+
+		return popped;
+	}
+
+	// Wakes a push or pop that is waiting, and makes every later one return false when it would wait
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mWaitMutex);
+			mClosed = true;
+		}
+
+		mWaitCondition.notify_all();
+	}
+
+	size_t getCapacity() const { return mSlots.size() - 1; }
+
+private:
+	size_t increment(size_t index) const
+	{
+		return index + 1 == mSlots.size() ? 0 : index + 1;
+	}
+
+	std::vector<T> mSlots;
+
+	// Kept on separate cache lines so the two threads don't false share
+	alignas(64) std::atomic<size_t> mHead{ 0 };
+	alignas(64) std::atomic<size_t> mTail{ 0 };
+
+	// Only for push and pop. The indices change under the mutex there, so no wake up is missed.
+	std::mutex mWaitMutex;
+	std::condition_variable mWaitCondition;
+	bool mClosed = false;
+};
+
+#endif // SPSC_QUEUE_H
\ No newline at end of file
@@ -4,12 +4,13 @@
 #define VERTEX_H
 
 #include <array>
+#include <cstdint>
+#include <functional>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <vulkan/vulkan.h>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include "HashUtils.h"
 
 struct Vertex
 {
@@ -28,13 +29,21 @@ struct Vertex
 
 namespace std
 {
+	/**
+	 * Hashes the raw bits of all 8 floats in one pass. -0.0 and +0.0 compare equal, so they are hashed
+	 *  the same. The low bits are well mixed, which FlatHashMap relies on.
+	 */
 	template<> struct hash<Vertex>
 	{
 		size_t operator()(Vertex const &vertex) const
 		{
-			return ((hash<glm::vec3>()(vertex.position)
-				^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1)
-				^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+			uint32_t const words[8] = {
+				hashutils::floatBits(vertex.position.x), hashutils::floatBits(vertex.position.y), hashutils::floatBits(vertex.position.z),
+				hashutils::floatBits(vertex.color.x), hashutils::floatBits(vertex.color.y), hashutils::floatBits(vertex.color.z),
+				hashutils::floatBits(vertex.texCoord.x), hashutils::floatBits(vertex.texCoord.y)
+			};
+
+			return static_cast<size_t>(hashutils::hashWords(words, 8));
 		}
 	};
 }
@@ -13,15 +13,18 @@ public:
 		: mPhysicalDevice(physicalDevice), mLogicalDevice(logicalDevice) {};
 
 	VkDeviceMemory getMemoryHandle() const { return mMemoryHandle; }
+	VkDeviceSize getMemorySize() const { return mMemorySize; }
 
 protected:
 	void allocateMemory(VkMemoryRequirements, VkMemoryPropertyFlags);
+	void freeMemory(VkDeviceMemory);
 	uint32_t findMemoryType(VkPhysicalDevice const &, uint32_t, VkMemoryPropertyFlags);
 
 	VkDevice mLogicalDevice = VK_NULL_HANDLE;
 	VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
 
 	VkDeviceMemory mMemoryHandle = VK_NULL_HANDLE;
+	VkDeviceSize mMemorySize = 0; // Size of the last allocation, used for memory budgeting
 };
 
 #endif // VULKAN_BASE_OBJECT_H
\ No newline at end of file
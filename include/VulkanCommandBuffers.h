@@ -3,10 +3,17 @@
 #ifndef VULKAN_COMMAND_BUFFERS_H
 #define VULKAN_COMMAND_BUFFERS_H
 
+#include <cstdint>
+
 #include <vulkan/vulkan.h>
 
+#include "VulkanDeletionQueue.h"
+
 // Remember this commmand buffer is short-lived
 VkCommandBuffer beginSingleTimeCommands(VkDevice, VkCommandPool);
 void endSingleTimeCommands(VkDevice, VkCommandPool, VkQueue, VkCommandBuffer);
 
+// Submit without waiting for the queue. The command buffer is freed once the frame value lastUsedValue has completed.
+void submitSingleTimeCommands(VkDevice, VkCommandPool, VkQueue, VkCommandBuffer, VulkanDeletionQueue *, uint64_t lastUsedValue);
+
 #endif // VULKAN_COMMAND_BUFFERS_H
\ No newline at end of file
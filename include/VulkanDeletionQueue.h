@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef VULKAN_DELETION_QUEUE_H
+#define VULKAN_DELETION_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+/**
+ * Destroys Vulkan objects once the GPU can no longer be using them, instead of stalling the whole
+ *  device with vkDeviceWaitIdle first. Each deleter is tagged with the frame value (see VulkanFrameSync)
+ *  of the last submission that may reference the object, and runs once that value has completed.
+ *
+ * Deleters run in the order they were pushed. Only the thread submitting frames may use this.
+ */
+class VulkanDeletionQueue
+{
+public:
+	using Deleter = std::function<void()>;
+
+	VulkanDeletionQueue() = default;
+
+	VulkanDeletionQueue(VulkanDeletionQueue const &) = delete;
+	VulkanDeletionQueue &operator=(VulkanDeletionQueue const &) = delete;
+
+	void push(uint64_t lastUsedValue, Deleter);
+
+	// Run every deleter whose frame value is at or below completedValue. Returns how many ran.
+	size_t collect(uint64_t completedValue);
+
+	// Run everything regardless of frame values. Only call once the device is idle.
+	void flush();
+
+	size_t getPendingCount() const { return mEntries.size(); }
+
+private:
+	struct Entry
+	{
+		uint64_t lastUsedValue;
+		Deleter deleter;
+	};
+
+	std::deque<Entry> mEntries; // Ordered by lastUsedValue
+};
+
+#endif // VULKAN_DELETION_QUEUE_H
\ No newline at end of file
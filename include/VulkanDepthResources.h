@@ -32,7 +32,7 @@ public:
 	{
 		vkDestroyImageView(mLogicalDevice, mImageView, nullptr);
 		vkDestroyImage(mLogicalDevice, mImage, nullptr);
-		vkFreeMemory(mLogicalDevice, mMemoryHandle, nullptr);
+		freeMemory(mMemoryHandle);
 	}
 
 private:
@@ -0,0 +1,111 @@
+#pragma once
+
+#ifndef VULKAN_DESCRIPTOR_ALLOCATOR_H
+#define VULKAN_DESCRIPTOR_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/**
+ * Everything a descriptor set is made from: its layout and the resources written to each binding.
+ *  Two equal descriptions give interchangeable descriptor sets.
+ */
+struct DescriptorSetDescription
+{
+	struct Binding
+	{
+		uint32_t binding = 0;
+		VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		std::vector<VkDescriptorBufferInfo> bufferInfos;
+		std::vector<VkDescriptorImageInfo> imageInfos;
+	};
+
+	VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+	std::vector<Binding> bindings;
+
+	DescriptorSetDescription &bindBuffer(uint32_t binding, VkDescriptorType, VkDescriptorBufferInfo const &);
+	DescriptorSetDescription &bindImages(uint32_t binding, VkDescriptorType, std::vector<VkDescriptorImageInfo>);
+
+	bool operator==(DescriptorSetDescription const &) const;
+};
+
+struct DescriptorSetDescriptionHash
+{
+	size_t operator()(DescriptorSetDescription const &) const;
+};
+
+/**
+ * Hands out descriptor sets from a chain of descriptor pools. When the current pool runs out another one
+ *  is taken, so there is no need to know up front how many sets or materials there will be. Every pool
+ *  is sized for the same mix of descriptors per set, given at init, and new pools hold twice as many sets
+ *  as the previous one up to MAX_SETS_PER_POOL.
+ *
+ * Sets are never freed one by one. Instead every set handed out so far is retired at once, tagged with
+ *  the frame value (see VulkanFrameSync) of the last submission that may use it. Once that value has
+ *  completed the pools are reset with vkResetDescriptorPool and reused, so swap chain recreation and
+ *  texture changes never create or destroy a pool after warm up.
+ *
+ * getDescriptorSet caches the sets it writes by description until they are retired, so draws sharing a
+ *  material share its set. Only the thread submitting frames may use this.
+ */
+class VulkanDescriptorAllocator
+{
+public:
+	static constexpr uint32_t MAX_SETS_PER_POOL = 256;
+
+	VulkanDescriptorAllocator() = default;
+
+	VulkanDescriptorAllocator(VulkanDescriptorAllocator const &) = delete;
+	VulkanDescriptorAllocator &operator=(VulkanDescriptorAllocator const &) = delete;
+
+	// descriptorsPerSet is how many descriptors of each type an average set uses
+	void lazyInit(VkDevice, std::vector<VkDescriptorPoolSize> const &descriptorsPerSet, uint32_t initialSetsPerPool = 8);
+
+	// An unwritten set, valid until the next retire
+	VkDescriptorSet allocate(VkDescriptorSetLayout);
+
+	// A set written with the description, shared with earlier calls for an equal description since the last retire
+	VkDescriptorSet getDescriptorSet(DescriptorSetDescription const &);
+
+	// Every set handed out so far may be used by submissions up to lastUsedValue, and none after
+	void retire(uint64_t lastUsedValue);
+
+	// Reset the pools whose sets were retired at or below completedValue. Returns how many were reset.
+	size_t collect(uint64_t completedValue);
+
+	size_t getPoolCount() const { return mUsedPools.size() + mRetiredPools.size() + mFreePools.size(); }
+	size_t getCachedSetCount() const { return mCachedSets.size(); }
+
+	// Destroys every pool, and with them every set. Only call once the device is idle.
+	void cleanUp();
+
+private:
+	struct Pool
+	{
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		uint32_t maxSets = 0;
+	};
+
+	Pool acquirePool();
+	Pool createPool(uint32_t maxSets);
+
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+
+	std::vector<VkDescriptorPoolSize> mDescriptorsPerSet;
+	uint32_t mNextSetsPerPool = 0;
+
+	// The last used pool is the one allocated from
+	std::vector<Pool> mUsedPools;
+	std::deque<std::pair<uint64_t, Pool>> mRetiredPools; // Ordered by frame value
+	std::vector<Pool> mFreePools;
+
+	std::unordered_map<DescriptorSetDescription, VkDescriptorSet, DescriptorSetDescriptionHash> mCachedSets;
+};
+
+#endif // VULKAN_DESCRIPTOR_ALLOCATOR_H
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef VULKAN_FRAME_SYNC_H
+#define VULKAN_FRAME_SYNC_H
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/**
+ * CPU-GPU synchronization for frames in flight, built around a single monotonically increasing value.
+ *  Every submission through submit() signals the next value, so "has the GPU finished frame N" becomes
+ *  a comparison against the last completed value. Anything that needs to know when the GPU is done
+ *  with a resource, e.g. deferred deletion or reuse of a ring buffer slot, can remember the value of
+ *  the submission that used it and ask isComplete() later.
+ *
+ * A VK_KHR_timeline_semaphore semaphore carries the value when the device supports it. On plain
+ *  Vulkan 1.0 devices each submission gets a fence instead, and the completed value is advanced by
+ *  polling the fences in submission order.
+ *
+ * Only the thread submitting frames may use this.
+ */
+class VulkanFrameSync
+{
+public:
+	VulkanFrameSync() = default;
+
+	VulkanFrameSync(VulkanFrameSync const &) = delete;
+	VulkanFrameSync &operator=(VulkanFrameSync const &) = delete;
+
+	// Whether the device exposes VK_KHR_timeline_semaphore. The extension and its timelineSemaphore feature
+	//  must then be enabled on the logical device for lazyInit to use it.
+	static bool isTimelineSupported(VkPhysicalDevice);
+
+	void lazyInit(VkDevice, bool useTimeline, uint32_t framesInFlight);
+
+	// Blocks until every submitted frame has completed, then changes how many frames may be in flight
+	void setFramesInFlight(uint32_t);
+	uint32_t getFramesInFlight() const { return mFramesInFlight; }
+
+	// Wait until the per-frame resources of the next frame are free, and return their index
+	uint32_t beginFrame();
+
+	// Submit with the next frame value signaled on completion. Returns that value.
+	uint64_t submit(VkQueue, VkSubmitInfo);
+
+	uint64_t getSubmittedValue() const { return mSubmittedValue; }
+	uint64_t getCompletedValue();
+
+	bool isComplete(uint64_t value);
+	void wait(uint64_t value);
+
+	bool isUsingTimeline() const { return mTimelineSemaphore != VK_NULL_HANDLE; }
+
+	void cleanUp();
+
+private:
+	void retireFences();
+	VkFence acquireFence();
+
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+
+	uint32_t mFramesInFlight = 1;
+	uint64_t mSubmittedValue = 0;
+	uint64_t mCompletedValue = 0; // Cached, only ever increases
+
+	// Timeline path
+	VkSemaphore mTimelineSemaphore = VK_NULL_HANDLE;
+	PFN_vkGetSemaphoreCounterValueKHR mpGetSemaphoreCounterValue = nullptr;
+	PFN_vkWaitSemaphoresKHR mpWaitSemaphores = nullptr;
+
+	// Fence fallback path, pending fences are ordered by value
+	std::deque<std::pair<uint64_t, VkFence>> mPendingFences;
+	std::vector<VkFence> mFreeFences;
+};
+
+#endif // VULKAN_FRAME_SYNC_H
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef VULKAN_GEOMETRY_POOL_H
+#define VULKAN_GEOMETRY_POOL_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "RangeAllocator.h"
+#include "Vertex.h"
+#include "VulkanBuffer.h"
+#include "VulkanDeletionQueue.h"
+
+// Where a piece of geometry lives in the pool. Offsets are in vertices and in indices of indexType.
+struct GeometryAllocation
+{
+	uint32_t vertexOffset = 0;
+	uint32_t vertexCount = 0;
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+	bool isAlive = false;
+};
+
+/**
+ * Device local vertex and index buffers shared by every mesh, so a frame binds them once instead of per
+ *  draw. Geometry is addressed by handle; draws add the allocation's vertexOffset and firstIndex to their own.
+ *
+ * Vertices live in one arena and indices in one arena per index type, since a bound index buffer has a
+ *  single type. Each arena sub-allocates its buffer with a RangeAllocator. When an arena runs out of space
+ *  it is rebuilt into a buffer twice the size, which also compacts it: the live ranges are copied to the
+ *  front of the new buffer, in order. compact() does the same without growing, after meshes were removed.
+ *
+ * Removing geometry and rebuilding arenas both leave memory the GPU may still read, so the ranges and
+ *  old buffers are released through the deletion queue. Copies are submitted without waiting for the
+ *  queue, ahead of the next frame, whose frame value then also covers them. Only the render thread may
+ *  use the pool.
+ */
+class VulkanGeometryPool
+{
+public:
+	VulkanGeometryPool() = default;
+
+	VulkanGeometryPool(VulkanGeometryPool const &) = delete;
+	VulkanGeometryPool &operator=(VulkanGeometryPool const &) = delete;
+
+	// Capacities are in vertices and 16 bit indices. The 32 bit index arena starts empty.
+	void lazyInit(VkPhysicalDevice, VkDevice, VkCommandPool, VkQueue, VulkanDeletionQueue *, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	/**
+	 * Upload vertices and an index buffer in the given format. lastUsedValue is the frame value the GPU
+	 *  may still be reading the pool at, should an arena have to grow. Returns the geometry's handle,
+	 *  which may be one a removed geometry had.
+	 */
+	uint32_t addGeometry(std::vector<Vertex> const &, std::vector<uint8_t> const &indexData, VkIndexType, uint64_t lastUsedValue);
+
+	// The geometry's ranges become free once lastUsedValue has completed. Its handle is free right away.
+	void removeGeometry(uint32_t handle, uint64_t lastUsedValue);
+
+	// Move all live geometry to the front of the arenas, merging the free space into one range
+	void compact(uint64_t lastUsedValue);
+
+	GeometryAllocation const &getAllocation(uint32_t handle) const { return mAllocations[handle]; }
+
+	VkBuffer getVertexBuffer() const;
+	VkBuffer getIndexBuffer(VkIndexType) const;
+
+	// Bytes in use and reserved over all arenas, and the number of free ranges as a measure of fragmentation
+	VkDeviceSize getUsedBytes() const;
+	VkDeviceSize getCapacityBytes() const;
+	size_t getFreeRangeCount() const;
+
+	void cleanUp();
+
+private:
+	enum ArenaType : uint32_t
+	{
+		VertexArena,
+		Index16Arena,
+		Index32Arena,
+		ArenaCount
+	};
+
+	struct Arena
+	{
+		std::shared_ptr<VulkanBuffer> pBuffer;
+		RangeAllocator allocator;
+		VkDeviceSize elementSize = 0;
+		VkBufferUsageFlags usage = 0;
+		uint64_t generation = 0;	// Bumped by every rebuild, which invalidates pending frees
+	};
+
+	uint32_t allocate(ArenaType, uint32_t count, uint64_t lastUsedValue);
+	void rebuild(ArenaType, uint64_t capacity, uint64_t lastUsedValue);
+	void submitCopies(VkCommandBuffer, uint64_t lastUsedValue);
+
+	static ArenaType getIndexArena(VkIndexType);
+
+	static uint32_t &getOffset(GeometryAllocation &, ArenaType);
+	static uint32_t getCount(GeometryAllocation const &, ArenaType);
+	static bool usesArena(GeometryAllocation const &, ArenaType);
+
+	VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+	VkCommandPool mCommandPool = VK_NULL_HANDLE;
+	VkQueue mQueue = VK_NULL_HANDLE;
+	VulkanDeletionQueue *mpDeletionQueue = nullptr;
+
+	std::array<Arena, ArenaCount> mArenas;
+	std::vector<GeometryAllocation> mAllocations;
+	std::vector<uint32_t> mFreeHandles;	// Of removed geometry, handed out again before mAllocations grows
+};
+
+#endif // VULKAN_GEOMETRY_POOL_H
\ No newline at end of file
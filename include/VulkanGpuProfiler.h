@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef VULKAN_GPU_PROFILER_H
+#define VULKAN_GPU_PROFILER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "ChromeTrace.h"
+
+/**
+ * Measures named regions of command buffers with pairs of vkCmdWriteTimestamp queries. Every frame in
+ *  flight has its own query pool; the results of a pool are read back right before it is reset for
+ *  its next frame, when the frame that wrote them is known to have completed, so reading never stalls.
+ *  A frame whose results are somehow not available yet is dropped instead of waited on.
+ *
+ * Scopes may nest. Per scope name the profiler keeps a rolling window of durations for min/avg/p99,
+ *  and the most recent scopes as Chrome trace events on the GPU track. GPU timestamps have no relation
+ *  to the CPU clock, so each frame is placed on the trace starting at the CPU time its recording began.
+ *
+ * Only the thread recording frames may use this.
+ */
+class VulkanGpuProfiler
+{
+public:
+	struct ScopeStats
+	{
+		std::string name;
+		double minMilliseconds = 0.0;
+		double avgMilliseconds = 0.0;
+		double p99Milliseconds = 0.0;
+		size_t sampleCount = 0;
+	};
+
+	// One scope's duration in one frame, frameNumber is the one given to beginFrame
+	struct Sample
+	{
+		std::string name;
+		uint64_t frameNumber = 0;
+		double milliseconds = 0.0;
+	};
+
+	static constexpr uint32_t GPU_TRACK_ID = 0xFFFF; // Chrome trace thread id for GPU scopes
+
+	VulkanGpuProfiler() = default;
+
+	VulkanGpuProfiler(VulkanGpuProfiler const &) = delete;
+	VulkanGpuProfiler &operator=(VulkanGpuProfiler const &) = delete;
+
+	void lazyInit(VkPhysicalDevice, VkDevice, uint32_t queueFamilyIndex, uint32_t framesInFlight, uint32_t maxScopesPerFrame = 64);
+
+	// Recreates the query pools. The device must be idle.
+	void setFramesInFlight(uint32_t);
+
+	bool isSupported() const { return mSupported; }
+
+	// Read back the results of the previous use of this frame slot and reset its queries. Record this
+	//  outside of any render pass, before the first scope.
+	void beginFrame(VkCommandBuffer, uint32_t frameSlot, uint64_t frameNumber = 0);
+
+	// Read back every frame not read yet. The device must be idle.
+	void resolveAllFrames();
+
+	void beginScope(VkCommandBuffer, char const *name);
+	void endScope(VkCommandBuffer);
+
+	// Checks that every scope of the frame was ended, an open one would leave its end query unwritten and
+	//  the frame's results never available. Call this before ending the command buffer.
+	void endFrame();
+
+	std::vector<ScopeStats> getStats() const;
+
+	// While enabled, every sample read back is also kept until takeSamples, unlike the rolling window
+	//  behind getStats. Benchmarks use this to cover every measured frame.
+	void setKeepingSamples(bool keeping) { mKeepingSamples = keeping; }
+	std::vector<Sample> takeSamples();
+	std::string report() const;
+
+	void appendTraceEvents(ChromeTraceWriter &) const;
+
+	void cleanUp();
+
+private:
+	struct Scope
+	{
+		std::string name;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	struct FrameQueries
+	{
+		VkQueryPool queryPool = VK_NULL_HANDLE;
+		std::vector<Scope> scopes;
+		uint32_t queryCount = 0;
+		bool recorded = false;
+		uint64_t frameNumber = 0;
+		ChromeTraceWriter::Clock::time_point cpuBeginTime;
+	};
+
+	void createQueryPools(uint32_t framesInFlight);
+	void destroyQueryPools();
+	void resolveFrame(FrameQueries &);
+	void addSample(std::string const &name, double milliseconds);
+
+	static constexpr size_t SAMPLE_WINDOW = 240;
+	static constexpr size_t MAX_TRACE_EVENTS = 8192;
+
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+
+	bool mSupported = false;
+	double mTimestampPeriod = 1.0; // Nanoseconds per tick
+	uint64_t mTimestampMask = UINT64_MAX;
+	uint32_t mMaxQueriesPerFrame = 0;
+
+	std::vector<FrameQueries> mFrames;
+	FrameQueries *mpCurrentFrame = nullptr;
+	std::vector<size_t> mOpenScopes; // Indices into mpCurrentFrame->scopes, SIZE_MAX when out of queries
+
+	std::unordered_map<std::string, std::deque<double>> mSamples;
+	std::deque<ChromeTraceEvent> mTraceEvents;
+
+	bool mKeepingSamples = false;
+	std::vector<Sample> mKeptSamples;
+};
+
+#endif // VULKAN_GPU_PROFILER_H
\ No newline at end of file
@@ -3,11 +3,13 @@
 #ifndef VULKAN_IMAGE_H
 #define VULKAN_IMAGE_H
 
+#include <cstdint>
 #include <stdexcept>
 
 #include <vulkan/vulkan.h>
 
 #include "VulkanBaseObject.h"
+#include "VulkanDeletionQueue.h"
 
 VkImageView createImageView(VkDevice, VkImage, VkFormat, VkImageAspectFlags, uint32_t);
 
@@ -30,12 +32,20 @@ protected:
 
 	void transitionImageLayout(VkImageLayout, VkImageLayout, uint32_t);
 
+	// Submit a command buffer from beginSingleTimeCommands, waiting for it unless mDeferredSubmitValue is set
+	void endCommands(VkCommandBuffer);
+
 	VkImage mImage = VK_NULL_HANDLE;
 	VkImageView mImageView = VK_NULL_HANDLE;
 	VkFormat mFormat = VK_FORMAT_UNDEFINED;
 
 	VkCommandPool mCommandPool = VK_NULL_HANDLE;
 	VkQueue mQueue = VK_NULL_HANDLE;
+
+	// While mDeferredSubmitValue isn't 0, endCommands doesn't wait for the queue. Whatever the commands use must then
+	//  live until that frame value completes, so it goes through the deletion queue as well.
+	VulkanDeletionQueue *mpDeletionQueue = nullptr;
+	uint64_t mDeferredSubmitValue = 0;
 };
 
 #endif // VULKAN_IMAGE_VIEW_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef VULKAN_LAYOUT_CACHE_H
+#define VULKAN_LAYOUT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/**
+ * The bindings of a descriptor set layout, kept sorted by binding number so that the order they were
+ *  added in doesn't matter. Immutable samplers and pNext chains are not supported.
+ */
+struct DescriptorSetLayoutDescription
+{
+	VkDescriptorSetLayoutCreateFlags flags = 0;
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+	DescriptorSetLayoutDescription &addBinding(uint32_t binding, VkDescriptorType, uint32_t descriptorCount, VkShaderStageFlags);
+
+	bool operator==(DescriptorSetLayoutDescription const &) const;
+};
+
+struct DescriptorSetLayoutDescriptionHash
+{
+	size_t operator()(DescriptorSetLayoutDescription const &) const;
+};
+
+/**
+ * The set layouts, in set order, and push constant ranges of a pipeline layout. Ranges are kept sorted
+ *  by offset and stage. Set layouts should come from the same VulkanLayoutCache, so equal sets have equal
+ *  handles.
+ */
+struct PipelineLayoutDescription
+{
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	std::vector<VkPushConstantRange> pushConstantRanges;
+
+	PipelineLayoutDescription &addSetLayout(VkDescriptorSetLayout);
+	PipelineLayoutDescription &addPushConstantRange(VkShaderStageFlags, uint32_t offset, uint32_t size);
+
+	bool operator==(PipelineLayoutDescription const &) const;
+};
+
+struct PipelineLayoutDescriptionHash
+{
+	size_t operator()(PipelineLayoutDescription const &) const;
+};
+
+/**
+ * Hands out one canonical VkDescriptorSetLayout and VkPipelineLayout per description. Pipelines built from
+ *  equal descriptions get the very same layouts, so they are compatible by construction: descriptor sets
+ *  and push constants stay bound when switching between them, and recreating a pipeline (e.g. on resize)
+ *  doesn't create new layouts.
+ *
+ * Layouts are small and few, so they live until cleanUp rather than being reference counted.
+ */
+class VulkanLayoutCache
+{
+public:
+	VulkanLayoutCache() = default;
+
+	VulkanLayoutCache(VulkanLayoutCache const &) = delete;
+	VulkanLayoutCache &operator=(VulkanLayoutCache const &) = delete;
+
+	void lazyInit(VkDevice);
+
+	VkDescriptorSetLayout getDescriptorSetLayout(DescriptorSetLayoutDescription const &);
+	VkPipelineLayout getPipelineLayout(PipelineLayoutDescription const &);
+
+	size_t getDescriptorSetLayoutCount() const { return mDescriptorSetLayouts.size(); }
+	size_t getPipelineLayoutCount() const { return mPipelineLayouts.size(); }
+
+	// Destroys every layout. Only call once no pipeline or descriptor set using them is alive.
+	void cleanUp();
+
+private:
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+
+	std::unordered_map<DescriptorSetLayoutDescription, VkDescriptorSetLayout, DescriptorSetLayoutDescriptionHash> mDescriptorSetLayouts;
+	std::unordered_map<PipelineLayoutDescription, VkPipelineLayout, PipelineLayoutDescriptionHash> mPipelineLayouts;
+};
+
+#endif // VULKAN_LAYOUT_CACHE_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef VULKAN_MEMORY_STATS_H
+#define VULKAN_MEMORY_STATS_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+/**
+ * Counts the device memory allocations made through VulkanBaseObject, for benchmarks and budgeting.
+ *  Every vkAllocateMemory in the renderer goes through VulkanBaseObject::allocateMemory and every
+ *  vkFreeMemory through VulkanBaseObject::freeMemory, which report here.
+ *
+ * Thread safe, the texture streamer allocates from its own thread.
+ */
+class VulkanMemoryStats
+{
+public:
+	struct Snapshot
+	{
+		uint64_t allocationCount = 0;	// vkAllocateMemory calls since start, or the last resetCounters
+		uint64_t freeCount = 0;
+		uint64_t liveAllocations = 0;
+		VkDeviceSize liveBytes = 0;
+		VkDeviceSize peakBytes = 0;		// Highest liveBytes since start, or the last resetCounters
+	};
+
+	static VulkanMemoryStats &get();
+
+	VulkanMemoryStats(VulkanMemoryStats const &) = delete;
+	VulkanMemoryStats &operator=(VulkanMemoryStats const &) = delete;
+
+	void recordAllocation(VkDeviceMemory, VkDeviceSize);
+	void recordFree(VkDeviceMemory);
+
+	Snapshot getSnapshot();
+
+	// Restart the allocation and free counts and the peak, e.g. after loading. Live allocations stay tracked.
+	void resetCounters();
+
+private:
+	VulkanMemoryStats() = default;
+
+	std::mutex mMutex;
+	std::unordered_map<VkDeviceMemory, VkDeviceSize> mAllocationSizes;
+	Snapshot mSnapshot;
+};
+
+#endif // VULKAN_MEMORY_STATS_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef VULKAN_OFFSCREEN_TARGET_H
+#define VULKAN_OFFSCREEN_TARGET_H
+
+#include <string>
+#include <vector>
+
+#include "VulkanImage.h"
+
+/**
+ * A color image that stands in for a swap chain image when rendering without a window. It can be
+ *  rendered to like a swap chain image and copied back to the host afterwards.
+ */
+class VulkanOffscreenTarget : public VulkanImage
+{
+public:
+	VulkanOffscreenTarget() = default;
+
+	// Copy assignment
+	VulkanOffscreenTarget &operator=(const VulkanOffscreenTarget &) = delete;
+
+	// Move assignment
+	VulkanOffscreenTarget &operator=(VulkanOffscreenTarget &&) = delete;
+
+	void lazyInit(VkPhysicalDevice, VkDevice, uint32_t width, uint32_t height, VkFormat);
+
+	VkImage getImage() const { return mImage; }
+
+	// Copy the image to the host as tightly packed texels. The image must be in TRANSFER_SRC_OPTIMAL
+	//  layout and no longer written to by the GPU, with the writes made visible to transfer reads, as
+	//  the headless render pass's dependency on VK_SUBPASS_EXTERNAL does.
+	std::vector<unsigned char> readPixels(VkCommandPool, VkQueue) const;
+
+	// Only for the 4 byte RGBA formats
+	void writePng(std::string const &fileName, VkCommandPool, VkQueue) const;
+
+	void cleanUp()
+	{
+		vkDestroyImage(mLogicalDevice, mImage, nullptr);
+		freeMemory(mMemoryHandle);
+	}
+
+private:
+	uint32_t mWidth = 0;
+	uint32_t mHeight = 0;
+};
+
+#endif // VULKAN_OFFSCREEN_TARGET_H
\ No newline at end of file
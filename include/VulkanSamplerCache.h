@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef VULKAN_SAMPLER_CACHE_H
+#define VULKAN_SAMPLER_CACHE_H
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+/**
+ * The parts of VkSamplerCreateInfo that make two samplers different. No pNext chain or flags
+ *  are supported.
+ */
+struct SamplerDescription
+{
+	VkFilter magFilter = VK_FILTER_LINEAR;
+	VkFilter minFilter = VK_FILTER_LINEAR;
+	VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	float mipLodBias = 0.0f;
+	VkBool32 anisotropyEnable = VK_FALSE;
+	float maxAnisotropy = 1.0f;
+	VkBool32 compareEnable = VK_FALSE;
+	VkCompareOp compareOp = VK_COMPARE_OP_ALWAYS;
+	float minLod = 0.0f;
+	float maxLod = VK_LOD_CLAMP_NONE;
+	VkBorderColor borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	VkBool32 unnormalizedCoordinates = VK_FALSE;
+
+	bool operator==(SamplerDescription const &) const;
+
+	VkSamplerCreateInfo getCreateInfo() const;
+};
+
+struct SamplerDescriptionHash
+{
+	size_t operator()(SamplerDescription const &) const;
+};
+
+/**
+ * Shares one VkSampler between every user asking for the same sampler state. Samplers are reference
+ *  counted and destroyed when the last user releases them, which keeps the sampler count far below
+ *  maxSamplerAllocationCount even with thousands of textures.
+ *
+ * The physical device properties are queried once here, so users that need a limit such as
+ *  maxSamplerAnisotropy can read it from the cache instead of asking the driver again.
+ */
+class VulkanSamplerCache
+{
+public:
+	VulkanSamplerCache() = default;
+
+	VulkanSamplerCache(VulkanSamplerCache const &) = delete;
+	VulkanSamplerCache &operator=(VulkanSamplerCache const &) = delete;
+
+	void lazyInit(VkPhysicalDevice, VkDevice);
+
+	VkSampler acquire(SamplerDescription const &);
+	void release(VkSampler);
+
+	VkPhysicalDeviceLimits const &getLimits() const { return mProperties.limits; }
+	size_t getSamplerCount() const;
+
+	void cleanUp();
+
+private:
+	struct CachedSampler
+	{
+		VkSampler sampler = VK_NULL_HANDLE;
+		uint32_t refCount = 0;
+	};
+
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+	VkPhysicalDeviceProperties mProperties{};
+
+	mutable std::mutex mMutex;
+	std::unordered_map<SamplerDescription, CachedSampler, SamplerDescriptionHash> mSamplers;
+	std::unordered_map<VkSampler, SamplerDescription> mDescriptions; // For finding the entry on release
+};
+
+#endif // VULKAN_SAMPLER_CACHE_H
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef VULKAN_SHADER_LIBRARY_H
+#define VULKAN_SHADER_LIBRARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "MappedFile.h"
+
+// The words of a validated SPIR-V module, valid until the library that loaded it removes the file or cleans up
+struct SpirvCode
+{
+	uint32_t const *pWords = nullptr;
+	size_t wordCount = 0;
+	uint64_t hash = 0;
+};
+
+/**
+ * Loads every SPIR-V file once and keeps it for pipeline builds to come, e.g. on every swap chain
+ *  recreation. Files are memory mapped rather than read, checked to be SPIR-V and hashed. Shader
+ *  modules are created once per distinct content, so two files with the same code share a module.
+ *
+ * preload starts loading files, and creating their modules, on worker threads so that the I/O and
+ *  the driver's work overlap with other start up work. Asking for a file that is still loading waits
+ *  for it; asking for one that was never preloaded loads it on the calling thread. SPIR-V compiled
+ *  into the executable is added under a file name instead, and that file is then never read.
+ *
+ * The modules belong to the library, callers must not destroy them. remove gives up a file that is no
+ *  longer needed, such as SPIR-V a shader reload replaced, and its module once no other file shares it.
+ */
+class VulkanShaderLibrary
+{
+public:
+	VulkanShaderLibrary() = default;
+
+	VulkanShaderLibrary(VulkanShaderLibrary const &) = delete;
+	VulkanShaderLibrary &operator=(VulkanShaderLibrary const &) = delete;
+
+	void lazyInit(VkDevice);
+
+	void preload(std::vector<std::string> const &fileNames);
+
+	// The words must stay valid until cleanUp, as for embedded arrays with static storage
+	void addEmbedded(std::string const &fileName, uint32_t const *pWords, size_t wordCount);
+
+	SpirvCode const &getCode(std::string const &fileName);
+	VkShaderModule getShaderModule(std::string const &fileName);
+
+	// Unmaps the file and destroys its module unless another file shares it. Neither may still be in use.
+	void remove(std::string const &fileName);
+
+	size_t getFileCount() const;
+	size_t getModuleCount() const;
+
+	// Waits for preloads still running, then destroys every module and unmaps every file
+	void cleanUp();
+
+private:
+	struct ShaderFile
+	{
+		MappedFile mapping;
+		SpirvCode code;
+		VkShaderModule module = VK_NULL_HANDLE;
+		std::shared_future<void> loaded;
+	};
+
+	struct CachedModule
+	{
+		SpirvCode code; // Of a file loaded with this content and not removed
+		VkShaderModule module;
+	};
+
+	ShaderFile &getFile(std::string const &, std::launch);
+	void loadFile(ShaderFile &, std::string const &);
+	void useCode(ShaderFile &, std::string const &, uint32_t const *, size_t);
+	void acquireModule(ShaderFile &);
+
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+
+	mutable std::mutex mFilesMutex;
+	std::unordered_map<std::string, std::unique_ptr<ShaderFile>> mFiles;
+
+	mutable std::mutex mModulesMutex;
+	std::unordered_multimap<uint64_t, CachedModule> mModules; // By content hash. ShaderFile::module is also guarded by it.
+};
+
+#endif // VULKAN_SHADER_LIBRARY_H
\ No newline at end of file
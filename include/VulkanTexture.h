@@ -3,42 +3,86 @@
 #ifndef VULKAN_TEXTURE_H
 #define VULKAN_TEXTURE_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "VulkanBaseObject.h"
 #include "VulkanImage.h"
+#include "VulkanSamplerCache.h"
 
-// Maybe one texture can hold multiple images?
+namespace vkTextureUtils
+{
+	// Decode an image file to RGBA8. Free the pixels with stbi_image_free.
+	unsigned char *loadTextureImage(std::string, int *, int *, int *);
+
+	uint32_t computeMipLevels(uint32_t, uint32_t);
+
+	// Bytes taken by the mip chain starting at the given level, assuming 4 bytes per texel
+	VkDeviceSize computeMipChainSize(uint32_t, uint32_t, uint32_t);
+
+	// Decode an image file and box filter it down to the requested level of its full mip chain
+	std::vector<unsigned char> loadTextureMip(std::string const &, uint32_t, uint32_t *, uint32_t *);
+}
+
+/**
+ * A sampled texture with a full mip chain. Only the levels from mResidentBaseMip down to the
+ *  smallest level live in device memory, which lets the texture streamer keep large textures
+ *  at a coarse resolution until they are needed up close. Mip levels are always numbered against
+ *  the full chain of the source image, so level 0 is the full resolution image even when it is
+ *  not resident.
+ */
 class VulkanTexture : public VulkanImage
 {
 public:
 	VulkanTexture() = default;
-	VulkanTexture(std::string, VkPhysicalDevice, VkDevice, VkMemoryPropertyFlags, VkCommandPool, VkQueue);
+	VulkanTexture(std::string, VkPhysicalDevice, VkDevice, VkMemoryPropertyFlags, VkCommandPool, VkQueue, VulkanSamplerCache *);
+
+	// maxResidentExtent limits the size of the finest resident mip. 0 means load every level.
+	//  Replaced images go through the deletion queue, so only textures given one can change their resident mips.
+	void lazyInit(std::string, VkPhysicalDevice, VkDevice, VkMemoryPropertyFlags, VkCommandPool, VkQueue, VulkanSamplerCache *,
+		VulkanDeletionQueue *, uint32_t maxResidentExtent = 0);
 
-	void lazyInit(std::string, VkPhysicalDevice, VkDevice, VkMemoryPropertyFlags, VkCommandPool, VkQueue);
+	// lastUsedValue is the frame value of the last submission that may sample the current image
+	void uploadResidentMips(unsigned char const *, uint32_t, uint64_t lastUsedValue);
+	void trimResidentMips(uint32_t, uint64_t lastUsedValue);
 
 	VkImageView getTextureImageView() const { return mImageView; }
 	VkSampler getTextureSampler() const { return mTextureSampler; }
 
+	uint32_t getWidth() const { return mWidth; }
+	uint32_t getHeight() const { return mHeight; }
+	uint32_t getMipLevels() const { return mMipLevels; }
+	uint32_t getResidentBaseMip() const { return mResidentBaseMip; }
+	uint32_t getResidentMipLevels() const { return mMipLevels - mResidentBaseMip; }
+	std::string const &getFileName() const { return mFileName; }
+
 	void cleanUp()
 	{
-		vkDestroySampler(mLogicalDevice, mTextureSampler, nullptr);
+		// The sampler is shared with other textures through the cache
+		mpSamplerCache->release(mTextureSampler);
 		vkDestroyImageView(mLogicalDevice, mImageView, nullptr);
 
 		vkDestroyImage(mLogicalDevice, mImage, nullptr);
-		vkFreeMemory(mLogicalDevice, mMemoryHandle, nullptr);
+		freeMemory(mMemoryHandle);
 	}
 
 private:
-	void copyBufferToImage(VkBuffer);
-	void createTextureImage(VkMemoryPropertyFlags);
+	void copyBufferToImage(VkBuffer, uint32_t, uint32_t);
+	void createTextureImage(uint32_t);
+	void createResidentImage(unsigned char const *, uint32_t);
 	void createTextureImageView();
 	void createTextureSampler();
-	void generateMipmaps();
+	void generateMipmaps(uint32_t, uint32_t, uint32_t);
+	void retireImage(VkImage, VkImageView, VkDeviceMemory, uint64_t);
 
 	uint32_t mWidth = 0, mHeight = 0, mMipLevels = 0;
+	uint32_t mResidentBaseMip = 0;
+
+	VkMemoryPropertyFlags mProperties = 0;
 
 	VkSampler mTextureSampler = VK_NULL_HANDLE;
+	VulkanSamplerCache *mpSamplerCache = nullptr;
 
 	std::string mFileName;
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef VULKAN_TEXTURE_REGISTRY_H
+#define VULKAN_TEXTURE_REGISTRY_H
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanTexture.h"
+
+/**
+ * Hands out stable indices into one large array of combined image samplers, so every material can be
+ *  drawn with the same descriptor set and pick its texture by index in the shader. Unused slots point
+ *  at the first registered texture because the array is read without partially bound descriptors.
+ *
+ * The registry doesn't own the textures, it only remembers where to read the current image view and
+ *  sampler from whenever the descriptors are written.
+ */
+class VulkanTextureRegistry
+{
+public:
+	VulkanTextureRegistry() = default;
+
+	// Capacity is clamped to the device descriptor limits. Without dynamic indexing it is always 1.
+	void lazyInit(VkPhysicalDevice, uint32_t maxTextures, bool dynamicIndexingSupported);
+
+	uint32_t registerTexture(VulkanTexture const *);
+	void unregisterTexture(uint32_t);
+
+	// One entry per slot, ready for a VkWriteDescriptorSet covering the whole array
+	std::vector<VkDescriptorImageInfo> getImageInfos() const;
+
+	uint32_t getCapacity() const { return mCapacity; }
+	uint32_t getTextureCount() const { return mTextureCount; }
+
+private:
+	uint32_t mCapacity = 0;
+	uint32_t mTextureCount = 0;
+	uint32_t mFallbackIndex = 0;
+
+	std::vector<VulkanTexture const *> mSlots;
+	std::vector<uint32_t> mFreeSlots;
+};
+
+#endif // VULKAN_TEXTURE_REGISTRY_H
\ No newline at end of file
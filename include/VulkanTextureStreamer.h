@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef VULKAN_TEXTURE_STREAMER_H
+#define VULKAN_TEXTURE_STREAMER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanDeletionQueue.h"
+#include "VulkanSamplerCache.h"
+#include "VulkanTexture.h"
+
+/**
+ * Keeps the mip residency of a set of textures within a device memory budget.
+ *
+ * Textures start with only their coarse levels resident. Every frame the application reports how
+ *  many pixels each texture covers on screen, which decides the finest mip that is worth having.
+ *  Finer levels are decoded from disk on a worker thread and uploaded in update(). When an upload
+ *  would exceed the budget, the finest levels of the least recently used textures are evicted first.
+ *  Neither waits for the GPU: replaced images go through the deletion queue.
+ */
+class VulkanTextureStreamer
+{
+public:
+	VulkanTextureStreamer() = default;
+
+	VulkanTextureStreamer(VulkanTextureStreamer const &) = delete;
+	VulkanTextureStreamer &operator=(VulkanTextureStreamer const &) = delete;
+
+	// initialResidentExtent is the size of the finest level loaded when a texture is added
+	void lazyInit(VkPhysicalDevice, VkDevice, VkCommandPool, VkQueue, VulkanSamplerCache *, VulkanDeletionQueue *, VkDeviceSize memoryBudget, uint32_t initialResidentExtent = 128);
+
+	uint32_t addTexture(std::string const &);
+
+	void requestFootprint(uint32_t, float, uint64_t);
+
+	// Returns true if any texture got a new image view and the descriptors using it must be rewritten. lastUsedValue
+	//  is the frame value of the last submission that may sample the current images.
+	bool update(uint64_t lastUsedValue);
+
+	void setMemoryBudget(VkDeviceSize memoryBudget) { mMemoryBudget = memoryBudget; }
+	VkDeviceSize getMemoryBudget() const { return mMemoryBudget; }
+	VkDeviceSize getResidentMemory() const;
+
+	VulkanTexture &getTexture(uint32_t handle) { return mTextures[handle]->texture; }
+	VulkanTexture const &getTexture(uint32_t handle) const { return mTextures[handle]->texture; }
+	size_t getTextureCount() const { return mTextures.size(); }
+
+	static uint32_t computeRequiredMip(uint32_t, uint32_t, float);
+
+	void cleanUp();
+
+private:
+	struct StreamedTexture
+	{
+		VulkanTexture texture;
+		uint32_t requestedBaseMip = 0;	// Finest level wanted by the footprints of lastUsedFrame
+		uint32_t coarsestBaseMip = 0;	// Levels from here down are never evicted
+		uint64_t lastUsedFrame = 0;
+		bool loadPending = false;
+		bool loadFailed = false;
+	};
+
+	struct StreamRequest
+	{
+		uint32_t handle;
+		uint32_t baseMip;
+		std::string fileName;
+	};
+
+	struct StreamResult
+	{
+		uint32_t handle;
+		uint32_t baseMip;
+		std::vector<unsigned char> pixels;
+	};
+
+	void workerLoop();
+	bool makeRoom(VkDeviceSize, uint32_t, uint64_t, bool &);
+	VkDeviceSize getResidentSize(StreamedTexture const &) const;
+
+	VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice mLogicalDevice = VK_NULL_HANDLE;
+	VkCommandPool mCommandPool = VK_NULL_HANDLE;
+	VkQueue mQueue = VK_NULL_HANDLE;
+	VulkanSamplerCache *mpSamplerCache = nullptr;
+	VulkanDeletionQueue *mpDeletionQueue = nullptr;
+
+	VkDeviceSize mMemoryBudget = 0;
+	uint32_t mInitialResidentExtent = 0;
+
+	std::vector<std::shared_ptr<StreamedTexture>> mTextures;
+
+	// Shared with the worker thread
+	std::thread mWorker;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::deque<StreamRequest> mRequests;
+	std::vector<StreamResult> mResults;
+	bool mStopWorker = false;
+};
+
+#endif // VULKAN_TEXTURE_STREAMER_H
\ No newline at end of file
@@ -3,6 +3,9 @@
 #ifndef VULKAN_UTILS_H
 #define VULKAN_UTILS_H
 
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -30,6 +33,18 @@ namespace vkutils
 	);
 
 	bool hasStencilComponent(VkFormat);
+
+	// Read a whole binary file, e.g. SPIR-V bytecode
+	std::vector<char> readFile(const std::string &);
+
+	// The bits of a non-dispatchable handle, which is a pointer on 64 bit platforms and uint64_t elsewhere
+	template <typename Handle>
+	uint64_t handleBits(Handle handle)
+	{
+		uint64_t bits = 0;
+		std::memcpy(&bits, &handle, sizeof(handle));
+		return bits;
+	}
 }
 
 #endif // VULKAN_UTILS_H
\ No newline at end of file
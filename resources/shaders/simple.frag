@@ -4,7 +4,16 @@
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Size of the bindless texture array, specialized at pipeline creation from the texture registry capacity
+layout(constant_id = 0) const uint TEXTURE_ARRAY_SIZE = 1;
+
+layout(binding = 1) uniform sampler2D texSamplers[TEXTURE_ARRAY_SIZE];
+
+// The fragment stage's part of DrawPushConstants, after the vertex stage's model matrix
+layout(push_constant) uniform DrawPushConstants
+{
+	layout(offset = 64) uint materialIndex;
+} draw;
 
 layout(location = 0) out vec4 outColor;
 
@@ -12,5 +21,5 @@ void main()
 {
 	//outColor = vec4(fragColor, 1.0);
 	//outColor = vec4(fragTexCoord, 0.0, 1.0);
-	outColor = texture(texSampler, fragTexCoord);
+	outColor = texture(texSamplers[draw.materialIndex], fragTexCoord);
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject
+// Per draw, must match DrawPushConstants in main.cpp. The model matrix comes premultiplied by the camera's
+//  view projection, leaving one matrix multiply per vertex.
+layout(push_constant) uniform DrawPushConstants
 {
-	mat4 model;
-	mat4 view;
-	mat4 proj;
-} ubo;
+	mat4 modelViewProj;
+} draw;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -17,7 +17,7 @@ layout(location = 1) out vec2 fragTexCoord;
 
 void main()
 {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	gl_Position = draw.modelViewProj * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "BenchmarkReport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "ChromeTrace.h"
+
+namespace
+{
+	// Nearest rank percentile of sorted samples
+	double percentile(std::vector<double> const &sorted, double fraction)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+
+		size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+		return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+	}
+
+	// The summary of a set of times as a JSON object
+	void writeStats(std::ostream &out, std::vector<double> sorted)
+	{
+		std::sort(sorted.begin(), sorted.end());
+
+		double sum = 0.0;
+		for (double milliseconds : sorted)
+		{
+			sum += milliseconds;
+		}
+		double average = sorted.empty() ? 0.0 : sum / sorted.size();
+
+		out << "{"
+			<< "\"avg\": " << average
+			<< ", \"min\": " << (sorted.empty() ? 0.0 : sorted.front())
+			<< ", \"p50\": " << percentile(sorted, 0.50)
+			<< ", \"p95\": " << percentile(sorted, 0.95)
+			<< ", \"p99\": " << percentile(sorted, 0.99)
+			<< ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back())
+			<< ", \"samples\": " << sorted.size() << "}";
+	}
+}
+
+void BenchmarkReport::setInfo(std::string const &key, std::string const &value)
+{
+	mInfo.emplace_back(key, "\"" + ChromeTraceWriter::escape(value) + "\"");
+}
+
+void BenchmarkReport::setInfo(std::string const &key, double value)
+{
+	// JSON has no NaN or infinity
+	if (!std::isfinite(value))
+	{
+		mInfo.emplace_back(key, "null");
+		return;
+	}
+
+	std::ostringstream out;
+	out << value;
+	mInfo.emplace_back(key, out.str());
+}
+
+std::string BenchmarkReport::toJson() const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(4);
+
+	out << "{\n";
+	out << "\t\"scenario\": \"" << ChromeTraceWriter::escape(mScenario.name) << "\",\n";
+	out << "\t\"parameters\": {"
+		<< "\"instanceCount\": " << mScenario.instanceCount
+		<< ", \"textureCount\": " << mScenario.textureCount
+		<< ", \"resizeInterval\": " << mScenario.resizeInterval
+		<< ", \"uploadInterval\": " << mScenario.uploadInterval << "},\n";
+
+	out << "\t\"info\": {";
+	for (size_t i = 0; i < mInfo.size(); ++i)
+	{
+		out << (i ? ", " : "") << "\"" << ChromeTraceWriter::escape(mInfo[i].first) << "\": " << mInfo[i].second;
+	}
+	out << "},\n";
+
+	out << "\t\"frames\": " << mFrameMilliseconds.size() << ",\n";
+	out << "\t\"cpuFrameMilliseconds\": ";
+	writeStats(out, mFrameMilliseconds);
+	out << ",\n";
+
+	out << "\t\"gpuMilliseconds\": {";
+	bool first = true;
+	for (std::pair<std::string const, std::vector<double>> const &scope : mGpuMilliseconds)
+	{
+		out << (first ? "" : ",") << "\n\t\t\"" << ChromeTraceWriter::escape(scope.first) << "\": ";
+		writeStats(out, scope.second);
+		first = false;
+	}
+	out << (mGpuMilliseconds.empty() ? "},\n" : "\n\t},\n");
+
+	out << "\t\"memory\": {"
+		<< "\"allocationCount\": " << mMemoryStats.allocationCount
+		<< ", \"freeCount\": " << mMemoryStats.freeCount
+		<< ", \"liveAllocations\": " << mMemoryStats.liveAllocations
+		<< ", \"liveBytes\": " << mMemoryStats.liveBytes
+		<< ", \"peakBytes\": " << mMemoryStats.peakBytes << "}\n";
+	out << "}\n";
+
+	return out.str();
+}
+
+void BenchmarkReport::write(std::string const &fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("[ERROR] Failed to open benchmark results file " + fileName + "!");
+	}
+
+	file << toJson();
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "BenchmarkScenario.h"
+
+#include <stdexcept>
+
+BenchmarkScenario BenchmarkScenario::fromName(std::string const &name)
+{
+	BenchmarkScenario scenario;
+	scenario.name = name;
+
+	if (name == "baseline")
+	{
+		return scenario;
+	}
+	else if (name == "instances")
+	{
+		// Draw call and recording overhead
+		scenario.instanceCount = 1024;
+	}
+	else if (name == "textures")
+	{
+		// Descriptor array size and texture streaming with many residents
+		scenario.instanceCount = 256;
+		scenario.textureCount = 64;
+	}
+	else if (name == "resize-storm")
+	{
+		// Swap chain recreation and deferred deletion
+		scenario.resizeInterval = 10;
+	}
+	else if (name == "upload-burst")
+	{
+		// Staging uploads competing with rendering for the queue
+		scenario.uploadInterval = 5;
+	}
+	else
+	{
+		throw std::runtime_error("[ERROR] Unknown benchmark scenario " + name + "!");
+	}
+
+	return scenario;
+}
+
+std::vector<std::string> BenchmarkScenario::getNames()
+{
+	return { "baseline", "instances", "textures", "resize-storm", "upload-burst" };
+}
\ No newline at end of file
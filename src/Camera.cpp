@@ -0,0 +1,64 @@
+#include "Camera.h"
+
+// Force glm::rotate to use radians as arguments
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+void Camera::setLookAt(glm::vec3 const &position, glm::vec3 const &target, glm::vec3 const &up)
+{
+	if (position == mPosition && target == mTarget && up == mUp)
+	{
+		return;
+	}
+
+	mPosition = position;
+	mTarget = target;
+	mUp = up;
+	mViewDirty = true;
+}
+
+void Camera::setPerspective(float fovY, float aspectRatio, float nearPlane, float farPlane)
+{
+	if (fovY == mFovY && aspectRatio == mAspectRatio && nearPlane == mNearPlane && farPlane == mFarPlane)
+	{
+		return;
+	}
+
+	mFovY = fovY;
+	mAspectRatio = aspectRatio;
+	mNearPlane = nearPlane;
+	mFarPlane = farPlane;
+	mProjDirty = true;
+}
+
+bool Camera::update()
+{
+	if (!mViewDirty && !mProjDirty)
+	{
+		return false;
+	}
+
+	if (mViewDirty)
+	{
+		mView = glm::lookAt(mPosition, mTarget, mUp);
+	}
+
+	if (mProjDirty)
+	{
+		mProj = glm::perspective(mFovY, mAspectRatio, mNearPlane, mFarPlane);
+
+		// glm was original made for OpenGL, where Y coordinate of the clip coordinates is inverted, we need to flip
+		//  this dimension for Vulkan
+		mProj[1][1] *= -1; // We flip the sign on the scaling factor of the Y axis in the projection matrix
+	}
+
+	// Premultiplied once here rather than for every vertex in the shader
+	mViewProj = mProj * mView;
+
+	mViewDirty = false;
+	mProjDirty = false;
+	++mVersion;
+
+	return true;
+}
\ No newline at end of file
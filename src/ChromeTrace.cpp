@@ -0,0 +1,114 @@
+#include "ChromeTrace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	// Taken during static initialization so every event recorded at runtime comes after it
+	const ChromeTraceWriter::Clock::time_point traceEpoch = ChromeTraceWriter::Clock::now();
+}
+
+double ChromeTraceWriter::toMicroseconds(Clock::time_point timePoint)
+{
+	return std::chrono::duration<double, std::micro>(timePoint - traceEpoch).count();
+}
+
+void ChromeTraceWriter::setThreadName(uint32_t threadId, std::string const &name)
+{
+	mThreadNames[threadId] = name;
+}
+
+void ChromeTraceWriter::addEvent(ChromeTraceEvent const &event)
+{
+	mEvents.push_back(event);
+}
+
+void ChromeTraceWriter::addEvents(std::vector<ChromeTraceEvent> const &events)
+{
+	mEvents.insert(mEvents.end(), events.begin(), events.end());
+}
+
+std::string ChromeTraceWriter::toJson() const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "{\"traceEvents\":[";
+
+	bool first = true;
+
+	for (std::pair<uint32_t const, std::string> const &threadName : mThreadNames)
+	{
+		out << (first ? "\n" : ",\n");
+		first = false;
+
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadName.first
+			<< ",\"args\":{\"name\":\"" << escape(threadName.second) << "\"}}";
+	}
+
+	for (ChromeTraceEvent const &event : mEvents)
+	{
+		out << (first ? "\n" : ",\n");
+		first = false;
+
+		out << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"" << escape(event.category)
+			<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+			<< ",\"ts\":" << event.timestampMicroseconds
+			<< ",\"dur\":" << event.durationMicroseconds << "}";
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return out.str();
+}
+
+void ChromeTraceWriter::write(std::string const &fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("[ERROR] Failed to open trace file " + fileName + "!");
+	}
+
+	file << toJson();
+}
+
+void ChromeTraceWriter::clear()
+{
+	mEvents.clear();
+	mThreadNames.clear();
+}
+
+std::string ChromeTraceWriter::escape(std::string const &text)
+{
+	std::string escaped;
+	escaped.reserve(text.size());
+
+	for (char c : text)
+	{
+		switch (c)
+		{
+		case '"':	escaped += "\\\""; break;
+		case '\\':	escaped += "\\\\"; break;
+		case '\n':	escaped += "\\n"; break;
+		case '\t':	escaped += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				escaped += buffer;
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
+	}
+
+	return escaped;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "CpuProfiler.h"
+
+#include <algorithm>
+
+CpuProfiler &CpuProfiler::get()
+{
+	static CpuProfiler profiler;
+	return profiler;
+}
+
+CpuProfiler::ThreadBuffer &CpuProfiler::getThreadBuffer()
+{
+	thread_local std::shared_ptr<ThreadBuffer> pThreadBuffer;
+
+	if (!pThreadBuffer)
+	{
+		pThreadBuffer = std::make_shared<ThreadBuffer>();
+		pThreadBuffer->events.resize(EVENTS_PER_THREAD);
+
+		std::lock_guard<std::mutex> lock(mBuffersMutex);
+		pThreadBuffer->threadId = static_cast<uint32_t>(mBuffers.size() + 1);
+		pThreadBuffer->name = "Thread " + std::to_string(pThreadBuffer->threadId);
+		mBuffers.push_back(pThreadBuffer);
+	}
+
+	return *pThreadBuffer;
+}
+
+void CpuProfiler::setThreadName(std::string const &name)
+{
+	ThreadBuffer &buffer = getThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+void CpuProfiler::record(char const *name, Clock::time_point begin, Clock::time_point end)
+{
+	ThreadBuffer &buffer = getThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events[buffer.writeCount % EVENTS_PER_THREAD] = { name, begin, end };
+	++buffer.writeCount;
+}
+
+void CpuProfiler::appendTraceEvents(ChromeTraceWriter &writer)
+{
+	std::lock_guard<std::mutex> buffersLock(mBuffersMutex);
+
+	for (std::shared_ptr<ThreadBuffer> const &pBuffer : mBuffers)
+	{
+		std::lock_guard<std::mutex> lock(pBuffer->mutex);
+
+		writer.setThreadName(pBuffer->threadId, pBuffer->name);
+
+		uint64_t count = std::min<uint64_t>(pBuffer->writeCount, EVENTS_PER_THREAD);
+		uint64_t first = pBuffer->writeCount - count;
+
+		for (uint64_t i = first; i < pBuffer->writeCount; ++i)
+		{
+			Event const &event = pBuffer->events[i % EVENTS_PER_THREAD];
+
+			ChromeTraceEvent traceEvent;
+			traceEvent.name = event.name;
+			traceEvent.category = "cpu";
+			traceEvent.threadId = pBuffer->threadId;
+			traceEvent.timestampMicroseconds = ChromeTraceWriter::toMicroseconds(event.begin);
+			traceEvent.durationMicroseconds = std::chrono::duration<double, std::micro>(event.end - event.begin).count();
+
+			writer.addEvent(traceEvent);
+		}
+	}
+}
+
+void CpuProfiler::clear()
+{
+	std::lock_guard<std::mutex> buffersLock(mBuffersMutex);
+
+	for (std::shared_ptr<ThreadBuffer> const &pBuffer : mBuffers)
+	{
+		std::lock_guard<std::mutex> lock(pBuffer->mutex);
+		pBuffer->writeCount = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "FrameStageTimings.h"
+
+#include <iomanip>
+#include <sstream>
+
+void FrameStageTimings::record(FrameStage stage, double milliseconds)
+{
+	mTotals[static_cast<size_t>(stage)] += milliseconds;
+}
+
+bool FrameStageTimings::shouldReport(double intervalSeconds) const
+{
+	return std::chrono::duration<double>(Clock::now() - mIntervalStart).count() >= intervalSeconds;
+}
+
+/**
+ * The update thread runs alongside the render thread, so its time isn't part of the render thread's
+ *  frame. What the render thread spends waiting says who is slower: waiting for packets means the update
+ *  thread bounds throughput, waiting on fences means the GPU does, otherwise it's the render thread itself.
+ */
+std::string FrameStageTimings::report()
+{
+	double elapsedSeconds = std::chrono::duration<double>(Clock::now() - mIntervalStart).count();
+	double frames = mFrameCount ? static_cast<double>(mFrameCount) : 1.0;
+
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "[FRAME] " << mFrameCount / elapsedSeconds << " fps |";
+
+	for (size_t i = 0; i < mTotals.size(); ++i)
+	{
+		out << " " << getStageName(static_cast<FrameStage>(i)) << " " << mTotals[i] / frames << " ms";
+	}
+
+	double packetWait = mTotals[static_cast<size_t>(FrameStage::PacketWait)];
+	double fenceWait = mTotals[static_cast<size_t>(FrameStage::FenceWait)];
+	double renderWork = mTotals[static_cast<size_t>(FrameStage::Acquire)]
+		+ mTotals[static_cast<size_t>(FrameStage::Record)]
+		+ mTotals[static_cast<size_t>(FrameStage::Submit)]
+		+ mTotals[static_cast<size_t>(FrameStage::Present)];
+
+	char const *bound = "render thread";
+	if (packetWait > fenceWait && packetWait > renderWork)
+	{
+		bound = "update thread";
+	}
+	else if (fenceWait > renderWork)
+	{
+		bound = "GPU";
+	}
+
+	out << " | bound by " << bound;
+
+	mTotals.fill(0.0);
+	mFrameCount = 0;
+	mIntervalStart = Clock::now();
+
+	return out.str();
+}
+
+char const *FrameStageTimings::getStageName(FrameStage stage)
+{
+	switch (stage)
+	{
+	case FrameStage::Update:		return "update";
+	case FrameStage::PacketWait:	return "packet-wait";
+	case FrameStage::FenceWait:		return "fence-wait";
+	case FrameStage::Acquire:		return "acquire";
+	case FrameStage::Record:		return "record";
+	case FrameStage::Submit:		return "submit";
+	case FrameStage::Present:		return "present";
+	default:						return "unknown";
+	}
+}
\ No newline at end of file
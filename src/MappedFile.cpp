@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::string const &fileName)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("[ERROR] Failed to open file " + fileName + "!");
+	}
+	mFileHandle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		unmap();
+		throw std::runtime_error("[ERROR] Failed to get the size of file " + fileName + "!");
+	}
+	mSize = static_cast<size_t>(size.QuadPart);
+
+	// Empty files can't be mapped, and have nothing to map anyway
+	if (mSize == 0)
+	{
+		return;
+	}
+
+	mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMappingHandle == nullptr)
+	{
+		unmap();
+		throw std::runtime_error("[ERROR] Failed to map file " + fileName + "!");
+	}
+
+	mpData = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mpData == nullptr)
+	{
+		unmap();
+		throw std::runtime_error("[ERROR] Failed to map file " + fileName + "!");
+	}
+#else
+	int file = open(fileName.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		throw std::runtime_error("[ERROR] Failed to open file " + fileName + "!");
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw std::runtime_error("[ERROR] Failed to get the size of file " + fileName + "!");
+	}
+	mSize = static_cast<size_t>(status.st_size);
+
+	// Empty files can't be mapped, and have nothing to map anyway
+	if (mSize > 0)
+	{
+		void *pData = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+		if (pData == MAP_FAILED)
+		{
+			close(file);
+			throw std::runtime_error("[ERROR] Failed to map file " + fileName + "!");
+		}
+		mpData = pData;
+	}
+
+	// The mapping keeps its own reference to the file
+	close(file);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+
+		std::swap(mpData, other.mpData);
+		std::swap(mSize, other.mSize);
+#ifdef _WIN32
+		std::swap(mFileHandle, other.mFileHandle);
+		std::swap(mMappingHandle, other.mMappingHandle);
+#endif
+	}
+
+	return *this;
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+	if (mpData != nullptr)
+	{
+		UnmapViewOfFile(mpData);
+	}
+	if (mMappingHandle != nullptr)
+	{
+		CloseHandle(mMappingHandle);
+	}
+	if (mFileHandle != nullptr)
+	{
+		CloseHandle(mFileHandle);
+	}
+	mFileHandle = nullptr;
+	mMappingHandle = nullptr;
+#else
+	if (mpData != nullptr)
+	{
+		munmap(mpData, mSize);
+	}
+#endif
+
+	mpData = nullptr;
+	mSize = 0;
+}
\ No newline at end of file
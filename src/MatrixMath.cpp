@@ -0,0 +1,86 @@
+#include "MatrixMath.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MATRIX_MATH_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MATRIX_MATH_SSE
+#endif
+
+/**
+ * glm matrices are column major, so column j of the product is the sum of the left matrix's columns, each
+ *  scaled by one element of the right matrix's column j. The left columns stay in registers for the whole
+ *  batch and each product costs four multiply-adds per column. glm's own operator* gets there too, but
+ *  only if it was configured with GLM_FORCE_INTRINSICS, and it reloads the left matrix every call.
+ *
+ * Loads and stores are unaligned as glm::mat4 is only guaranteed 4 byte alignment.
+ */
+void mathutils::multiplyMatrices(glm::mat4 const &left, glm::mat4 const *rights, glm::mat4 *results, size_t count)
+{
+	float const *pLeft = &left[0][0];
+
+#if defined(MATRIX_MATH_AVX)
+	// The left columns are duplicated into both lanes, so two result columns are computed at once
+	__m256 left0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pLeft + 0));
+	__m256 left1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pLeft + 4));
+	__m256 left2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pLeft + 8));
+	__m256 left3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(pLeft + 12));
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float const *pRight = &rights[i][0][0];
+		float *pResult = &results[i][0][0];
+
+		// Read the whole right matrix before writing, in case the result overwrites it
+		__m256 right01 = _mm256_loadu_ps(pRight);
+		__m256 right23 = _mm256_loadu_ps(pRight + 8);
+
+		__m256 result01 = _mm256_mul_ps(left0, _mm256_shuffle_ps(right01, right01, _MM_SHUFFLE(0, 0, 0, 0)));
+		result01 = _mm256_add_ps(result01, _mm256_mul_ps(left1, _mm256_shuffle_ps(right01, right01, _MM_SHUFFLE(1, 1, 1, 1))));
+		result01 = _mm256_add_ps(result01, _mm256_mul_ps(left2, _mm256_shuffle_ps(right01, right01, _MM_SHUFFLE(2, 2, 2, 2))));
+		result01 = _mm256_add_ps(result01, _mm256_mul_ps(left3, _mm256_shuffle_ps(right01, right01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		__m256 result23 = _mm256_mul_ps(left0, _mm256_shuffle_ps(right23, right23, _MM_SHUFFLE(0, 0, 0, 0)));
+		result23 = _mm256_add_ps(result23, _mm256_mul_ps(left1, _mm256_shuffle_ps(right23, right23, _MM_SHUFFLE(1, 1, 1, 1))));
+		result23 = _mm256_add_ps(result23, _mm256_mul_ps(left2, _mm256_shuffle_ps(right23, right23, _MM_SHUFFLE(2, 2, 2, 2))));
+		result23 = _mm256_add_ps(result23, _mm256_mul_ps(left3, _mm256_shuffle_ps(right23, right23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		_mm256_storeu_ps(pResult, result01);
+		_mm256_storeu_ps(pResult + 8, result23);
+	}
+#elif defined(MATRIX_MATH_SSE)
+	__m128 left0 = _mm_loadu_ps(pLeft + 0);
+	__m128 left1 = _mm_loadu_ps(pLeft + 4);
+	__m128 left2 = _mm_loadu_ps(pLeft + 8);
+	__m128 left3 = _mm_loadu_ps(pLeft + 12);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float const *pRight = &rights[i][0][0];
+		float *pResult = &results[i][0][0];
+
+		// Read the whole right matrix before writing, in case the result overwrites it
+		__m128 rightColumns[4] = {
+			_mm_loadu_ps(pRight + 0), _mm_loadu_ps(pRight + 4), _mm_loadu_ps(pRight + 8), _mm_loadu_ps(pRight + 12)
+		};
+
+		for (int column = 0; column < 4; ++column)
+		{
+			__m128 right = rightColumns[column];
+
+			__m128 result = _mm_mul_ps(left0, _mm_shuffle_ps(right, right, _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm_add_ps(result, _mm_mul_ps(left1, _mm_shuffle_ps(right, right, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(left2, _mm_shuffle_ps(right, right, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(left3, _mm_shuffle_ps(right, right, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			_mm_storeu_ps(pResult + 4 * column, result);
+		}
+	}
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		results[i] = left * rights[i];
+	}
+#endif
+}
\ No newline at end of file
@@ -1,21 +1,41 @@
 #include "Mesh.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
-void Mesh::lazyInit(std::string modelDir, VkPhysicalDevice physicalDevice, VkDevice logicalDevice)
+#include "CpuProfiler.h"
+#include "FlatHashMap.h"
+
+void Mesh::lazyInit(std::string modelDir, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, LodChainSettings const &lodSettings)
 {
 	mModelDir = modelDir;
 
 	loadModel();
+	computeBoundingSphere();
+
+	// Before the coarser levels are appended to the indices
+	mMeshlets = MeshletBuilder::build(mVertices, mIndices);
+	mLods = MeshSimplifier::buildLodChain(mVertices, mIndices, mBoundingRadius, lodSettings);
+	buildIndexData();
 	//createVertexBuffer();
 	//createIndexBuffer();
 }
 
 void Mesh::loadModel()
+{
+	PROFILE_SCOPE("Mesh::loadModel");
+
+	deduplicateVertices(readCornerVertices(mModelDir), mVertices, mIndices);
+}
+
+std::vector<Vertex> Mesh::readCornerVertices(std::string const &fileName)
 {
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
@@ -23,12 +43,19 @@ void Mesh::loadModel()
 	std::string warn, err;
 
 	// The whole thing fails if the mtl file is not found. Kinda weird!
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, mModelDir.c_str()));
+	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, fileName.c_str()));
 	{
 		//throw std::runtime_error(warn + err);
 	}
 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+	size_t cornerCount = 0;
+	for (const auto &shape : shapes)
+	{
+		cornerCount += shape.mesh.indices.size();
+	}
+
+	std::vector<Vertex> cornerVertices;
+	cornerVertices.reserve(cornerCount);
 
 	for (const auto &shape : shapes)
 	{
@@ -49,14 +76,149 @@ void Mesh::loadModel()
 
 			vertex.color = { 1.0f, 1.0f, 1.0f };
 
-			if (uniqueVertices.count(vertex) == 0)
+			cornerVertices.push_back(vertex);
+		}
+	}
+
+	return cornerVertices;
+}
+
+/**
+ * The map is sized for the worst case of every corner being unique, so it never rehashes. That costs
+ *  some memory on meshes with a lot of sharing, but the map only lives for the duration of the call.
+ */
+void Mesh::deduplicateVertices(std::vector<Vertex> const &cornerVertices, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+	FlatHashMap<Vertex, uint32_t> uniqueVertices;
+	uniqueVertices.reserve(cornerVertices.size());
+
+	indices.reserve(indices.size() + cornerVertices.size());
+
+	for (const Vertex &vertex : cornerVertices)
+	{
+		// The current size of the vertex buffer is the index of a new unique vertex
+		std::pair<uint32_t *, bool> result = uniqueVertices.tryEmplace(vertex, static_cast<uint32_t>(vertices.size()));
+		if (result.second)
+		{
+			vertices.push_back(vertex);
+		}
+
+		indices.push_back(*result.first);
+	}
+}
+
+/**
+ * Center the sphere on the bounding box, which is loose but cheap and good enough for
+ *  screen space size estimates.
+ */
+void Mesh::computeBoundingSphere()
+{
+	if (mVertices.empty())
+	{
+		return;
+	}
+
+	glm::vec3 minPosition = mVertices[0].position;
+	glm::vec3 maxPosition = mVertices[0].position;
+
+	for (const Vertex &vertex : mVertices)
+	{
+		minPosition = glm::min(minPosition, vertex.position);
+		maxPosition = glm::max(maxPosition, vertex.position);
+	}
+
+	mBoundingCenter = 0.5f * (minPosition + maxPosition);
+	mBoundingRadius = 0.0f;
+
+	for (const Vertex &vertex : mVertices)
+	{
+		mBoundingRadius = std::max(mBoundingRadius, glm::length(vertex.position - mBoundingCenter));
+	}
+}
+
+/**
+ * Each level is cut into sections whose vertices span at most 65536 indices, in index order, so that
+ *  their indices fit 16 bits relative to the section's lowest vertex. Meshes with fewer vertices get a
+ *  single section per level. Only when a single triangle spans too far does the mesh fall back to 32
+ *  bit indices.
+ */
+void Mesh::buildIndexData()
+{
+	constexpr uint32_t SIXTEEN_BIT_SPAN = 0x10000;
+
+	mLodSections.assign(mLods.size(), std::vector<MeshSection>());
+	bool fitsSixteenBits = true;
+
+	for (size_t lodIndex = 0; lodIndex < mLods.size() && fitsSixteenBits; ++lodIndex)
+	{
+		MeshLod const &lod = mLods[lodIndex];
+
+		MeshSection section;
+		section.firstIndex = lod.firstIndex;
+		uint32_t minVertex = UINT32_MAX, maxVertex = 0;
+
+		for (uint32_t i = lod.firstIndex; i < lod.firstIndex + lod.indexCount; i += 3)
+		{
+			uint32_t triangleMin = std::min({ mIndices[i], mIndices[i + 1], mIndices[i + 2] });
+			uint32_t triangleMax = std::max({ mIndices[i], mIndices[i + 1], mIndices[i + 2] });
+
+			if (triangleMax - triangleMin >= SIXTEEN_BIT_SPAN)
 			{
-				// The currente size of the vertex buffer is the current index of an unique vertex
-				uniqueVertices[vertex] = static_cast<uint32_t>(mVertices.size());
-				mVertices.push_back(vertex);
+				fitsSixteenBits = false;
+				break;
+			}
+
+			if (section.indexCount > 0 && std::max(maxVertex, triangleMax) - std::min(minVertex, triangleMin) >= SIXTEEN_BIT_SPAN)
+			{
+				section.vertexOffset = static_cast<int32_t>(minVertex);
+				mLodSections[lodIndex].push_back(section);
+
+				section.firstIndex = i;
+				section.indexCount = 0;
+				minVertex = UINT32_MAX;
+				maxVertex = 0;
 			}
 
-			mIndices.push_back(uniqueVertices[vertex]);
+			minVertex = std::min(minVertex, triangleMin);
+			maxVertex = std::max(maxVertex, triangleMax);
+			section.indexCount += 3;
+		}
+
+		if (section.indexCount > 0)
+		{
+			section.vertexOffset = static_cast<int32_t>(minVertex);
+			mLodSections[lodIndex].push_back(section);
+		}
+	}
+
+	if (!fitsSixteenBits)
+	{
+		mIndexType = VK_INDEX_TYPE_UINT32;
+		mIndexData.resize(mIndices.size() * sizeof(uint32_t));
+		std::memcpy(mIndexData.data(), mIndices.data(), mIndexData.size());
+
+		for (size_t lodIndex = 0; lodIndex < mLods.size(); ++lodIndex)
+		{
+			MeshSection section;
+			section.firstIndex = mLods[lodIndex].firstIndex;
+			section.indexCount = mLods[lodIndex].indexCount;
+			mLodSections[lodIndex].assign(1, section);
+		}
+		return;
+	}
+
+	mIndexType = VK_INDEX_TYPE_UINT16;
+	mIndexData.resize(mIndices.size() * sizeof(uint16_t));
+	uint16_t *pIndices = reinterpret_cast<uint16_t *>(mIndexData.data());
+
+	for (std::vector<MeshSection> const &sections : mLodSections)
+	{
+		for (MeshSection const &section : sections)
+		{
+			for (uint32_t i = section.firstIndex; i < section.firstIndex + section.indexCount; ++i)
+			{
+				pIndices[i] = static_cast<uint16_t>(mIndices[i] - static_cast<uint32_t>(section.vertexOffset));
+			}
 		}
 	}
 }
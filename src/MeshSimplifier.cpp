@@ -0,0 +1,492 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <glm/geometric.hpp>
+
+#include "CpuProfiler.h"
+#include "FlatHashMap.h"
+#include "HashUtils.h"
+
+namespace
+{
+	/**
+	 * Sum of squared distances to a set of planes, as p^T A p + 2 b.p + c with A symmetric. Doubles,
+	 *  since the terms of large, nearly flat meshes cancel out. The planes are weighted by area, whose
+	 *  total is kept so the sum can be turned back into a squared distance.
+	 */
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double area = 0.0;
+
+		// The plane through the triangle, weighted by its area so small triangles don't dominate
+		static Quadric fromTriangle(glm::vec3 const &p0, glm::vec3 const &p1, glm::vec3 const &p2)
+		{
+			Quadric quadric;
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			double doubleArea = glm::length(normal);
+			if (doubleArea <= 0.0)
+			{
+				return quadric;
+			}
+
+			double nx = normal.x / doubleArea, ny = normal.y / doubleArea, nz = normal.z / doubleArea;
+			double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+			double weight = 0.5 * doubleArea;
+
+			quadric.a00 = weight * nx * nx; quadric.a01 = weight * nx * ny; quadric.a02 = weight * nx * nz;
+			quadric.a11 = weight * ny * ny; quadric.a12 = weight * ny * nz; quadric.a22 = weight * nz * nz;
+			quadric.b0 = weight * nx * d; quadric.b1 = weight * ny * d; quadric.b2 = weight * nz * d;
+			quadric.c = weight * d * d;
+			quadric.area = weight;
+
+			return quadric;
+		}
+
+		Quadric &operator+=(Quadric const &other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			area += other.area;
+			return *this;
+		}
+
+		double evaluate(glm::vec3 const &p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			double result = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z)
+				+ c;
+
+			// Rounding can take it slightly below zero
+			return std::max(result, 0.0);
+		}
+
+		// The area weighted mean of the squared distances, in squared model space units like the error limit
+		double evaluateSquaredDistance(glm::vec3 const &p) const
+		{
+			return area > 0.0 ? evaluate(p) / area : 0.0;
+		}
+	};
+
+	struct PositionHash
+	{
+		size_t operator()(glm::vec3 const &position) const
+		{
+			uint32_t const words[3] = {
+				hashutils::floatBits(position.x), hashutils::floatBits(position.y), hashutils::floatBits(position.z)
+			};
+			return static_cast<size_t>(hashutils::hashWords(words, 3));
+		}
+	};
+
+	struct EdgeHash
+	{
+		size_t operator()(uint64_t edge) const
+		{
+			uint32_t const words[2] = { static_cast<uint32_t>(edge), static_cast<uint32_t>(edge >> 32) };
+			return static_cast<size_t>(hashutils::hashWords(words, 2));
+		}
+	};
+
+	uint64_t getEdgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	float getAttributeDistance(Vertex const &a, Vertex const &b)
+	{
+		glm::vec2 texCoord = a.texCoord - b.texCoord;
+		glm::vec3 color = a.color - b.color;
+		return glm::dot(texCoord, texCoord) + glm::dot(color, color);
+	}
+}
+
+/**
+ * Greedy edge collapse in passes: each pass finds the cheapest collapse of every unlocked vertex,
+ *  sorts them and applies them cheapest first, skipping any that touch a vertex already changed in the
+ *  same pass since its cost is out of date. A collapse is also rejected when it would flip a triangle.
+ */
+std::vector<uint32_t> MeshSimplifier::simplify(std::vector<Vertex> const &vertices, std::vector<uint32_t> const &indices,
+	size_t targetIndexCount, float maxError, float *resultError)
+{
+	PROFILE_SCOPE("MeshSimplifier::simplify");
+
+	if (indices.size() % 3 != 0)
+	{
+		throw std::runtime_error("[ERROR] Simplification needs a triangle list!");
+	}
+
+	size_t triangleCount = indices.size() / 3;
+	size_t targetTriangleCount = targetIndexCount / 3;
+
+	if (resultError)
+	{
+		*resultError = 0.0f;
+	}
+
+	if (triangleCount <= targetTriangleCount)
+	{
+		return indices;
+	}
+
+	// Weld vertices that only differ in attributes
+	std::vector<uint32_t> welded(vertices.size());
+	std::vector<glm::vec3> positions;
+	{
+		FlatHashMap<glm::vec3, uint32_t, PositionHash> weldedIndices;
+		weldedIndices.reserve(vertices.size());
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			std::pair<uint32_t *, bool> result = weldedIndices.tryEmplace(vertices[i].position, static_cast<uint32_t>(positions.size()));
+			if (result.second)
+			{
+				positions.push_back(vertices[i].position);
+			}
+			welded[i] = *result.first;
+		}
+	}
+
+	size_t weldedCount = positions.size();
+
+	// The original vertices of each welded vertex, as ranges of one array
+	std::vector<uint32_t> copyOffsets(weldedCount + 1, 0);
+	std::vector<uint32_t> copies(vertices.size());
+	for (uint32_t weldedIndex : welded)
+	{
+		++copyOffsets[weldedIndex + 1];
+	}
+	for (size_t i = 0; i < weldedCount; ++i)
+	{
+		copyOffsets[i + 1] += copyOffsets[i];
+	}
+	{
+		std::vector<uint32_t> fill(copyOffsets.begin(), copyOffsets.end() - 1);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(vertices.size()); ++i)
+		{
+			copies[fill[welded[i]]++] = i;
+		}
+	}
+
+	// Triangles over welded vertices, with their quadrics and adjacency
+	std::vector<uint32_t> corners(indices.size());
+	std::vector<bool> isTriangleAlive(triangleCount, true);
+	std::vector<Quadric> quadrics(weldedCount);
+	std::vector<std::vector<uint32_t>> adjacency(weldedCount);
+	FlatHashMap<uint64_t, uint32_t, EdgeHash> edgeUses;
+	edgeUses.reserve(indices.size());
+
+	size_t aliveCount = 0;
+
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		for (size_t k = 0; k < 3; ++k)
+		{
+			if (indices[3 * t + k] >= vertices.size())
+			{
+				throw std::runtime_error("[ERROR] Simplification index out of range!");
+			}
+			corners[3 * t + k] = welded[indices[3 * t + k]];
+		}
+
+		uint32_t const *triangle = &corners[3 * t];
+		if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+		{
+			isTriangleAlive[t] = false;
+			continue;
+		}
+
+		++aliveCount;
+
+		Quadric quadric = Quadric::fromTriangle(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+		for (size_t k = 0; k < 3; ++k)
+		{
+			quadrics[triangle[k]] += quadric;
+			adjacency[triangle[k]].push_back(static_cast<uint32_t>(t));
+			++*edgeUses.tryEmplace(getEdgeKey(triangle[k], triangle[(k + 1) % 3]), 0).first;
+		}
+	}
+
+	// Edges with one triangle are open borders, with more than two they are non-manifold. Either way, keep them.
+	std::vector<bool> isLocked(weldedCount, false);
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		if (!isTriangleAlive[t])
+		{
+			continue;
+		}
+
+		for (size_t k = 0; k < 3; ++k)
+		{
+			uint32_t a = corners[3 * t + k], b = corners[3 * t + (k + 1) % 3];
+			if (*edgeUses.find(getEdgeKey(a, b)) != 2)
+			{
+				isLocked[a] = true;
+				isLocked[b] = true;
+			}
+		}
+	}
+
+	std::vector<uint32_t> remap(vertices.size());
+	for (uint32_t i = 0; i < static_cast<uint32_t>(remap.size()); ++i)
+	{
+		remap[i] = i;
+	}
+
+	std::vector<bool> isCollapsed(weldedCount, false);
+	// Costs are squared distances, see Quadric::evaluateSquaredDistance
+	double maxCost = static_cast<double>(maxError) * maxError;
+	double largestCost = 0.0;
+
+	// Moving from onto to must not turn any of from's remaining triangles over
+	auto isFlipping = [&](uint32_t from, uint32_t to) {
+		for (uint32_t t : adjacency[from])
+		{
+			uint32_t const *triangle = &corners[3 * t];
+			if (!isTriangleAlive[t] || triangle[0] == to || triangle[1] == to || triangle[2] == to)
+			{
+				continue;
+			}
+
+			glm::vec3 p[3], moved[3];
+			for (size_t k = 0; k < 3; ++k)
+			{
+				p[k] = positions[triangle[k]];
+				moved[k] = triangle[k] == from ? positions[to] : p[k];
+			}
+
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+
+			if (glm::dot(before, after) <= 0.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	std::vector<Collapse> collapses;
+	std::vector<bool> isTouched(weldedCount);
+
+	while (aliveCount > targetTriangleCount)
+	{
+		// The cheapest collapse of each vertex
+		std::vector<Collapse> best(weldedCount, Collapse{ 0, 0, -1.0 });
+
+		for (size_t t = 0; t < triangleCount; ++t)
+		{
+			if (!isTriangleAlive[t])
+			{
+				continue;
+			}
+
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32_t a = corners[3 * t + k], b = corners[3 * t + (k + 1) % 3];
+
+				for (int direction = 0; direction < 2; ++direction, std::swap(a, b))
+				{
+					if (isLocked[a])
+					{
+						continue;
+					}
+
+					Quadric combined = quadrics[a];
+					combined += quadrics[b];
+					double cost = combined.evaluateSquaredDistance(positions[b]);
+
+					if (best[a].cost < 0.0 || cost < best[a].cost)
+					{
+						best[a] = Collapse{ a, b, cost };
+					}
+				}
+			}
+		}
+
+		collapses.clear();
+		for (Collapse const &collapse : best)
+		{
+			if (collapse.cost >= 0.0 && collapse.cost <= maxCost)
+			{
+				collapses.push_back(collapse);
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](Collapse const &a, Collapse const &b) {
+			return a.cost < b.cost;
+		});
+
+		std::fill(isTouched.begin(), isTouched.end(), false);
+		size_t collapseCount = 0;
+
+		for (Collapse const &collapse : collapses)
+		{
+			if (aliveCount <= targetTriangleCount)
+			{
+				break;
+			}
+
+			uint32_t from = collapse.from, to = collapse.to;
+			if (isTouched[from] || isTouched[to] || isFlipping(from, to))
+			{
+				continue;
+			}
+
+			isTouched[from] = true;
+			isTouched[to] = true;
+			isCollapsed[from] = true;
+			quadrics[to] += quadrics[from];
+			largestCost = std::max(largestCost, collapse.cost);
+			++collapseCount;
+
+			for (uint32_t t : adjacency[from])
+			{
+				if (!isTriangleAlive[t])
+				{
+					continue;
+				}
+
+				uint32_t *triangle = &corners[3 * t];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					isTriangleAlive[t] = false;
+					--aliveCount;
+					continue;
+				}
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					triangle[k] = triangle[k] == from ? to : triangle[k];
+				}
+				adjacency[to].push_back(t);
+			}
+			adjacency[from].clear();
+
+			// Each copy of the vertex moves to the copy of the target that looks most like it
+			for (uint32_t i = copyOffsets[from]; i < copyOffsets[from + 1]; ++i)
+			{
+				uint32_t copy = copies[i];
+				uint32_t closest = copies[copyOffsets[to]];
+
+				for (uint32_t j = copyOffsets[to]; j < copyOffsets[to + 1]; ++j)
+				{
+					if (getAttributeDistance(vertices[copy], vertices[copies[j]]) < getAttributeDistance(vertices[copy], vertices[closest]))
+					{
+						closest = copies[j];
+					}
+				}
+
+				remap[copy] = closest;
+			}
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(3 * aliveCount);
+
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		if (!isTriangleAlive[t])
+		{
+			continue;
+		}
+
+		for (size_t k = 0; k < 3; ++k)
+		{
+			uint32_t vertexIndex = indices[3 * t + k];
+			while (remap[vertexIndex] != vertexIndex)
+			{
+				vertexIndex = remap[vertexIndex];
+			}
+			result.push_back(vertexIndex);
+		}
+	}
+
+	if (resultError)
+	{
+		*resultError = static_cast<float>(std::sqrt(largestCost));
+	}
+
+	return result;
+}
+
+/**
+ * Each level is simplified from the previous one, which is faster than starting from the full mesh
+ *  every time. The errors are summed along the chain so they stay conservative against level 0.
+ */
+std::vector<MeshLod> MeshSimplifier::buildLodChain(std::vector<Vertex> const &vertices, std::vector<uint32_t> &indices,
+	float boundingRadius, LodChainSettings const &settings)
+{
+	PROFILE_SCOPE("MeshSimplifier::buildLodChain");
+
+	std::vector<MeshLod> lods;
+
+	MeshLod full;
+	full.indexCount = static_cast<uint32_t>(indices.size());
+	lods.push_back(full);
+
+	float maxError = settings.maxRelativeError * std::max(boundingRadius, 1e-6f);
+	std::vector<uint32_t> previous = indices;
+
+	while (lods.size() < settings.maxLodCount && lods.back().error < maxError)
+	{
+		size_t targetIndexCount = static_cast<size_t>(previous.size() / 3 * settings.triangleRatio) * 3;
+
+		float error = 0.0f;
+		std::vector<uint32_t> simplified = simplify(vertices, previous, targetIndexCount, maxError - lods.back().error, &error);
+
+		// Not worth a level of its own if the error budget stopped it early
+		if (simplified.empty() || simplified.size() > previous.size() * 9 / 10)
+		{
+			break;
+		}
+
+		MeshLod lod;
+		lod.firstIndex = static_cast<uint32_t>(indices.size());
+		lod.indexCount = static_cast<uint32_t>(simplified.size());
+		lod.error = lods.back().error + error;
+		lods.push_back(lod);
+
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		previous = std::move(simplified);
+	}
+
+	return lods;
+}
+
+uint32_t MeshSimplifier::selectLod(std::vector<MeshLod> const &lods, float pixelsPerUnit, float maxPixelError)
+{
+	for (size_t i = lods.size(); i > 1; --i)
+	{
+		if (lods[i - 1].error * pixelsPerUnit <= maxPixelError)
+		{
+			return static_cast<uint32_t>(i - 1);
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
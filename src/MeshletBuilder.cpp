@@ -0,0 +1,268 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include "CpuProfiler.h"
+
+MeshletData MeshletBuilder::build(std::vector<Vertex> const &vertices, std::vector<uint32_t> const &indices,
+	uint32_t maxVertices, uint32_t maxTriangles)
+{
+	PROFILE_SCOPE("MeshletBuilder::build");
+
+	if (maxVertices < 3 || maxVertices > 256 || maxTriangles < 1)
+	{
+		throw std::runtime_error("[ERROR] Meshlet limits must allow a triangle and fit local indices in a byte!");
+	}
+
+	if (indices.size() % 3 != 0)
+	{
+		throw std::runtime_error("[ERROR] Meshlets need a triangle list!");
+	}
+
+	MeshletData data;
+
+	// Upper bounds, the real counts are usually within a few percent for connected meshes
+	size_t triangleCount = indices.size() / 3;
+	data.meshlets.reserve(triangleCount / maxTriangles + 1);
+	data.vertexIndices.reserve(std::min(indices.size(), vertices.size() * 2));
+	data.triangleIndices.reserve(indices.size());
+
+	// Local index of each mesh vertex in the meshlet being built, or NOT_IN_MESHLET. Local indices go up to 255,
+	//  so the marker needs a wider type than they are stored in.
+	uint16_t const NOT_IN_MESHLET = 0xffff;
+	std::vector<uint16_t> localIndices(vertices.size(), NOT_IN_MESHLET);
+
+	Meshlet meshlet{};
+
+	auto closeMeshlet = [&]() {
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			localIndices[data.vertexIndices[meshlet.vertexOffset + i]] = NOT_IN_MESHLET;
+		}
+
+		data.meshlets.push_back(meshlet);
+
+		meshlet.vertexOffset = static_cast<uint32_t>(data.vertexIndices.size());
+		meshlet.triangleOffset = static_cast<uint32_t>(data.triangleIndices.size());
+		meshlet.vertexCount = 0;
+		meshlet.triangleCount = 0;
+	};
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		uint32_t newVertices = 0;
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			if (indices[i + corner] >= vertices.size())
+			{
+				throw std::runtime_error("[ERROR] Meshlet index out of range!");
+			}
+
+			// A triangle can repeat a vertex, count it once
+			bool isRepeated = (corner > 0 && indices[i + corner] == indices[i])
+				|| (corner > 1 && indices[i + corner] == indices[i + 1]);
+			newVertices += localIndices[indices[i + corner]] == NOT_IN_MESHLET && !isRepeated ? 1 : 0;
+		}
+
+		if (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+		{
+			closeMeshlet();
+		}
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			uint32_t vertexIndex = indices[i + corner];
+
+			if (localIndices[vertexIndex] == NOT_IN_MESHLET)
+			{
+				localIndices[vertexIndex] = static_cast<uint16_t>(meshlet.vertexCount++);
+				data.vertexIndices.push_back(vertexIndex);
+			}
+
+			data.triangleIndices.push_back(static_cast<uint8_t>(localIndices[vertexIndex]));
+		}
+
+		++meshlet.triangleCount;
+	}
+
+	if (meshlet.triangleCount > 0)
+	{
+		closeMeshlet();
+	}
+
+	data.bounds.reserve(data.meshlets.size());
+	for (Meshlet const &built : data.meshlets)
+	{
+		data.bounds.push_back(computeBounds(data, built, vertices));
+	}
+
+	return data;
+}
+
+/**
+ * The sphere is centered on the bounding box like Mesh::computeBoundingSphere. The cone axis is the
+ *  average triangle normal; when every normal is within the angle t of it, the cluster is backfacing
+ *  for view directions within 90 - t degrees of the axis, so the cutoff is cos(90 - t) = sin(t).
+ */
+MeshletBounds MeshletBuilder::computeBounds(MeshletData const &data, Meshlet const &meshlet, std::vector<Vertex> const &vertices)
+{
+	MeshletBounds bounds{};
+
+	glm::vec3 const &first = vertices[data.vertexIndices[meshlet.vertexOffset]].position;
+	glm::vec3 minPosition = first;
+	glm::vec3 maxPosition = first;
+
+	for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+	{
+		glm::vec3 const &position = vertices[data.vertexIndices[meshlet.vertexOffset + i]].position;
+		minPosition = glm::min(minPosition, position);
+		maxPosition = glm::max(maxPosition, position);
+	}
+
+	bounds.center = 0.5f * (minPosition + maxPosition);
+	for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+	{
+		glm::vec3 const &position = vertices[data.vertexIndices[meshlet.vertexOffset + i]].position;
+		bounds.radius = std::max(bounds.radius, glm::length(position - bounds.center));
+	}
+
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+
+	for (uint32_t i = 0; i < meshlet.triangleCount; ++i)
+	{
+		uint8_t const *triangle = &data.triangleIndices[meshlet.triangleOffset + 3 * i];
+		glm::vec3 const &a = vertices[data.vertexIndices[meshlet.vertexOffset + triangle[0]]].position;
+		glm::vec3 const &b = vertices[data.vertexIndices[meshlet.vertexOffset + triangle[1]]].position;
+		glm::vec3 const &c = vertices[data.vertexIndices[meshlet.vertexOffset + triangle[2]]].position;
+
+		// Counter clockwise front faces, matching the pipeline's front face setting
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float length = glm::length(normal);
+
+		// Degenerate triangles are never rasterized, so they can't constrain the cone
+		if (length > 0.0f)
+		{
+			normals.push_back(normal / length);
+		}
+	}
+
+	glm::vec3 axis(0.0f);
+	for (glm::vec3 const &normal : normals)
+	{
+		axis += normal;
+	}
+
+	float axisLength = glm::length(axis);
+	bounds.coneCutoff = 1.0f;
+
+	if (axisLength <= 0.0f)
+	{
+		return bounds;
+	}
+
+	bounds.coneAxis = axis / axisLength;
+
+	float minDot = 1.0f;
+	for (glm::vec3 const &normal : normals)
+	{
+		minDot = std::min(minDot, glm::dot(normal, bounds.coneAxis));
+	}
+
+	if (minDot > 0.0f)
+	{
+		bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	return bounds;
+}
+
+/**
+ * The apex of the view direction is taken anywhere in the bounding sphere, hence the radius term. A
+ *  cutoff of 1 fails the test for any camera outside the sphere, and inside it nothing is culled anyway.
+ */
+bool MeshletBuilder::isBackfacing(MeshletBounds const &bounds, glm::vec3 const &cameraPosition)
+{
+	glm::vec3 toCenter = bounds.center - cameraPosition;
+
+	return glm::dot(toCenter, bounds.coneAxis) >= bounds.coneCutoff * glm::length(toCenter) + bounds.radius;
+}
+
+std::string MeshletBuilder::validate(MeshletData const &data, std::vector<Vertex> const &vertices, std::vector<uint32_t> const &indices,
+	uint32_t maxVertices, uint32_t maxTriangles)
+{
+	if (data.bounds.size() != data.meshlets.size())
+	{
+		return "bounds count " + std::to_string(data.bounds.size()) + " != meshlet count " + std::to_string(data.meshlets.size());
+	}
+
+	size_t nextIndex = 0;
+
+	for (size_t m = 0; m < data.meshlets.size(); ++m)
+	{
+		Meshlet const &meshlet = data.meshlets[m];
+		MeshletBounds const &bounds = data.bounds[m];
+		std::string name = "meshlet " + std::to_string(m) + ": ";
+
+		if (meshlet.vertexCount == 0 || meshlet.vertexCount > maxVertices
+			|| meshlet.triangleCount == 0 || meshlet.triangleCount > maxTriangles)
+		{
+			return name + "counts out of limits";
+		}
+
+		if (static_cast<size_t>(meshlet.vertexOffset) + meshlet.vertexCount > data.vertexIndices.size()
+			|| static_cast<size_t>(meshlet.triangleOffset) + 3 * meshlet.triangleCount > data.triangleIndices.size())
+		{
+			return name + "ranges out of bounds";
+		}
+
+		// Loose tolerance, the radius and the distances are computed with the same float math
+		float tolerance = 1e-4f * std::max(1.0f, bounds.radius);
+
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			uint32_t vertexIndex = data.vertexIndices[meshlet.vertexOffset + i];
+			if (vertexIndex >= vertices.size())
+			{
+				return name + "vertex index out of range";
+			}
+
+			if (glm::length(vertices[vertexIndex].position - bounds.center) > bounds.radius + tolerance)
+			{
+				return name + "vertex outside the bounding sphere";
+			}
+		}
+
+		for (uint32_t i = 0; i < 3 * meshlet.triangleCount; ++i)
+		{
+			uint8_t localIndex = data.triangleIndices[meshlet.triangleOffset + i];
+			if (localIndex >= meshlet.vertexCount)
+			{
+				return name + "local index out of range";
+			}
+
+			if (nextIndex >= indices.size() || data.vertexIndices[meshlet.vertexOffset + localIndex] != indices[nextIndex])
+			{
+				return name + "triangles do not match the index list at index " + std::to_string(nextIndex);
+			}
+			++nextIndex;
+		}
+
+		if (bounds.coneCutoff < 0.0f || bounds.coneCutoff > 1.0f)
+		{
+			return name + "cone cutoff out of range";
+		}
+	}
+
+	if (nextIndex != indices.size())
+	{
+		return "meshlets cover " + std::to_string(nextIndex) + " of " + std::to_string(indices.size()) + " indices";
+	}
+
+	return std::string();
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void RangeAllocator::reset(uint64_t capacity)
+{
+	mFreeRanges.clear();
+	mCapacity = capacity;
+	mUsedSize = 0;
+
+	if (capacity > 0)
+	{
+		mFreeRanges.emplace(0, capacity);
+	}
+}
+
+uint64_t RangeAllocator::allocate(uint64_t size)
+{
+	if (size == 0)
+	{
+		return INVALID_OFFSET;
+	}
+
+	for (auto range = mFreeRanges.begin(); range != mFreeRanges.end(); ++range)
+	{
+		if (range->second < size)
+		{
+			continue;
+		}
+
+		uint64_t offset = range->first;
+		uint64_t remaining = range->second - size;
+		mFreeRanges.erase(range);
+
+		if (remaining > 0)
+		{
+			mFreeRanges.emplace(offset + size, remaining);
+		}
+
+		mUsedSize += size;
+		return offset;
+	}
+
+	return INVALID_OFFSET;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	if (offset + size > mCapacity || size > mUsedSize)
+	{
+		throw std::runtime_error("[ERROR] Freeing a range that was never allocated!");
+	}
+
+	mUsedSize -= size;
+
+	auto next = mFreeRanges.lower_bound(offset);
+
+	// Merge with the free range right after
+	if (next != mFreeRanges.end() && next->first == offset + size)
+	{
+		size += next->second;
+		next = mFreeRanges.erase(next);
+	}
+
+	// And with the one right before
+	if (next != mFreeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += size;
+			return;
+		}
+	}
+
+	mFreeRanges.emplace(offset, size);
+}
+
+uint64_t RangeAllocator::getLargestFreeRange() const
+{
+	uint64_t largest = 0;
+	for (std::pair<uint64_t const, uint64_t> const &range : mFreeRanges)
+	{
+		largest = std::max(largest, range.second);
+	}
+	return largest;
+}
\ No newline at end of file
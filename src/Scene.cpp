@@ -0,0 +1,101 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+
+uint32_t Scene::addNode(uint32_t parent, glm::mat4 const &localTransform)
+{
+	if (parent != NO_PARENT && parent >= getNodeCount())
+	{
+		throw std::runtime_error("[ERROR] Scene node parent does not exist!");
+	}
+
+	uint32_t node = getNodeCount();
+
+	mParents.push_back(parent);
+	mLocalTransforms.push_back(localTransform);
+	mWorldTransforms.push_back(localTransform);
+	mMeshIndices.push_back(NO_MESH);
+	mMaterialIndices.push_back(0);
+	mTextureHandles.push_back(0);
+
+	mLocalDirty.push_back(1);
+	mWorldChanged.push_back(0);
+	mAnyDirty = true;
+
+	return node;
+}
+
+void Scene::setLocalTransform(uint32_t node, glm::mat4 const &localTransform)
+{
+	mLocalTransforms[node] = localTransform;
+	mLocalDirty[node] = 1;
+	mAnyDirty = true;
+}
+
+void Scene::setMesh(uint32_t node, uint32_t meshIndex)
+{
+	mMeshIndices[node] = meshIndex;
+}
+
+void Scene::setMaterial(uint32_t node, uint32_t materialIndex, uint32_t textureHandle)
+{
+	mMaterialIndices[node] = materialIndex;
+	mTextureHandles[node] = textureHandle;
+}
+
+/**
+ * A node needs a new world matrix if its own transform changed or its parent's world matrix did. As
+ *  parents come first, the parent's flag is final by the time the child is visited.
+ */
+uint32_t Scene::updateWorldTransforms()
+{
+	PROFILE_SCOPE("Scene::updateWorldTransforms");
+
+	std::fill(mWorldChanged.begin(), mWorldChanged.end(), 0);
+
+	if (!mAnyDirty)
+	{
+		return 0;
+	}
+
+	uint32_t updatedCount = 0;
+
+	for (uint32_t node = 0; node < getNodeCount(); ++node)
+	{
+		uint32_t parent = mParents[node];
+		bool isParentChanged = parent != NO_PARENT && mWorldChanged[parent];
+
+		if (!mLocalDirty[node] && !isParentChanged)
+		{
+			continue;
+		}
+
+		mWorldTransforms[node] = parent == NO_PARENT
+			? mLocalTransforms[node]
+			: mWorldTransforms[parent] * mLocalTransforms[node];
+
+		mLocalDirty[node] = 0;
+		mWorldChanged[node] = 1;
+		++updatedCount;
+	}
+
+	mAnyDirty = false;
+
+	return updatedCount;
+}
+
+void Scene::clear()
+{
+	mParents.clear();
+	mLocalTransforms.clear();
+	mWorldTransforms.clear();
+	mMeshIndices.clear();
+	mMaterialIndices.clear();
+	mTextureHandles.clear();
+	mLocalDirty.clear();
+	mWorldChanged.clear();
+	mAnyDirty = false;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "ShaderCompiler.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// Set by the build when it found a compiler, see utils.cmake
+#ifndef VULKAN_RENDERER_GLSL_COMPILER
+#define VULKAN_RENDERER_GLSL_COMPILER "glslc"
+#endif
+
+namespace
+{
+	std::string quote(std::string const &argument)
+	{
+		return "\"" + argument + "\"";
+	}
+}
+
+std::string shadercompiler::getCompilerPath()
+{
+	char const *compiler = std::getenv("VULKAN_RENDERER_GLSL_COMPILER");
+
+	return compiler && *compiler ? compiler : VULKAN_RENDERER_GLSL_COMPILER;
+}
+
+/**
+ * The compiler runs as a child process, glslc and glslangValidator take the same arguments except that
+ *  glslangValidator has to be asked for SPIR-V for Vulkan. The child's stderr is merged into the log.
+ */
+bool shadercompiler::compileGlsl(std::string const &sourceFile, std::string const &outputFile, std::string &log)
+{
+	std::string compiler = getCompilerPath();
+
+	std::string command = quote(compiler);
+	if (compiler.find("glslangValidator") != std::string::npos)
+	{
+		command += " -V";
+	}
+	command += " " + quote(sourceFile) + " -o " + quote(outputFile) + " 2>&1";
+
+#ifdef _WIN32
+	// cmd.exe strips the outer quotes of a command that starts with one
+	command = quote(command);
+#endif
+
+	FILE *pipe = popen(command.c_str(), "r");
+	if (!pipe)
+	{
+		log += "[ERROR] Failed to run " + compiler + "!\n";
+		return false;
+	}
+
+	char buffer[512];
+	size_t length = 0;
+	while ((length = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+	{
+		log.append(buffer, length);
+	}
+
+	return pclose(pipe) == 0;
+}
\ No newline at end of file
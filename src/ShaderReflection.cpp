@@ -0,0 +1,644 @@
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	// The few parts of the SPIR-V specification reflection needs
+	constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+	constexpr size_t SPIRV_HEADER_WORDS = 5;
+
+	enum Op : uint32_t
+	{
+		OpEntryPoint = 15,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpSpecConstant = 50,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+	};
+
+	enum Decoration : uint32_t
+	{
+		DecorationSpecId = 1,
+		DecorationBlock = 2,
+		DecorationBufferBlock = 3,
+		DecorationArrayStride = 6,
+		DecorationMatrixStride = 7,
+		DecorationBuiltIn = 11,
+		DecorationLocation = 30,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset = 35,
+	};
+
+	enum StorageClass : uint32_t
+	{
+		StorageClassUniformConstant = 0,
+		StorageClassInput = 1,
+		StorageClassUniform = 2,
+		StorageClassPushConstant = 9,
+		StorageClassStorageBuffer = 12,
+	};
+
+	constexpr uint32_t DIM_BUFFER = 5;
+	constexpr uint32_t DIM_SUBPASS_DATA = 6;
+	constexpr uint32_t NOT_SET = UINT32_MAX;
+
+	struct Type
+	{
+		uint32_t op = 0;
+		std::vector<uint32_t> operands; // The instruction's words after the result id
+	};
+
+	struct Decorations
+	{
+		uint32_t set = NOT_SET, binding = NOT_SET, location = NOT_SET, specId = NOT_SET;
+		uint32_t arrayStride = 0;
+		bool block = false, bufferBlock = false, builtIn = false;
+	};
+
+	struct MemberDecorations
+	{
+		uint32_t offset = 0, matrixStride = 0;
+	};
+
+	struct Variable
+	{
+		uint32_t id, pointerType, storageClass;
+	};
+
+	/**
+	 * Everything reflection looks at, indexed by result id. SPIR-V declares types, constants and global
+	 *  variables before any function body, and reflection never needs more than that.
+	 */
+	struct Module
+	{
+		VkShaderStageFlags stage = 0;
+		std::unordered_map<uint32_t, Type> types;
+		std::unordered_map<uint32_t, uint32_t> constants; // Value of 32 bit integer constants, spec constants at their default
+		std::unordered_map<uint32_t, Decorations> decorations;
+		std::unordered_map<uint32_t, std::vector<MemberDecorations>> memberDecorations;
+		std::vector<Variable> variables;
+
+		Type const &getType(uint32_t id) const
+		{
+			auto type = types.find(id);
+			if (type == types.end())
+			{
+				throw std::runtime_error("[ERROR] SPIR-V references undeclared type " + std::to_string(id) + "!");
+			}
+			return type->second;
+		}
+
+		Decorations getDecorations(uint32_t id) const
+		{
+			auto found = decorations.find(id);
+			return found != decorations.end() ? found->second : Decorations{};
+		}
+
+		MemberDecorations getMemberDecorations(uint32_t structId, uint32_t member) const
+		{
+			auto found = memberDecorations.find(structId);
+			if (found == memberDecorations.end() || member >= found->second.size())
+			{
+				return MemberDecorations{};
+			}
+			return found->second[member];
+		}
+
+		uint32_t getConstant(uint32_t id) const
+		{
+			auto constant = constants.find(id);
+			if (constant == constants.end())
+			{
+				throw std::runtime_error("[ERROR] SPIR-V array length is not a 32 bit integer constant!");
+			}
+			return constant->second;
+		}
+	};
+
+	VkShaderStageFlags getStage(uint32_t executionModel)
+	{
+		switch (executionModel)
+		{
+		case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+		default: throw std::runtime_error("[ERROR] Unsupported SPIR-V execution model!");
+		}
+	}
+
+	Module parse(uint32_t const *words, size_t count)
+	{
+		if (count < SPIRV_HEADER_WORDS || words[0] != SPIRV_MAGIC)
+		{
+			throw std::runtime_error("[ERROR] Not a SPIR-V module!");
+		}
+
+		Module module;
+
+		for (size_t i = SPIRV_HEADER_WORDS; i < count;)
+		{
+			uint32_t op = words[i] & 0xffff;
+			uint32_t wordCount = words[i] >> 16;
+
+			if (wordCount == 0 || i + wordCount > count)
+			{
+				throw std::runtime_error("[ERROR] Truncated SPIR-V instruction!");
+			}
+
+			uint32_t const *operands = &words[i + 1];
+			uint32_t operandCount = wordCount - 1;
+
+			switch (op)
+			{
+			case OpEntryPoint:
+				if (module.stage != 0)
+				{
+					throw std::runtime_error("[ERROR] Reflection of SPIR-V modules with several entry points is not supported!");
+				}
+				module.stage = getStage(operands[0]);
+				break;
+
+			case OpTypeInt:
+			case OpTypeFloat:
+			case OpTypeVector:
+			case OpTypeMatrix:
+			case OpTypeImage:
+			case OpTypeSampler:
+			case OpTypeSampledImage:
+			case OpTypeArray:
+			case OpTypeRuntimeArray:
+			case OpTypeStruct:
+			case OpTypePointer:
+				module.types[operands[0]] = Type{ op, std::vector<uint32_t>(operands + 1, operands + operandCount) };
+				break;
+
+			case OpConstant:
+			case OpSpecConstant:
+				// Wider constants have more value words, only the low one matters for array lengths
+				if (operandCount >= 3)
+				{
+					module.constants[operands[1]] = operands[2];
+				}
+				break;
+
+			case OpVariable:
+				module.variables.push_back({ operands[1], operands[0], operands[2] });
+				break;
+
+			case OpDecorate:
+			{
+				Decorations &decorations = module.decorations[operands[0]];
+				uint32_t value = operandCount > 2 ? operands[2] : 0;
+
+				switch (operands[1])
+				{
+				case DecorationSpecId: decorations.specId = value; break;
+				case DecorationBlock: decorations.block = true; break;
+				case DecorationBufferBlock: decorations.bufferBlock = true; break;
+				case DecorationArrayStride: decorations.arrayStride = value; break;
+				case DecorationBuiltIn: decorations.builtIn = true; break;
+				case DecorationLocation: decorations.location = value; break;
+				case DecorationBinding: decorations.binding = value; break;
+				case DecorationDescriptorSet: decorations.set = value; break;
+				}
+				break;
+			}
+
+			case OpMemberDecorate:
+			{
+				std::vector<MemberDecorations> &members = module.memberDecorations[operands[0]];
+				if (members.size() <= operands[1])
+				{
+					members.resize(operands[1] + 1);
+				}
+
+				uint32_t value = operandCount > 3 ? operands[3] : 0;
+
+				if (operands[2] == DecorationOffset)
+				{
+					members[operands[1]].offset = value;
+				}
+				else if (operands[2] == DecorationMatrixStride)
+				{
+					members[operands[1]].matrixStride = value;
+				}
+				break;
+			}
+			}
+
+			i += wordCount;
+		}
+
+		if (module.stage == 0)
+		{
+			throw std::runtime_error("[ERROR] SPIR-V module has no entry point!");
+		}
+
+		return module;
+	}
+
+	// Bytes a value of the type takes in a block with explicit layout
+	uint32_t getTypeSize(Module const &module, uint32_t typeId, uint32_t matrixStride = 0)
+	{
+		Type const &type = module.getType(typeId);
+
+		switch (type.op)
+		{
+		case OpTypeInt:
+		case OpTypeFloat:
+			return type.operands[0] / 8;
+
+		case OpTypeVector:
+			return type.operands[1] * getTypeSize(module, type.operands[0]);
+
+		case OpTypeMatrix:
+			return type.operands[1] * (matrixStride != 0 ? matrixStride : getTypeSize(module, type.operands[0]));
+
+		case OpTypeArray:
+		{
+			uint32_t stride = module.getDecorations(typeId).arrayStride;
+			if (stride == 0)
+			{
+				stride = getTypeSize(module, type.operands[0], matrixStride);
+			}
+			return stride * module.getConstant(type.operands[1]);
+		}
+
+		case OpTypeStruct:
+		{
+			uint32_t size = 0;
+			for (uint32_t member = 0; member < type.operands.size(); ++member)
+			{
+				MemberDecorations decorations = module.getMemberDecorations(typeId, member);
+				size = std::max(size, decorations.offset + getTypeSize(module, type.operands[member], decorations.matrixStride));
+			}
+			return size;
+		}
+
+		default:
+			throw std::runtime_error("[ERROR] Unsupported SPIR-V type in a push constant block!");
+		}
+	}
+
+	VkDescriptorType getDescriptorType(Module const &module, uint32_t typeId, uint32_t storageClass)
+	{
+		Type const &type = module.getType(typeId);
+
+		if (storageClass == StorageClassStorageBuffer)
+		{
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+
+		if (storageClass == StorageClassUniform)
+		{
+			return module.getDecorations(typeId).bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+
+		switch (type.op)
+		{
+		case OpTypeSampledImage:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+		case OpTypeSampler:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+		case OpTypeImage:
+		{
+			// Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 with a sampler, 2 for storage), format
+			uint32_t dim = type.operands[1];
+			bool storage = type.operands[5] == 2;
+
+			if (dim == DIM_BUFFER)
+			{
+				return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			}
+			if (dim == DIM_SUBPASS_DATA)
+			{
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			}
+			return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+
+		default:
+			throw std::runtime_error("[ERROR] Unsupported SPIR-V descriptor type!");
+		}
+	}
+
+	VkFormat getVertexFormat(Module const &module, uint32_t typeId)
+	{
+		Type const *type = &module.getType(typeId);
+		uint32_t componentCount = 1;
+
+		if (type->op == OpTypeVector)
+		{
+			componentCount = type->operands[1];
+			type = &module.getType(type->operands[0]);
+		}
+
+		if ((type->op != OpTypeFloat && type->op != OpTypeInt) || type->operands[0] != 32 || componentCount > 4)
+		{
+			throw std::runtime_error("[ERROR] Unsupported vertex shader input type, only 32 bit scalars and vectors are!");
+		}
+
+		static VkFormat const floatFormats[] = {
+			VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static VkFormat const intFormats[] = {
+			VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+		static VkFormat const uintFormats[] = {
+			VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+		if (type->op == OpTypeFloat)
+		{
+			return floatFormats[componentCount - 1];
+		}
+		return type->operands[1] ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+	}
+
+	void reflectDescriptor(Module const &module, Variable const &variable, Decorations const &decorations, ShaderReflection &reflection)
+	{
+		ShaderDescriptorBinding binding;
+		binding.set = decorations.set != NOT_SET ? decorations.set : 0;
+		binding.binding = decorations.binding;
+		binding.stageFlags = module.stage;
+
+		// Arrays of descriptors multiply out into one binding
+		uint32_t typeId = module.getType(variable.pointerType).operands[1];
+		while (true)
+		{
+			Type const &type = module.getType(typeId);
+
+			if (type.op == OpTypeArray)
+			{
+				uint32_t lengthId = type.operands[1];
+				binding.descriptorCount *= module.getConstant(lengthId);
+
+				uint32_t specId = module.getDecorations(lengthId).specId;
+				if (specId != NOT_SET)
+				{
+					binding.countSpecializationId = specId;
+				}
+			}
+			else if (type.op == OpTypeRuntimeArray)
+			{
+				binding.descriptorCount = 0;
+			}
+			else
+			{
+				break;
+			}
+
+			typeId = type.operands[0];
+		}
+
+		binding.type = getDescriptorType(module, typeId, variable.storageClass);
+
+		reflection.descriptorBindings.push_back(binding);
+	}
+
+	void reflectPushConstants(Module const &module, Variable const &variable, ShaderReflection &reflection)
+	{
+		uint32_t typeId = module.getType(variable.pointerType).operands[1];
+		Type const &type = module.getType(typeId);
+
+		// The range starts at the first member, a stage's block may skip the part used by other stages
+		uint32_t begin = UINT32_MAX;
+		for (uint32_t member = 0; member < type.operands.size(); ++member)
+		{
+			begin = std::min(begin, module.getMemberDecorations(typeId, member).offset);
+		}
+
+		VkPushConstantRange range{};
+		range.stageFlags = module.stage;
+		range.offset = type.operands.empty() ? 0 : begin;
+		range.size = getTypeSize(module, typeId) - range.offset;
+
+		reflection.pushConstantRanges.push_back(range);
+	}
+}
+
+ShaderReflection ShaderReflection::reflect(std::vector<char> const &code)
+{
+	if (code.size() % 4 != 0)
+	{
+		throw std::runtime_error("[ERROR] SPIR-V code size must be a multiple of 4 bytes!");
+	}
+
+	// The bytes of a std::vector<char> are not guaranteed to be aligned for words
+	std::vector<uint32_t> words(code.size() / 4);
+	memcpy(words.data(), code.data(), code.size());
+
+	return reflect(words.data(), words.size());
+}
+
+ShaderReflection ShaderReflection::reflect(uint32_t const *words, size_t wordCount)
+{
+	Module module = parse(words, wordCount);
+
+	ShaderReflection reflection;
+	reflection.stages = module.stage;
+
+	for (Variable const &variable : module.variables)
+	{
+		Decorations decorations = module.getDecorations(variable.id);
+
+		switch (variable.storageClass)
+		{
+		case StorageClassUniformConstant:
+		case StorageClassUniform:
+		case StorageClassStorageBuffer:
+			if (decorations.binding != NOT_SET)
+			{
+				reflectDescriptor(module, variable, decorations, reflection);
+			}
+			break;
+
+		case StorageClassPushConstant:
+			reflectPushConstants(module, variable, reflection);
+			break;
+
+		case StorageClassInput:
+			if (module.stage == VK_SHADER_STAGE_VERTEX_BIT && !decorations.builtIn && decorations.location != NOT_SET)
+			{
+				uint32_t typeId = module.getType(variable.pointerType).operands[1];
+				reflection.vertexInputs.push_back({ decorations.location, getVertexFormat(module, typeId) });
+			}
+			break;
+		}
+	}
+
+	std::sort(reflection.descriptorBindings.begin(), reflection.descriptorBindings.end(),
+		[](ShaderDescriptorBinding const &a, ShaderDescriptorBinding const &b) {
+			return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+		});
+	std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(),
+		[](ShaderVertexInput const &a, ShaderVertexInput const &b) { return a.location < b.location; });
+
+	return reflection;
+}
+
+void ShaderReflection::merge(ShaderReflection const &other)
+{
+	stages |= other.stages;
+
+	for (ShaderDescriptorBinding const &binding : other.descriptorBindings)
+	{
+		auto existing = std::find_if(descriptorBindings.begin(), descriptorBindings.end(),
+			[&binding](ShaderDescriptorBinding const &b) { return b.set == binding.set && b.binding == binding.binding; });
+
+		if (existing == descriptorBindings.end())
+		{
+			descriptorBindings.push_back(binding);
+			continue;
+		}
+
+		if (existing->type != binding.type || existing->descriptorCount != binding.descriptorCount
+			|| existing->countSpecializationId != binding.countSpecializationId)
+		{
+			throw std::runtime_error("[ERROR] Shader stages disagree on descriptor set " + std::to_string(binding.set)
+				+ " binding " + std::to_string(binding.binding) + "!");
+		}
+
+		existing->stageFlags |= binding.stageFlags;
+	}
+
+	std::sort(descriptorBindings.begin(), descriptorBindings.end(),
+		[](ShaderDescriptorBinding const &a, ShaderDescriptorBinding const &b) {
+			return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+		});
+
+	pushConstantRanges.insert(pushConstantRanges.end(), other.pushConstantRanges.begin(), other.pushConstantRanges.end());
+
+	if (!other.vertexInputs.empty())
+	{
+		vertexInputs = other.vertexInputs;
+	}
+}
+
+void ShaderReflection::specialize(uint32_t specializationId, uint32_t value)
+{
+	for (ShaderDescriptorBinding &binding : descriptorBindings)
+	{
+		if (binding.countSpecializationId == specializationId)
+		{
+			binding.descriptorCount = value;
+		}
+	}
+}
+
+uint32_t ShaderReflection::getSetCount() const
+{
+	return descriptorBindings.empty() ? 0 : descriptorBindings.back().set + 1;
+}
+
+DescriptorSetLayoutDescription ShaderReflection::getDescriptorSetLayoutDescription(uint32_t set) const
+{
+	DescriptorSetLayoutDescription description;
+
+	for (ShaderDescriptorBinding const &binding : descriptorBindings)
+	{
+		if (binding.set != set)
+		{
+			continue;
+		}
+
+		if (binding.descriptorCount == 0)
+		{
+			throw std::runtime_error("[ERROR] Descriptor set " + std::to_string(set) + " binding " + std::to_string(binding.binding)
+				+ " is a runtime sized array, which layouts can't be built from!");
+		}
+
+		description.addBinding(binding.binding, binding.type, binding.descriptorCount, binding.stageFlags);
+	}
+
+	return description;
+}
+
+// Compares what the layouts are built from, so that descriptor counts left to specialization compare as specialized
+bool ShaderReflection::hasSameLayoutAs(ShaderReflection const &other) const
+{
+	if (getSetCount() != other.getSetCount() || pushConstantRanges.size() != other.pushConstantRanges.size())
+	{
+		return false;
+	}
+
+	for (uint32_t set = 0; set < getSetCount(); ++set)
+	{
+		if (!(getDescriptorSetLayoutDescription(set) == other.getDescriptorSetLayoutDescription(set)))
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < pushConstantRanges.size(); ++i)
+	{
+		VkPushConstantRange const &range = pushConstantRanges[i], &otherRange = other.pushConstantRanges[i];
+		if (range.stageFlags != otherRange.stageFlags || range.offset != otherRange.offset || range.size != otherRange.size)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ShaderReflection::coversPushConstants(VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size) const
+{
+	for (VkPushConstantRange const &range : pushConstantRanges)
+	{
+		if ((range.stageFlags & stageFlags) && offset >= range.offset && offset + size <= range.offset + range.size)
+		{
+			stageFlags &= ~range.stageFlags;
+		}
+	}
+
+	return stageFlags == 0;
+}
+
+std::vector<VkVertexInputAttributeDescription> ShaderReflection::selectVertexAttributes(
+	VkVertexInputAttributeDescription const *pAvailable, size_t availableCount) const
+{
+	std::vector<VkVertexInputAttributeDescription> attributes;
+
+	for (ShaderVertexInput const &input : vertexInputs)
+	{
+		VkVertexInputAttributeDescription const *pEnd = pAvailable + availableCount;
+		VkVertexInputAttributeDescription const *pAttribute = std::find_if(pAvailable, pEnd,
+			[&input](VkVertexInputAttributeDescription const &attribute) { return attribute.location == input.location; });
+
+		if (pAttribute == pEnd)
+		{
+			throw std::runtime_error("[ERROR] The vertex format has no attribute for shader input location "
+				+ std::to_string(input.location) + "!");
+		}
+		if (pAttribute->format != input.format)
+		{
+			throw std::runtime_error("[ERROR] The vertex attribute at location " + std::to_string(input.location)
+				+ " doesn't have the format the shader reads!");
+		}
+
+		attributes.push_back(*pAttribute);
+	}
+
+	return attributes;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "ShaderWatcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+void ShaderWatcher::lazyInit(std::string const &directory, std::vector<std::string> const &fileNames)
+{
+	mDirectory = directory;
+	mFileNames = fileNames;
+
+#ifdef __linux__
+	mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotifyFd < 0)
+	{
+		throw std::runtime_error("[ERROR] Failed to create an inotify instance!");
+	}
+
+	if (inotify_add_watch(mInotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		cleanUp();
+		throw std::runtime_error("[ERROR] Failed to watch directory " + directory + "!");
+	}
+#else
+	// Missing files get the default time, so creating one counts as a write
+	mWriteTimes.clear();
+	for (std::string const &fileName : mFileNames)
+	{
+		std::error_code error;
+		mWriteTimes.push_back(std::filesystem::last_write_time(std::filesystem::path(mDirectory) / fileName, error));
+	}
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::poll()
+{
+	std::vector<std::string> changed;
+
+#ifdef __linux__
+	if (mInotifyFd < 0)
+	{
+		return changed;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+
+	for (;;)
+	{
+		ssize_t length = read(mInotifyFd, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			// EAGAIN once every queued event was read. Any other error loses nothing that a later write won't report.
+			break;
+		}
+
+		for (char const *pEvent = buffer; pEvent < buffer + length; )
+		{
+			inotify_event const *event = reinterpret_cast<inotify_event const *>(pEvent);
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				// Events were dropped, so any file may have changed
+				for (std::string const &fileName : mFileNames)
+				{
+					addChanged(fileName, changed);
+				}
+			}
+			else if (event->len > 0)
+			{
+				addChanged(event->name, changed);
+			}
+
+			pEvent += sizeof(inotify_event) + event->len;
+		}
+	}
+#else
+	for (size_t i = 0; i < mFileNames.size(); ++i)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type writeTime =
+			std::filesystem::last_write_time(std::filesystem::path(mDirectory) / mFileNames[i], error);
+
+		// A file being replaced may briefly not exist, it is picked up on a later poll
+		if (!error && writeTime != mWriteTimes[i])
+		{
+			mWriteTimes[i] = writeTime;
+			addChanged(mFileNames[i], changed);
+		}
+	}
+#endif
+
+	return changed;
+}
+
+void ShaderWatcher::cleanUp()
+{
+#ifdef __linux__
+	if (mInotifyFd >= 0)
+	{
+		close(mInotifyFd);
+		mInotifyFd = -1;
+	}
+#else
+	mWriteTimes.clear();
+#endif
+
+	mFileNames.clear();
+}
+
+// Only watched files are reported, and each only once per poll
+void ShaderWatcher::addChanged(std::string const &fileName, std::vector<std::string> &changed) const
+{
+	if (std::find(mFileNames.begin(), mFileNames.end(), fileName) != mFileNames.end() &&
+		std::find(changed.begin(), changed.end(), fileName) == changed.end())
+	{
+		changed.push_back(fileName);
+	}
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 
+#include "VulkanMemoryStats.h"
+
 void VulkanBaseObject::allocateMemory(VkMemoryRequirements memRequirements, VkMemoryPropertyFlags properties)
 {
 	VkMemoryAllocateInfo allocInfo{};
@@ -13,4 +15,15 @@ void VulkanBaseObject::allocateMemory(VkMemoryRequirements memRequirements, VkMe
 	if (vkAllocateMemory(mLogicalDevice, &allocInfo, nullptr, &mMemoryHandle) != VK_SUCCESS) {
 		throw std::runtime_error("[ERROR] Failed to allocate memory for VulkanBaseObject!");
 	}
+
+	mMemorySize = memRequirements.size;
+
+	VulkanMemoryStats::get().recordAllocation(mMemoryHandle, mMemorySize);
+}
+
+// Not necessarily mMemoryHandle, textures free their previous allocation after replacing it
+void VulkanBaseObject::freeMemory(VkDeviceMemory memory)
+{
+	VulkanMemoryStats::get().recordFree(memory);
+	vkFreeMemory(mLogicalDevice, memory, nullptr);
 }
\ No newline at end of file
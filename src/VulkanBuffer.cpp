@@ -76,7 +76,7 @@ void VulkanBuffer::uploadData(void *data, VkDeviceSize size)
 void VulkanBuffer::cleanUp()
 {
 	vkDestroyBuffer(mLogicalDevice, mBuffer, nullptr);
-	vkFreeMemory(mLogicalDevice, mMemoryHandle, nullptr);
+	freeMemory(mMemoryHandle);
 }
 
 void VulkanBuffer::createBuffer()
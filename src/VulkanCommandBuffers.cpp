@@ -37,4 +37,26 @@ void endSingleTimeCommands(VkDevice logicalDevice, VkCommandPool commandPool, Vk
 
 	// Clean up our temporary command buffer
 	vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+}
+
+void submitSingleTimeCommands(
+	VkDevice logicalDevice,
+	VkCommandPool commandPool,
+	VkQueue queue,
+	VkCommandBuffer commandBuffer,
+	VulkanDeletionQueue *pDeletionQueue,
+	uint64_t lastUsedValue )
+{
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+
+	pDeletionQueue->push(lastUsedValue, [=]() {
+		vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+	});
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "VulkanDeletionQueue.h"
+
+#include <algorithm>
+#include <utility>
+
+void VulkanDeletionQueue::push(uint64_t lastUsedValue, Deleter deleter)
+{
+	// Keep the queue sorted so collect can stop at the first entry still in use. Holding an object
+	//  back a little longer than needed is harmless.
+	if (!mEntries.empty())
+	{
+		lastUsedValue = std::max(lastUsedValue, mEntries.back().lastUsedValue);
+	}
+
+	mEntries.push_back({ lastUsedValue, std::move(deleter) });
+}
+
+size_t VulkanDeletionQueue::collect(uint64_t completedValue)
+{
+	size_t collected = 0;
+
+	while (!mEntries.empty() && mEntries.front().lastUsedValue <= completedValue)
+	{
+		// Pop before running, a deleter may push more work
+		Deleter deleter = std::move(mEntries.front().deleter);
+		mEntries.pop_front();
+
+		deleter();
+		++collected;
+	}
+
+	return collected;
+}
+
+void VulkanDeletionQueue::flush()
+{
+	while (!mEntries.empty())
+	{
+		Deleter deleter = std::move(mEntries.front().deleter);
+		mEntries.pop_front();
+
+		deleter();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "VulkanDescriptorAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "HashUtils.h"
+#include "VulkanUtils.h"
+
+DescriptorSetDescription &DescriptorSetDescription::bindBuffer(
+	uint32_t binding, VkDescriptorType type, VkDescriptorBufferInfo const &bufferInfo)
+{
+	Binding entry;
+	entry.binding = binding;
+	entry.type = type;
+	entry.bufferInfos.push_back(bufferInfo);
+
+	bindings.push_back(std::move(entry));
+	return *this;
+}
+
+DescriptorSetDescription &DescriptorSetDescription::bindImages(
+	uint32_t binding, VkDescriptorType type, std::vector<VkDescriptorImageInfo> imageInfos)
+{
+	Binding entry;
+	entry.binding = binding;
+	entry.type = type;
+	entry.imageInfos = std::move(imageInfos);
+
+	bindings.push_back(std::move(entry));
+	return *this;
+}
+
+bool DescriptorSetDescription::operator==(DescriptorSetDescription const &other) const
+{
+	if (layout != other.layout || bindings.size() != other.bindings.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < bindings.size(); ++i)
+	{
+		Binding const &a = bindings[i];
+		Binding const &b = other.bindings[i];
+
+		if (a.binding != b.binding || a.type != b.type
+			|| a.bufferInfos.size() != b.bufferInfos.size() || a.imageInfos.size() != b.imageInfos.size())
+		{
+			return false;
+		}
+
+		for (size_t j = 0; j < a.bufferInfos.size(); ++j)
+		{
+			if (a.bufferInfos[j].buffer != b.bufferInfos[j].buffer
+				|| a.bufferInfos[j].offset != b.bufferInfos[j].offset
+				|| a.bufferInfos[j].range != b.bufferInfos[j].range)
+			{
+				return false;
+			}
+		}
+
+		for (size_t j = 0; j < a.imageInfos.size(); ++j)
+		{
+			if (a.imageInfos[j].sampler != b.imageInfos[j].sampler
+				|| a.imageInfos[j].imageView != b.imageInfos[j].imageView
+				|| a.imageInfos[j].imageLayout != b.imageInfos[j].imageLayout)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+size_t DescriptorSetDescriptionHash::operator()(DescriptorSetDescription const &description) const
+{
+	uint64_t seed = vkutils::handleBits(description.layout);
+
+	for (DescriptorSetDescription::Binding const &binding : description.bindings)
+	{
+		hashutils::combine(seed, (static_cast<uint64_t>(binding.binding) << 32) | binding.type);
+
+		for (VkDescriptorBufferInfo const &bufferInfo : binding.bufferInfos)
+		{
+			hashutils::combine(seed, vkutils::handleBits(bufferInfo.buffer));
+			hashutils::combine(seed, bufferInfo.offset ^ (bufferInfo.range << 1));
+		}
+
+		for (VkDescriptorImageInfo const &imageInfo : binding.imageInfos)
+		{
+			hashutils::combine(seed, vkutils::handleBits(imageInfo.sampler) ^ imageInfo.imageLayout);
+			hashutils::combine(seed, vkutils::handleBits(imageInfo.imageView));
+		}
+	}
+
+	return static_cast<size_t>(seed);
+}
+
+void VulkanDescriptorAllocator::lazyInit(
+	VkDevice logicalDevice, std::vector<VkDescriptorPoolSize> const &descriptorsPerSet, uint32_t initialSetsPerPool)
+{
+	mLogicalDevice = logicalDevice;
+	mDescriptorsPerSet = descriptorsPerSet;
+	mNextSetsPerPool = std::max(std::min(initialSetsPerPool, MAX_SETS_PER_POOL), 1u);
+}
+
+/**
+ * Any pool can fail an allocation, through running out of descriptors or fragmentation. Vulkan 1.0 drivers
+ *  without VK_KHR_maintenance1 don't report which, so every failure moves on to another pool, and only a
+ *  failure from a pool with nothing allocated from it yet is an error.
+ */
+VkDescriptorSet VulkanDescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+{
+	bool freshPool = false;
+
+	if (mUsedPools.empty())
+	{
+		mUsedPools.push_back(acquirePool());
+		freshPool = true;
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+	while (true)
+	{
+		allocInfo.descriptorPool = mUsedPools.back().pool;
+
+		VkResult result = vkAllocateDescriptorSets(mLogicalDevice, &allocInfo, &descriptorSet);
+		if (result == VK_SUCCESS)
+		{
+			return descriptorSet;
+		}
+
+		if (freshPool)
+		{
+			throw std::runtime_error("[ERROR] Failed to allocate descriptor set!");
+		}
+
+		mUsedPools.push_back(acquirePool());
+		freshPool = true;
+	}
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::getDescriptorSet(DescriptorSetDescription const &description)
+{
+	auto cached = mCachedSets.find(description);
+	if (cached != mCachedSets.end())
+	{
+		return cached->second;
+	}
+
+	VkDescriptorSet descriptorSet = allocate(description.layout);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites(description.bindings.size());
+
+	for (size_t i = 0; i < description.bindings.size(); ++i)
+	{
+		DescriptorSetDescription::Binding const &binding = description.bindings[i];
+
+		VkWriteDescriptorSet &write = descriptorWrites[i];
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = binding.binding;
+		write.dstArrayElement = 0;
+		write.descriptorType = binding.type;
+
+		if (!binding.bufferInfos.empty())
+		{
+			write.descriptorCount = static_cast<uint32_t>(binding.bufferInfos.size());
+			write.pBufferInfo = binding.bufferInfos.data();
+		}
+		else
+		{
+			write.descriptorCount = static_cast<uint32_t>(binding.imageInfos.size());
+			write.pImageInfo = binding.imageInfos.data();
+		}
+	}
+
+	vkUpdateDescriptorSets(mLogicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	mCachedSets.emplace(description, descriptorSet);
+
+	return descriptorSet;
+}
+
+void VulkanDescriptorAllocator::retire(uint64_t lastUsedValue)
+{
+	for (Pool const &pool : mUsedPools)
+	{
+		mRetiredPools.emplace_back(lastUsedValue, pool);
+	}
+
+	mUsedPools.clear();
+	mCachedSets.clear();
+}
+
+size_t VulkanDescriptorAllocator::collect(uint64_t completedValue)
+{
+	size_t resetCount = 0;
+
+	while (!mRetiredPools.empty() && mRetiredPools.front().first <= completedValue)
+	{
+		Pool pool = mRetiredPools.front().second;
+		mRetiredPools.pop_front();
+
+		// Frees every set allocated from it at once
+		vkResetDescriptorPool(mLogicalDevice, pool.pool, 0);
+		mFreePools.push_back(pool);
+
+		++resetCount;
+	}
+
+	return resetCount;
+}
+
+void VulkanDescriptorAllocator::cleanUp()
+{
+	for (Pool const &pool : mUsedPools)
+	{
+		vkDestroyDescriptorPool(mLogicalDevice, pool.pool, nullptr);
+	}
+
+	for (auto const &retired : mRetiredPools)
+	{
+		vkDestroyDescriptorPool(mLogicalDevice, retired.second.pool, nullptr);
+	}
+
+	for (Pool const &pool : mFreePools)
+	{
+		vkDestroyDescriptorPool(mLogicalDevice, pool.pool, nullptr);
+	}
+
+	mUsedPools.clear();
+	mRetiredPools.clear();
+	mFreePools.clear();
+	mCachedSets.clear();
+}
+
+// Reuse the largest reset pool, or grow the chain with a new one
+VulkanDescriptorAllocator::Pool VulkanDescriptorAllocator::acquirePool()
+{
+	if (!mFreePools.empty())
+	{
+		auto largest = std::max_element(mFreePools.begin(), mFreePools.end(),
+			[](Pool const &a, Pool const &b) { return a.maxSets < b.maxSets; });
+
+		Pool pool = *largest;
+		mFreePools.erase(largest);
+		return pool;
+	}
+
+	Pool pool = createPool(mNextSetsPerPool);
+	mNextSetsPerPool = std::min(mNextSetsPerPool * 2, MAX_SETS_PER_POOL);
+
+	return pool;
+}
+
+VulkanDescriptorAllocator::Pool VulkanDescriptorAllocator::createPool(uint32_t maxSets)
+{
+	std::vector<VkDescriptorPoolSize> poolSizes = mDescriptorsPerSet;
+	for (VkDescriptorPoolSize &poolSize : poolSizes)
+	{
+		poolSize.descriptorCount *= maxSets;
+	}
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = maxSets;
+
+	Pool pool;
+	pool.maxSets = maxSets;
+
+	if (vkCreateDescriptorPool(mLogicalDevice, &poolInfo, nullptr, &pool.pool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create descriptor pool!");
+	}
+
+	return pool;
+}
\ No newline at end of file
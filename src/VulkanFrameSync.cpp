@@ -0,0 +1,252 @@
+#include "VulkanFrameSync.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+bool VulkanFrameSync::isTimelineSupported(VkPhysicalDevice physicalDevice)
+{
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+	for (VkExtensionProperties const &extension : extensions)
+	{
+		if (std::strcmp(extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void VulkanFrameSync::lazyInit(VkDevice logicalDevice, bool useTimeline, uint32_t framesInFlight)
+{
+	mLogicalDevice = logicalDevice;
+	mFramesInFlight = std::max(framesInFlight, 1u);
+	mSubmittedValue = 0;
+	mCompletedValue = 0;
+
+	if (!useTimeline)
+	{
+		return;
+	}
+
+	mpGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR) vkGetDeviceProcAddr(mLogicalDevice, "vkGetSemaphoreCounterValueKHR");
+	mpWaitSemaphores = (PFN_vkWaitSemaphoresKHR) vkGetDeviceProcAddr(mLogicalDevice, "vkWaitSemaphoresKHR");
+
+	if (!mpGetSemaphoreCounterValue || !mpWaitSemaphores)
+	{
+		throw std::runtime_error("[ERROR] Failed to load VK_KHR_timeline_semaphore functions!");
+	}
+
+	VkSemaphoreTypeCreateInfoKHR typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	if (vkCreateSemaphore(mLogicalDevice, &semaphoreInfo, nullptr, &mTimelineSemaphore) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create timeline semaphore!");
+	}
+}
+
+void VulkanFrameSync::setFramesInFlight(uint32_t framesInFlight)
+{
+	wait(mSubmittedValue);
+
+	mFramesInFlight = std::max(framesInFlight, 1u);
+}
+
+/**
+ * The next submission signals mSubmittedValue + 1. The frame that last used the same resources
+ *  signaled mFramesInFlight values before that, so only it needs to have completed.
+ */
+uint32_t VulkanFrameSync::beginFrame()
+{
+	uint64_t nextValue = mSubmittedValue + 1;
+
+	if (nextValue > mFramesInFlight)
+	{
+		wait(nextValue - mFramesInFlight);
+	}
+
+	return static_cast<uint32_t>(mSubmittedValue % mFramesInFlight);
+}
+
+uint64_t VulkanFrameSync::submit(VkQueue queue, VkSubmitInfo submitInfo)
+{
+	uint64_t value = mSubmittedValue + 1;
+
+	if (isUsingTimeline())
+	{
+		// Binary semaphores in the signal list ignore their value, but the value array has to cover them
+		std::vector<VkSemaphore> signalSemaphores(
+			submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+		signalSemaphores.push_back(mTimelineSemaphore);
+
+		std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+		signalValues.back() = value;
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.pNext = submitInfo.pNext;
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("[ERROR] Failed to submit draw command buffer!");
+		}
+	}
+	else
+	{
+		VkFence fence = acquireFence();
+
+		if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS)
+		{
+			mFreeFences.push_back(fence);
+			throw std::runtime_error("[ERROR] Failed to submit draw command buffer!");
+		}
+
+		mPendingFences.emplace_back(value, fence);
+	}
+
+	mSubmittedValue = value;
+
+	return value;
+}
+
+uint64_t VulkanFrameSync::getCompletedValue()
+{
+	if (isUsingTimeline())
+	{
+		uint64_t counterValue = 0;
+		if (mpGetSemaphoreCounterValue(mLogicalDevice, mTimelineSemaphore, &counterValue) == VK_SUCCESS)
+		{
+			mCompletedValue = std::max(mCompletedValue, counterValue);
+		}
+	}
+	else
+	{
+		retireFences();
+	}
+
+	return mCompletedValue;
+}
+
+bool VulkanFrameSync::isComplete(uint64_t value)
+{
+	// Avoid asking the driver when the cached value already answers it
+	return value <= mCompletedValue || value <= getCompletedValue();
+}
+
+void VulkanFrameSync::wait(uint64_t value)
+{
+	if (isComplete(value))
+	{
+		return;
+	}
+
+	if (value > mSubmittedValue)
+	{
+		throw std::runtime_error("[ERROR] Waiting for a frame value that was never submitted!");
+	}
+
+	if (isUsingTimeline())
+	{
+		VkSemaphoreWaitInfoKHR waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &mTimelineSemaphore;
+		waitInfo.pValues = &value;
+
+		if (mpWaitSemaphores(mLogicalDevice, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+		{
+			throw std::runtime_error("[ERROR] Failed to wait for timeline semaphore!");
+		}
+
+		mCompletedValue = std::max(mCompletedValue, value);
+	}
+	else
+	{
+		// Submissions complete in order, so the fence of the submission that signaled the value is enough
+		for (std::pair<uint64_t, VkFence> const &pending : mPendingFences)
+		{
+			if (pending.first >= value)
+			{
+				if (vkWaitForFences(mLogicalDevice, 1, &pending.second, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+				{
+					throw std::runtime_error("[ERROR] Failed to wait for frame fence!");
+				}
+				break;
+			}
+		}
+
+		retireFences();
+	}
+}
+
+void VulkanFrameSync::retireFences()
+{
+	while (!mPendingFences.empty() && vkGetFenceStatus(mLogicalDevice, mPendingFences.front().second) == VK_SUCCESS)
+	{
+		mCompletedValue = std::max(mCompletedValue, mPendingFences.front().first);
+
+		vkResetFences(mLogicalDevice, 1, &mPendingFences.front().second);
+		mFreeFences.push_back(mPendingFences.front().second);
+		mPendingFences.pop_front();
+	}
+}
+
+VkFence VulkanFrameSync::acquireFence()
+{
+	if (!mFreeFences.empty())
+	{
+		VkFence fence = mFreeFences.back();
+		mFreeFences.pop_back();
+		return fence;
+	}
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkFence fence;
+	if (vkCreateFence(mLogicalDevice, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create frame fence!");
+	}
+
+	return fence;
+}
+
+void VulkanFrameSync::cleanUp()
+{
+	for (std::pair<uint64_t, VkFence> const &pending : mPendingFences)
+	{
+		vkDestroyFence(mLogicalDevice, pending.second, nullptr);
+	}
+	mPendingFences.clear();
+
+	for (VkFence fence : mFreeFences)
+	{
+		vkDestroyFence(mLogicalDevice, fence, nullptr);
+	}
+	mFreeFences.clear();
+
+	if (mTimelineSemaphore != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(mLogicalDevice, mTimelineSemaphore, nullptr);
+		mTimelineSemaphore = VK_NULL_HANDLE;
+	}
+}
\ No newline at end of file
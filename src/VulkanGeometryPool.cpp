@@ -0,0 +1,381 @@
+#include "VulkanGeometryPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+#include "VulkanCommandBuffers.h"
+
+void VulkanGeometryPool::lazyInit(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkCommandPool commandPool, VkQueue queue,
+	VulkanDeletionQueue *pDeletionQueue, uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+	mPhysicalDevice = physicalDevice;
+	mLogicalDevice = logicalDevice;
+	mCommandPool = commandPool;
+	mQueue = queue;
+	mpDeletionQueue = pDeletionQueue;
+
+	// Rebuilds copy between buffers of the same arena, so every buffer is a transfer source and destination
+	VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+	mArenas[VertexArena].elementSize = sizeof(Vertex);
+	mArenas[VertexArena].usage = transferUsage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	mArenas[Index16Arena].elementSize = sizeof(uint16_t);
+	mArenas[Index16Arena].usage = transferUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	mArenas[Index32Arena].elementSize = sizeof(uint32_t);
+	mArenas[Index32Arena].usage = transferUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+	rebuild(VertexArena, vertexCapacity, 0);
+	rebuild(Index16Arena, indexCapacity, 0);
+}
+
+/**
+ * Vertices and indices go through one host visible staging buffer into the device local arenas, in a
+ *  single submission. The staging buffer lives until the next frame completes.
+ */
+uint32_t VulkanGeometryPool::addGeometry(std::vector<Vertex> const &vertices, std::vector<uint8_t> const &indexData,
+	VkIndexType indexType, uint64_t lastUsedValue)
+{
+	PROFILE_SCOPE("VulkanGeometryPool::addGeometry");
+
+	ArenaType indexArena = getIndexArena(indexType);
+
+	GeometryAllocation allocation;
+	allocation.vertexCount = static_cast<uint32_t>(vertices.size());
+	allocation.indexCount = static_cast<uint32_t>(indexData.size() / mArenas[indexArena].elementSize);
+	allocation.indexType = indexType;
+	allocation.vertexOffset = allocate(VertexArena, allocation.vertexCount, lastUsedValue);
+	allocation.firstIndex = allocate(indexArena, allocation.indexCount, lastUsedValue);
+	allocation.isAlive = true;
+
+	VkDeviceSize vertexBytes = sizeof(Vertex) * vertices.size();
+	VkDeviceSize indexBytes = indexData.size();
+
+	if (vertexBytes + indexBytes > 0)
+	{
+		std::vector<uint8_t> stagingData(static_cast<size_t>(vertexBytes + indexBytes));
+		std::memcpy(stagingData.data(), vertices.data(), static_cast<size_t>(vertexBytes));
+		std::memcpy(stagingData.data() + vertexBytes, indexData.data(), static_cast<size_t>(indexBytes));
+
+		std::shared_ptr<VulkanBuffer> pStagingBuffer = std::make_shared<VulkanBuffer>(
+			mLogicalDevice,
+			mPhysicalDevice,
+			vertexBytes + indexBytes,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		pStagingBuffer->uploadData(stagingData.data(), vertexBytes + indexBytes);
+
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands(mLogicalDevice, mCommandPool);
+
+		if (vertexBytes > 0)
+		{
+			VkBufferCopy vertexRegion{};
+			vertexRegion.srcOffset = 0;
+			vertexRegion.dstOffset = allocation.vertexOffset * mArenas[VertexArena].elementSize;
+			vertexRegion.size = vertexBytes;
+			vkCmdCopyBuffer(commandBuffer, pStagingBuffer->getBufferHandle(), mArenas[VertexArena].pBuffer->getBufferHandle(), 1, &vertexRegion);
+		}
+
+		if (indexBytes > 0)
+		{
+			VkBufferCopy indexRegion{};
+			indexRegion.srcOffset = vertexBytes;
+			indexRegion.dstOffset = allocation.firstIndex * mArenas[indexArena].elementSize;
+			indexRegion.size = indexBytes;
+			vkCmdCopyBuffer(commandBuffer, pStagingBuffer->getBufferHandle(), mArenas[indexArena].pBuffer->getBufferHandle(), 1, &indexRegion);
+		}
+
+		submitCopies(commandBuffer, lastUsedValue);
+
+		mpDeletionQueue->push(lastUsedValue + 1, [=]() {
+			pStagingBuffer->cleanUp();
+		});
+	}
+
+	if (!mFreeHandles.empty())
+	{
+		uint32_t handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+
+		mAllocations[handle] = allocation;
+		return handle;
+	}
+
+	mAllocations.push_back(allocation);
+
+	return static_cast<uint32_t>(mAllocations.size() - 1);
+}
+
+/**
+ * The geometry is dead right away, so a rebuild before the frees run simply leaves it out. The frees
+ *  check the arena generation for that reason: after a rebuild, the old offsets mean nothing. They
+ *  work on a copy of the allocation, so the handle can be reused meanwhile.
+ */
+void VulkanGeometryPool::removeGeometry(uint32_t handle, uint64_t lastUsedValue)
+{
+	GeometryAllocation &allocation = mAllocations[handle];
+	if (!allocation.isAlive)
+	{
+		return;
+	}
+	allocation.isAlive = false;
+
+	ArenaType indexArena = getIndexArena(allocation.indexType);
+	uint64_t vertexGeneration = mArenas[VertexArena].generation;
+	uint64_t indexGeneration = mArenas[indexArena].generation;
+	GeometryAllocation removed = allocation;
+	mFreeHandles.push_back(handle);
+
+	mpDeletionQueue->push(lastUsedValue, [=]() {
+		if (mArenas[VertexArena].generation == vertexGeneration)
+		{
+			mArenas[VertexArena].allocator.free(removed.vertexOffset, removed.vertexCount);
+		}
+
+		if (mArenas[indexArena].generation == indexGeneration)
+		{
+			mArenas[indexArena].allocator.free(removed.firstIndex, removed.indexCount);
+		}
+	});
+}
+
+void VulkanGeometryPool::compact(uint64_t lastUsedValue)
+{
+	PROFILE_SCOPE("VulkanGeometryPool::compact");
+
+	for (uint32_t type = 0; type < ArenaCount; ++type)
+	{
+		// A single free range is as compact as it gets, it is at the end
+		if (mArenas[type].allocator.getFreeRangeCount() > 1)
+		{
+			rebuild(static_cast<ArenaType>(type), mArenas[type].allocator.getCapacity(), lastUsedValue);
+		}
+	}
+}
+
+uint32_t VulkanGeometryPool::allocate(ArenaType type, uint32_t count, uint64_t lastUsedValue)
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	Arena &arena = mArenas[type];
+
+	uint64_t offset = arena.allocator.allocate(count);
+	if (offset != RangeAllocator::INVALID_OFFSET)
+	{
+		return static_cast<uint32_t>(offset);
+	}
+
+	// Grow geometrically so repeated uploads don't rebuild every time
+	uint64_t required = arena.allocator.getUsedSize() + count;
+	uint64_t capacity = std::max<uint64_t>(arena.allocator.getCapacity() * 2, 1024);
+	while (capacity < required)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity > UINT32_MAX)
+	{
+		throw std::runtime_error("[ERROR] Geometry pool arena exceeds 32 bit offsets!");
+	}
+
+	rebuild(type, capacity, lastUsedValue);
+
+	// After a rebuild all free space is one range at the end
+	return static_cast<uint32_t>(arena.allocator.allocate(count));
+}
+
+void VulkanGeometryPool::rebuild(ArenaType type, uint64_t capacity, uint64_t lastUsedValue)
+{
+	PROFILE_SCOPE("VulkanGeometryPool::rebuild");
+
+	Arena &arena = mArenas[type];
+
+	std::shared_ptr<VulkanBuffer> pBuffer;
+	if (capacity > 0)
+	{
+		pBuffer = std::make_shared<VulkanBuffer>(
+			mLogicalDevice,
+			mPhysicalDevice,
+			capacity * arena.elementSize,
+			arena.usage,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+	}
+
+	// Pack the live geometry in the order it already has, so the copies never overlap
+	std::vector<uint32_t> handles;
+	for (uint32_t handle = 0; handle < static_cast<uint32_t>(mAllocations.size()); ++handle)
+	{
+		if (mAllocations[handle].isAlive && usesArena(mAllocations[handle], type) && getCount(mAllocations[handle], type) > 0)
+		{
+			handles.push_back(handle);
+		}
+	}
+
+	std::sort(handles.begin(), handles.end(), [&](uint32_t a, uint32_t b) {
+		return getOffset(mAllocations[a], type) < getOffset(mAllocations[b], type);
+	});
+
+	std::vector<VkBufferCopy> regions;
+	uint64_t packedCount = 0;
+
+	for (uint32_t handle : handles)
+	{
+		uint32_t &offset = getOffset(mAllocations[handle], type);
+		uint32_t count = getCount(mAllocations[handle], type);
+
+		VkBufferCopy region{};
+		region.srcOffset = offset * arena.elementSize;
+		region.dstOffset = packedCount * arena.elementSize;
+		region.size = count * arena.elementSize;
+		regions.push_back(region);
+
+		offset = static_cast<uint32_t>(packedCount);
+		packedCount += count;
+	}
+
+	if (packedCount > capacity)
+	{
+		throw std::runtime_error("[ERROR] Geometry pool arena rebuilt smaller than its contents!");
+	}
+
+	if (!regions.empty())
+	{
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands(mLogicalDevice, mCommandPool);
+		vkCmdCopyBuffer(commandBuffer, arena.pBuffer->getBufferHandle(), pBuffer->getBufferHandle(),
+			static_cast<uint32_t>(regions.size()), regions.data());
+		submitCopies(commandBuffer, lastUsedValue);
+	}
+
+	// Frames in flight may still read the old buffer, and the copy out of it completes with the next frame
+	if (arena.pBuffer)
+	{
+		std::shared_ptr<VulkanBuffer> pOldBuffer = arena.pBuffer;
+		mpDeletionQueue->push(lastUsedValue + 1, [=]() {
+			pOldBuffer->cleanUp();
+		});
+	}
+
+	arena.pBuffer = pBuffer;
+	arena.allocator.reset(capacity);
+	if (packedCount > 0)
+	{
+		arena.allocator.allocate(packedCount);
+	}
+	++arena.generation;
+}
+
+/**
+ * Make the copies visible to the vertex input of later frames, and to copies that move the same data
+ *  again in a rebuild, then submit without waiting. Frames go to the same queue after this, so the next
+ *  frame value completes after the copies.
+ */
+void VulkanGeometryPool::submitCopies(VkCommandBuffer commandBuffer, uint64_t lastUsedValue)
+{
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr
+	);
+
+	submitSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer, mpDeletionQueue, lastUsedValue + 1);
+}
+
+VkBuffer VulkanGeometryPool::getVertexBuffer() const
+{
+	return mArenas[VertexArena].pBuffer ? mArenas[VertexArena].pBuffer->getBufferHandle() : VK_NULL_HANDLE;
+}
+
+VkBuffer VulkanGeometryPool::getIndexBuffer(VkIndexType indexType) const
+{
+	Arena const &arena = mArenas[getIndexArena(indexType)];
+	return arena.pBuffer ? arena.pBuffer->getBufferHandle() : VK_NULL_HANDLE;
+}
+
+VkDeviceSize VulkanGeometryPool::getUsedBytes() const
+{
+	VkDeviceSize bytes = 0;
+	for (Arena const &arena : mArenas)
+	{
+		bytes += arena.allocator.getUsedSize() * arena.elementSize;
+	}
+	return bytes;
+}
+
+VkDeviceSize VulkanGeometryPool::getCapacityBytes() const
+{
+	VkDeviceSize bytes = 0;
+	for (Arena const &arena : mArenas)
+	{
+		bytes += arena.allocator.getCapacity() * arena.elementSize;
+	}
+	return bytes;
+}
+
+size_t VulkanGeometryPool::getFreeRangeCount() const
+{
+	size_t count = 0;
+	for (Arena const &arena : mArenas)
+	{
+		count += arena.allocator.getFreeRangeCount();
+	}
+	return count;
+}
+
+VulkanGeometryPool::ArenaType VulkanGeometryPool::getIndexArena(VkIndexType indexType)
+{
+	if (indexType == VK_INDEX_TYPE_UINT16)
+	{
+		return Index16Arena;
+	}
+
+	if (indexType == VK_INDEX_TYPE_UINT32)
+	{
+		return Index32Arena;
+	}
+
+	throw std::runtime_error("[ERROR] Unsupported index type for the geometry pool!");
+}
+
+uint32_t &VulkanGeometryPool::getOffset(GeometryAllocation &allocation, ArenaType type)
+{
+	return type == VertexArena ? allocation.vertexOffset : allocation.firstIndex;
+}
+
+uint32_t VulkanGeometryPool::getCount(GeometryAllocation const &allocation, ArenaType type)
+{
+	return type == VertexArena ? allocation.vertexCount : allocation.indexCount;
+}
+
+bool VulkanGeometryPool::usesArena(GeometryAllocation const &allocation, ArenaType type)
+{
+	return type == VertexArena || getIndexArena(allocation.indexType) == type;
+}
+
+void VulkanGeometryPool::cleanUp()
+{
+	for (Arena &arena : mArenas)
+	{
+		if (arena.pBuffer)
+		{
+			arena.pBuffer->cleanUp();
+			arena.pBuffer.reset();
+		}
+		arena.allocator.reset(0);
+	}
+
+	mAllocations.clear();
+	mFreeHandles.clear();
+}
\ No newline at end of file
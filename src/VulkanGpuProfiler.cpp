@@ -0,0 +1,318 @@
+#include "VulkanGpuProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+void VulkanGpuProfiler::lazyInit(
+	VkPhysicalDevice physicalDevice,
+	VkDevice logicalDevice,
+	uint32_t queueFamilyIndex,
+	uint32_t framesInFlight,
+	uint32_t maxScopesPerFrame )
+{
+	mLogicalDevice = logicalDevice;
+	mMaxQueriesPerFrame = maxScopesPerFrame * 2;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	// A queue family without valid timestamp bits can't write timestamps at all
+	uint32_t validBits = queueFamilyIndex < queueFamilyCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+
+	mSupported = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+	mTimestampPeriod = properties.limits.timestampPeriod;
+	mTimestampMask = validBits >= 64 ? UINT64_MAX : ((1ull << validBits) - 1);
+
+	if (mSupported)
+	{
+		createQueryPools(framesInFlight);
+	}
+}
+
+void VulkanGpuProfiler::setFramesInFlight(uint32_t framesInFlight)
+{
+	if (!mSupported)
+	{
+		return;
+	}
+
+	// Whatever is still unread is complete, the device is idle
+	resolveAllFrames();
+
+	destroyQueryPools();
+	createQueryPools(framesInFlight);
+}
+
+void VulkanGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameNumber)
+{
+	mpCurrentFrame = nullptr;
+	mOpenScopes.clear();
+
+	if (!mSupported || frameSlot >= mFrames.size())
+	{
+		return;
+	}
+
+	FrameQueries &frame = mFrames[frameSlot];
+
+	if (frame.recorded)
+	{
+		resolveFrame(frame);
+	}
+
+	frame.scopes.clear();
+	frame.queryCount = 0;
+	frame.recorded = true;
+	frame.frameNumber = frameNumber;
+	frame.cpuBeginTime = ChromeTraceWriter::Clock::now();
+
+	vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, mMaxQueriesPerFrame);
+
+	mpCurrentFrame = &frame;
+}
+
+void VulkanGpuProfiler::beginScope(VkCommandBuffer commandBuffer, char const *name)
+{
+	if (!mpCurrentFrame || mpCurrentFrame->queryCount + 2 > mMaxQueriesPerFrame)
+	{
+		mOpenScopes.push_back(SIZE_MAX);
+		return;
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.beginQuery = mpCurrentFrame->queryCount;
+	scope.endQuery = mpCurrentFrame->queryCount + 1;
+	mpCurrentFrame->queryCount += 2;
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mpCurrentFrame->queryPool, scope.beginQuery);
+
+	mOpenScopes.push_back(mpCurrentFrame->scopes.size());
+	mpCurrentFrame->scopes.push_back(scope);
+}
+
+void VulkanGpuProfiler::endScope(VkCommandBuffer commandBuffer)
+{
+	if (mOpenScopes.empty())
+	{
+		throw std::runtime_error("[ERROR] GPU profiler scope ended without a matching begin!");
+	}
+
+	size_t scopeIndex = mOpenScopes.back();
+	mOpenScopes.pop_back();
+
+	if (!mpCurrentFrame || scopeIndex == SIZE_MAX)
+	{
+		return;
+	}
+
+	Scope const &scope = mpCurrentFrame->scopes[scopeIndex];
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mpCurrentFrame->queryPool, scope.endQuery);
+}
+
+void VulkanGpuProfiler::endFrame()
+{
+	if (!mOpenScopes.empty())
+	{
+		throw std::runtime_error("[ERROR] GPU profiler frame ended with a scope still open!");
+	}
+
+	mpCurrentFrame = nullptr;
+}
+
+/**
+ * Called when the frame slot comes around again, by which time the frame sync has waited for the frame
+ *  that wrote these queries. Results still not available mean the frame was never submitted; those
+ *  are dropped rather than waited on.
+ */
+void VulkanGpuProfiler::resolveFrame(FrameQueries &frame)
+{
+	frame.recorded = false;
+
+	if (frame.queryCount == 0)
+	{
+		return;
+	}
+
+	std::vector<uint64_t> timestamps(frame.queryCount);
+
+	VkResult result = vkGetQueryPoolResults(
+		mLogicalDevice, frame.queryPool, 0, frame.queryCount,
+		timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
+
+	if (result != VK_SUCCESS)
+	{
+		return;
+	}
+
+	uint64_t frameBase = timestamps[frame.scopes.front().beginQuery];
+	double frameBaseMicroseconds = ChromeTraceWriter::toMicroseconds(frame.cpuBeginTime);
+
+	for (Scope const &scope : frame.scopes)
+	{
+		uint64_t ticks = (timestamps[scope.endQuery] - timestamps[scope.beginQuery]) & mTimestampMask;
+		double milliseconds = ticks * mTimestampPeriod / 1e6;
+
+		addSample(scope.name, milliseconds);
+
+		if (mKeepingSamples)
+		{
+			mKeptSamples.push_back({ scope.name, frame.frameNumber, milliseconds });
+		}
+
+		ChromeTraceEvent event;
+		event.name = scope.name;
+		event.category = "gpu";
+		event.threadId = GPU_TRACK_ID;
+		event.timestampMicroseconds =
+			frameBaseMicroseconds + ((timestamps[scope.beginQuery] - frameBase) & mTimestampMask) * mTimestampPeriod / 1e3;
+		event.durationMicroseconds = milliseconds * 1e3;
+
+		mTraceEvents.push_back(event);
+		if (mTraceEvents.size() > MAX_TRACE_EVENTS)
+		{
+			mTraceEvents.pop_front();
+		}
+	}
+}
+
+void VulkanGpuProfiler::addSample(std::string const &name, double milliseconds)
+{
+	std::deque<double> &samples = mSamples[name];
+
+	samples.push_back(milliseconds);
+	if (samples.size() > SAMPLE_WINDOW)
+	{
+		samples.pop_front();
+	}
+}
+
+void VulkanGpuProfiler::resolveAllFrames()
+{
+	for (FrameQueries &frame : mFrames)
+	{
+		if (frame.recorded)
+		{
+			resolveFrame(frame);
+		}
+	}
+}
+
+std::vector<VulkanGpuProfiler::Sample> VulkanGpuProfiler::takeSamples()
+{
+	std::vector<Sample> samples;
+	samples.swap(mKeptSamples);
+	return samples;
+}
+
+std::vector<VulkanGpuProfiler::ScopeStats> VulkanGpuProfiler::getStats() const
+{
+	std::vector<ScopeStats> stats;
+
+	for (std::pair<std::string const, std::deque<double>> const &entry : mSamples)
+	{
+		if (entry.second.empty())
+		{
+			continue;
+		}
+
+		std::vector<double> sorted(entry.second.begin(), entry.second.end());
+		std::sort(sorted.begin(), sorted.end());
+
+		double sum = 0.0;
+		for (double sample : sorted)
+		{
+			sum += sample;
+		}
+
+		size_t p99Index = static_cast<size_t>(std::ceil(0.99 * sorted.size())) - 1;
+
+		ScopeStats scopeStats;
+		scopeStats.name = entry.first;
+		scopeStats.minMilliseconds = sorted.front();
+		scopeStats.avgMilliseconds = sum / sorted.size();
+		scopeStats.p99Milliseconds = sorted[p99Index];
+		scopeStats.sampleCount = sorted.size();
+
+		stats.push_back(scopeStats);
+	}
+
+	std::sort(stats.begin(), stats.end(), [](ScopeStats const &a, ScopeStats const &b) { return a.name < b.name; });
+
+	return stats;
+}
+
+std::string VulkanGpuProfiler::report() const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "[GPU]";
+
+	if (!mSupported)
+	{
+		out << " timestamps not supported on the graphics queue";
+		return out.str();
+	}
+
+	for (ScopeStats const &stats : getStats())
+	{
+		out << " " << stats.name << " min " << stats.minMilliseconds << " / avg " << stats.avgMilliseconds
+			<< " / p99 " << stats.p99Milliseconds << " ms |";
+	}
+
+	return out.str();
+}
+
+void VulkanGpuProfiler::appendTraceEvents(ChromeTraceWriter &writer) const
+{
+	writer.setThreadName(GPU_TRACK_ID, "GPU");
+	writer.addEvents(std::vector<ChromeTraceEvent>(mTraceEvents.begin(), mTraceEvents.end()));
+}
+
+void VulkanGpuProfiler::createQueryPools(uint32_t framesInFlight)
+{
+	mFrames.resize(framesInFlight);
+
+	for (FrameQueries &frame : mFrames)
+	{
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = mMaxQueriesPerFrame;
+
+		if (vkCreateQueryPool(mLogicalDevice, &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("[ERROR] Failed to create timestamp query pool!");
+		}
+	}
+}
+
+void VulkanGpuProfiler::destroyQueryPools()
+{
+	for (FrameQueries &frame : mFrames)
+	{
+		vkDestroyQueryPool(mLogicalDevice, frame.queryPool, nullptr);
+	}
+
+	mFrames.clear();
+	mpCurrentFrame = nullptr;
+}
+
+void VulkanGpuProfiler::cleanUp()
+{
+	destroyQueryPools();
+	mSamples.clear();
+	mTraceEvents.clear();
+	mKeptSamples.clear();
+}
\ No newline at end of file
@@ -154,5 +154,17 @@ void VulkanImage::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout n
 		1, &barrier
 	);
 
-	endSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer);
+	endCommands(commandBuffer);
+}
+
+void VulkanImage::endCommands(VkCommandBuffer commandBuffer)
+{
+	if (mDeferredSubmitValue)
+	{
+		submitSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer, mpDeletionQueue, mDeferredSubmitValue);
+	}
+	else
+	{
+		endSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "VulkanLayoutCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "HashUtils.h"
+#include "VulkanUtils.h"
+
+DescriptorSetLayoutDescription &DescriptorSetLayoutDescription::addBinding(
+	uint32_t binding, VkDescriptorType type, uint32_t descriptorCount, VkShaderStageFlags stageFlags)
+{
+	VkDescriptorSetLayoutBinding layoutBinding{};
+	layoutBinding.binding = binding;
+	layoutBinding.descriptorType = type;
+	layoutBinding.descriptorCount = descriptorCount;
+	layoutBinding.stageFlags = stageFlags;
+	layoutBinding.pImmutableSamplers = nullptr;
+
+	auto position = std::upper_bound(bindings.begin(), bindings.end(), layoutBinding,
+		[](VkDescriptorSetLayoutBinding const &a, VkDescriptorSetLayoutBinding const &b) { return a.binding < b.binding; });
+	bindings.insert(position, layoutBinding);
+
+	return *this;
+}
+
+bool DescriptorSetLayoutDescription::operator==(DescriptorSetLayoutDescription const &other) const
+{
+	if (flags != other.flags || bindings.size() != other.bindings.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < bindings.size(); ++i)
+	{
+		if (bindings[i].binding != other.bindings[i].binding
+			|| bindings[i].descriptorType != other.bindings[i].descriptorType
+			|| bindings[i].descriptorCount != other.bindings[i].descriptorCount
+			|| bindings[i].stageFlags != other.bindings[i].stageFlags)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t DescriptorSetLayoutDescriptionHash::operator()(DescriptorSetLayoutDescription const &description) const
+{
+	uint64_t seed = description.flags;
+
+	for (VkDescriptorSetLayoutBinding const &binding : description.bindings)
+	{
+		hashutils::combine(seed, (static_cast<uint64_t>(binding.binding) << 32) | binding.descriptorType);
+		hashutils::combine(seed, (static_cast<uint64_t>(binding.descriptorCount) << 32) | binding.stageFlags);
+	}
+
+	return static_cast<size_t>(seed);
+}
+
+PipelineLayoutDescription &PipelineLayoutDescription::addSetLayout(VkDescriptorSetLayout setLayout)
+{
+	setLayouts.push_back(setLayout);
+	return *this;
+}
+
+PipelineLayoutDescription &PipelineLayoutDescription::addPushConstantRange(VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size)
+{
+	VkPushConstantRange range{};
+	range.stageFlags = stageFlags;
+	range.offset = offset;
+	range.size = size;
+
+	auto position = std::upper_bound(pushConstantRanges.begin(), pushConstantRanges.end(), range,
+		[](VkPushConstantRange const &a, VkPushConstantRange const &b) {
+			return a.offset != b.offset ? a.offset < b.offset : a.stageFlags < b.stageFlags;
+		});
+	pushConstantRanges.insert(position, range);
+
+	return *this;
+}
+
+bool PipelineLayoutDescription::operator==(PipelineLayoutDescription const &other) const
+{
+	if (setLayouts != other.setLayouts || pushConstantRanges.size() != other.pushConstantRanges.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < pushConstantRanges.size(); ++i)
+	{
+		if (pushConstantRanges[i].stageFlags != other.pushConstantRanges[i].stageFlags
+			|| pushConstantRanges[i].offset != other.pushConstantRanges[i].offset
+			|| pushConstantRanges[i].size != other.pushConstantRanges[i].size)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t PipelineLayoutDescriptionHash::operator()(PipelineLayoutDescription const &description) const
+{
+	uint64_t seed = description.setLayouts.size();
+
+	for (VkDescriptorSetLayout setLayout : description.setLayouts)
+	{
+		hashutils::combine(seed, vkutils::handleBits(setLayout));
+	}
+
+	for (VkPushConstantRange const &range : description.pushConstantRanges)
+	{
+		hashutils::combine(seed, range.stageFlags);
+		hashutils::combine(seed, (static_cast<uint64_t>(range.offset) << 32) | range.size);
+	}
+
+	return static_cast<size_t>(seed);
+}
+
+void VulkanLayoutCache::lazyInit(VkDevice logicalDevice)
+{
+	mLogicalDevice = logicalDevice;
+}
+
+VkDescriptorSetLayout VulkanLayoutCache::getDescriptorSetLayout(DescriptorSetLayoutDescription const &description)
+{
+	auto cached = mDescriptorSetLayouts.find(description);
+	if (cached != mDescriptorSetLayouts.end())
+	{
+		return cached->second;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.flags = description.flags;
+	layoutInfo.bindingCount = static_cast<uint32_t>(description.bindings.size());
+	layoutInfo.pBindings = description.bindings.data();
+
+	VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+	if (vkCreateDescriptorSetLayout(mLogicalDevice, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create descriptor set layout!");
+	}
+
+	mDescriptorSetLayouts.emplace(description, setLayout);
+
+	return setLayout;
+}
+
+VkPipelineLayout VulkanLayoutCache::getPipelineLayout(PipelineLayoutDescription const &description)
+{
+	auto cached = mPipelineLayouts.find(description);
+	if (cached != mPipelineLayouts.end())
+	{
+		return cached->second;
+	}
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(description.setLayouts.size());
+	pipelineLayoutInfo.pSetLayouts = description.setLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(description.pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = description.pushConstantRanges.data();
+
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	if (vkCreatePipelineLayout(mLogicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create pipeline layout!");
+	}
+
+	mPipelineLayouts.emplace(description, pipelineLayout);
+
+	return pipelineLayout;
+}
+
+void VulkanLayoutCache::cleanUp()
+{
+	// Pipeline layouts first, they were created from the set layouts
+	for (auto &entry : mPipelineLayouts)
+	{
+		vkDestroyPipelineLayout(mLogicalDevice, entry.second, nullptr);
+	}
+
+	for (auto &entry : mDescriptorSetLayouts)
+	{
+		vkDestroyDescriptorSetLayout(mLogicalDevice, entry.second, nullptr);
+	}
+
+	mPipelineLayouts.clear();
+	mDescriptorSetLayouts.clear();
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "VulkanMemoryStats.h"
+
+#include <algorithm>
+
+VulkanMemoryStats &VulkanMemoryStats::get()
+{
+	static VulkanMemoryStats stats;
+	return stats;
+}
+
+void VulkanMemoryStats::recordAllocation(VkDeviceMemory memory, VkDeviceSize size)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mAllocationSizes[memory] = size;
+
+	++mSnapshot.allocationCount;
+	++mSnapshot.liveAllocations;
+	mSnapshot.liveBytes += size;
+	mSnapshot.peakBytes = std::max(mSnapshot.peakBytes, mSnapshot.liveBytes);
+}
+
+void VulkanMemoryStats::recordFree(VkDeviceMemory memory)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto allocation = mAllocationSizes.find(memory);
+	if (allocation == mAllocationSizes.end())
+	{
+		return; // VK_NULL_HANDLE, or memory that wasn't allocated through VulkanBaseObject
+	}
+
+	++mSnapshot.freeCount;
+	--mSnapshot.liveAllocations;
+	mSnapshot.liveBytes -= allocation->second;
+
+	mAllocationSizes.erase(allocation);
+}
+
+VulkanMemoryStats::Snapshot VulkanMemoryStats::getSnapshot()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mSnapshot;
+}
+
+void VulkanMemoryStats::resetCounters()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mSnapshot.allocationCount = 0;
+	mSnapshot.freeCount = 0;
+	mSnapshot.peakBytes = mSnapshot.liveBytes;
+}
\ No newline at end of file
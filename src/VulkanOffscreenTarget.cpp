@@ -0,0 +1,85 @@
+#include "VulkanOffscreenTarget.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "VulkanBuffer.h"
+#include "VulkanCommandBuffers.h"
+
+void VulkanOffscreenTarget::lazyInit(
+	VkPhysicalDevice physicalDevice,
+	VkDevice logicalDevice,
+	uint32_t width,
+	uint32_t height,
+	VkFormat format )
+{
+	mPhysicalDevice = physicalDevice;
+	mLogicalDevice = logicalDevice;
+	mWidth = width;
+	mHeight = height;
+
+	createImage(
+		width,
+		height,
+		1,
+		format,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+	);
+}
+
+std::vector<unsigned char> VulkanOffscreenTarget::readPixels(VkCommandPool commandPool, VkQueue queue) const
+{
+	VkDeviceSize size = static_cast<VkDeviceSize>(mWidth) * mHeight * 4;
+
+	VulkanBuffer readbackBuffer{
+		mLogicalDevice,
+		mPhysicalDevice,
+		size,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+	};
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(mLogicalDevice, commandPool);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0; // Tightly packed
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { mWidth, mHeight, 1 };
+
+	vkCmdCopyImageToBuffer(
+		commandBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.getBufferHandle(), 1, &region);
+
+	endSingleTimeCommands(mLogicalDevice, commandPool, queue, commandBuffer);
+
+	std::vector<unsigned char> pixels(size);
+
+	void *data;
+	vkMapMemory(mLogicalDevice, readbackBuffer.getMemoryHandle(), 0, size, 0, &data);
+		memcpy(pixels.data(), data, static_cast<size_t>(size));
+	vkUnmapMemory(mLogicalDevice, readbackBuffer.getMemoryHandle());
+
+	readbackBuffer.cleanUp();
+
+	return pixels;
+}
+
+void VulkanOffscreenTarget::writePng(std::string const &fileName, VkCommandPool commandPool, VkQueue queue) const
+{
+	std::vector<unsigned char> pixels = readPixels(commandPool, queue);
+
+	if (!stbi_write_png(fileName.c_str(), mWidth, mHeight, 4, pixels.data(), mWidth * 4))
+	{
+		throw std::runtime_error("[ERROR] Failed to write " + fileName + "!");
+	}
+}
\ No newline at end of file
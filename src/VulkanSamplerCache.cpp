@@ -0,0 +1,147 @@
+#include "VulkanSamplerCache.h"
+
+#include <stdexcept>
+
+#include "HashUtils.h"
+
+bool SamplerDescription::operator==(SamplerDescription const &other) const
+{
+	return magFilter == other.magFilter
+		&& minFilter == other.minFilter
+		&& mipmapMode == other.mipmapMode
+		&& addressModeU == other.addressModeU
+		&& addressModeV == other.addressModeV
+		&& addressModeW == other.addressModeW
+		&& mipLodBias == other.mipLodBias
+		&& anisotropyEnable == other.anisotropyEnable
+		&& maxAnisotropy == other.maxAnisotropy
+		&& compareEnable == other.compareEnable
+		&& compareOp == other.compareOp
+		&& minLod == other.minLod
+		&& maxLod == other.maxLod
+		&& borderColor == other.borderColor
+		&& unnormalizedCoordinates == other.unnormalizedCoordinates;
+}
+
+VkSamplerCreateInfo SamplerDescription::getCreateInfo() const
+{
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = magFilter;
+	samplerInfo.minFilter = minFilter;
+	samplerInfo.mipmapMode = mipmapMode;
+	samplerInfo.addressModeU = addressModeU;
+	samplerInfo.addressModeV = addressModeV;
+	samplerInfo.addressModeW = addressModeW;
+	samplerInfo.mipLodBias = mipLodBias;
+	samplerInfo.anisotropyEnable = anisotropyEnable;
+	samplerInfo.maxAnisotropy = maxAnisotropy;
+	samplerInfo.compareEnable = compareEnable;
+	samplerInfo.compareOp = compareOp;
+	samplerInfo.minLod = minLod;
+	samplerInfo.maxLod = maxLod;
+	samplerInfo.borderColor = borderColor;
+	samplerInfo.unnormalizedCoordinates = unnormalizedCoordinates;
+
+	return samplerInfo;
+}
+
+size_t SamplerDescriptionHash::operator()(SamplerDescription const &description) const
+{
+	uint64_t seed = 0;
+
+	hashutils::combine(seed, description.magFilter);
+	hashutils::combine(seed, description.minFilter);
+	hashutils::combine(seed, description.mipmapMode);
+	hashutils::combine(seed, description.addressModeU);
+	hashutils::combine(seed, description.addressModeV);
+	hashutils::combine(seed, description.addressModeW);
+	hashutils::combine(seed, hashutils::floatBits(description.mipLodBias));
+	hashutils::combine(seed, description.anisotropyEnable);
+	hashutils::combine(seed, hashutils::floatBits(description.maxAnisotropy));
+	hashutils::combine(seed, description.compareEnable);
+	hashutils::combine(seed, description.compareOp);
+	hashutils::combine(seed, hashutils::floatBits(description.minLod));
+	hashutils::combine(seed, hashutils::floatBits(description.maxLod));
+	hashutils::combine(seed, description.borderColor);
+	hashutils::combine(seed, description.unnormalizedCoordinates);
+
+	return static_cast<size_t>(seed);
+}
+
+void VulkanSamplerCache::lazyInit(VkPhysicalDevice physicalDevice, VkDevice logicalDevice)
+{
+	mLogicalDevice = logicalDevice;
+
+	vkGetPhysicalDeviceProperties(physicalDevice, &mProperties);
+}
+
+/**
+ * Return a sampler matching the description, creating it on first use. Every acquire must be
+ *  paired with a release.
+ */
+VkSampler VulkanSamplerCache::acquire(SamplerDescription const &description)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	CachedSampler &cached = mSamplers[description];
+
+	if (cached.sampler == VK_NULL_HANDLE)
+	{
+		VkSamplerCreateInfo samplerInfo = description.getCreateInfo();
+
+		if (vkCreateSampler(mLogicalDevice, &samplerInfo, nullptr, &cached.sampler) != VK_SUCCESS)
+		{
+			mSamplers.erase(description);
+			throw std::runtime_error("[ERROR] Failed to create sampler!");
+		}
+
+		mDescriptions[cached.sampler] = description;
+	}
+
+	++cached.refCount;
+
+	return cached.sampler;
+}
+
+void VulkanSamplerCache::release(VkSampler sampler)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto descriptionIt = mDescriptions.find(sampler);
+	if (descriptionIt == mDescriptions.end())
+	{
+		return;
+	}
+
+	auto samplerIt = mSamplers.find(descriptionIt->second);
+
+	if (--samplerIt->second.refCount == 0)
+	{
+		vkDestroySampler(mLogicalDevice, sampler, nullptr);
+
+		mSamplers.erase(samplerIt);
+		mDescriptions.erase(descriptionIt);
+	}
+}
+
+size_t VulkanSamplerCache::getSamplerCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	return mSamplers.size();
+}
+
+// Destroys every sampler, whether or not it was released
+void VulkanSamplerCache::cleanUp()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &entry : mSamplers)
+	{
+		vkDestroySampler(mLogicalDevice, entry.second.sampler, nullptr);
+	}
+
+	mSamplers.clear();
+	mDescriptions.clear();
+}
\ No newline at end of file
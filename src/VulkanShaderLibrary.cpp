@@ -0,0 +1,255 @@
+#include "VulkanShaderLibrary.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+#include "HashUtils.h"
+
+namespace
+{
+	constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+	constexpr size_t SPIRV_HEADER_WORDS = 5;
+}
+
+void VulkanShaderLibrary::lazyInit(VkDevice logicalDevice)
+{
+	mLogicalDevice = logicalDevice;
+}
+
+void VulkanShaderLibrary::preload(std::vector<std::string> const &fileNames)
+{
+	for (std::string const &fileName : fileNames)
+	{
+		getFile(fileName, std::launch::async);
+	}
+}
+
+void VulkanShaderLibrary::addEmbedded(std::string const &fileName, uint32_t const *pWords, size_t wordCount)
+{
+	std::lock_guard<std::mutex> lock(mFilesMutex);
+
+	std::unique_ptr<ShaderFile> &file = mFiles[fileName];
+	if (file)
+	{
+		throw std::runtime_error("[ERROR] " + fileName + " is already in the shader library!");
+	}
+
+	file = std::make_unique<ShaderFile>();
+
+	// Nothing to read, but the module is still created on a worker
+	ShaderFile *pNewFile = file.get();
+	file->loaded = std::async(std::launch::async, [this, pNewFile, fileName, pWords, wordCount]() {
+		useCode(*pNewFile, fileName, pWords, wordCount * sizeof(uint32_t));
+	}).share();
+}
+
+// A failed load rethrows here, on every call for that file
+SpirvCode const &VulkanShaderLibrary::getCode(std::string const &fileName)
+{
+	ShaderFile &file = getFile(fileName, std::launch::deferred);
+	file.loaded.get();
+
+	return file.code;
+}
+
+VkShaderModule VulkanShaderLibrary::getShaderModule(std::string const &fileName)
+{
+	ShaderFile &file = getFile(fileName, std::launch::deferred);
+	file.loaded.get();
+
+	return file.module;
+}
+
+void VulkanShaderLibrary::remove(std::string const &fileName)
+{
+	std::lock_guard<std::mutex> filesLock(mFilesMutex);
+
+	auto fileEntry = mFiles.find(fileName);
+	if (fileEntry == mFiles.end())
+	{
+		return;
+	}
+
+	// Keeps the mapping alive until the module no longer refers to it
+	std::unique_ptr<ShaderFile> pFile = std::move(fileEntry->second);
+	mFiles.erase(fileEntry);
+
+	pFile->loaded.wait();
+
+	std::lock_guard<std::mutex> modulesLock(mModulesMutex);
+
+	// A failed load has no module
+	if (pFile->module == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	auto candidates = mModules.equal_range(pFile->code.hash);
+	auto cached = candidates.first;
+	while (cached != candidates.second && cached->second.module != pFile->module)
+	{
+		++cached;
+	}
+
+	ShaderFile const *pSharingFile = nullptr;
+	for (auto &entry : mFiles)
+	{
+		if (entry.second->module == pFile->module)
+		{
+			pSharingFile = entry.second.get();
+			break;
+		}
+	}
+
+	if (!pSharingFile)
+	{
+		vkDestroyShaderModule(mLogicalDevice, pFile->module, nullptr);
+		mModules.erase(cached);
+	}
+	else if (cached->second.code.pWords == pFile->code.pWords)
+	{
+		// The words are compared against on later loads, so they must come from a file that stays mapped
+		cached->second.code = pSharingFile->code;
+	}
+}
+
+size_t VulkanShaderLibrary::getFileCount() const
+{
+	std::lock_guard<std::mutex> lock(mFilesMutex);
+
+	return mFiles.size();
+}
+
+size_t VulkanShaderLibrary::getModuleCount() const
+{
+	std::lock_guard<std::mutex> lock(mModulesMutex);
+
+	return mModules.size();
+}
+
+void VulkanShaderLibrary::cleanUp()
+{
+	std::lock_guard<std::mutex> filesLock(mFilesMutex);
+
+	// A preload may still be creating a module. Failed loads have nothing to clean up.
+	for (auto &entry : mFiles)
+	{
+		entry.second->loaded.wait();
+	}
+
+	std::lock_guard<std::mutex> modulesLock(mModulesMutex);
+
+	for (auto &entry : mModules)
+	{
+		vkDestroyShaderModule(mLogicalDevice, entry.second.module, nullptr);
+	}
+
+	mModules.clear();
+	mFiles.clear();
+}
+
+/**
+ * Find the file's entry, starting its load with the given policy if it is new. Doesn't wait for the load,
+ *  which never holds the lock, so other files can be looked up meanwhile.
+ */
+VulkanShaderLibrary::ShaderFile &VulkanShaderLibrary::getFile(std::string const &fileName, std::launch policy)
+{
+	ShaderFile *pFile = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(mFilesMutex);
+
+		std::unique_ptr<ShaderFile> &file = mFiles[fileName];
+		if (!file)
+		{
+			file = std::make_unique<ShaderFile>();
+
+			ShaderFile *pNewFile = file.get();
+			file->loaded = std::async(policy, [this, pNewFile, fileName]() { loadFile(*pNewFile, fileName); }).share();
+		}
+
+		pFile = file.get();
+	}
+
+	return *pFile;
+}
+
+void VulkanShaderLibrary::loadFile(ShaderFile &file, std::string const &fileName)
+{
+	PROFILE_SCOPE("VulkanShaderLibrary::loadFile");
+
+	file.mapping = MappedFile(fileName);
+
+	useCode(file, fileName, static_cast<uint32_t const *>(file.mapping.getData()), file.mapping.getSize());
+}
+
+// Check that the code is SPIR-V, then give the file its module
+void VulkanShaderLibrary::useCode(ShaderFile &file, std::string const &fileName, uint32_t const *pWords, size_t size)
+{
+	if (size % sizeof(uint32_t) != 0 || size < SPIRV_HEADER_WORDS * sizeof(uint32_t))
+	{
+		throw std::runtime_error("[ERROR] " + fileName + " is not SPIR-V, its size must be a multiple of 4 bytes!");
+	}
+
+	// Mappings start on a page boundary and embedded code is a word array, so this only fails if those assumptions do
+	if (reinterpret_cast<uintptr_t>(pWords) % alignof(uint32_t) != 0)
+	{
+		throw std::runtime_error("[ERROR] " + fileName + " is not at a word aligned address!");
+	}
+
+	if (pWords[0] != SPIRV_MAGIC)
+	{
+		throw std::runtime_error("[ERROR] " + fileName + " is not SPIR-V, its magic number is wrong!");
+	}
+
+	file.code.pWords = pWords;
+	file.code.wordCount = size / sizeof(uint32_t);
+	file.code.hash = hashutils::hashWords(pWords, file.code.wordCount);
+
+	acquireModule(file);
+}
+
+/**
+ * Give the file the module for its code, creating it if no file loaded so far had the same content. The hash
+ *  picks the candidates, the words themselves decide. The module is assigned under the lock, so remove sees
+ *  every file sharing a module.
+ */
+void VulkanShaderLibrary::acquireModule(ShaderFile &file)
+{
+	SpirvCode const &code = file.code;
+
+	{
+		std::lock_guard<std::mutex> lock(mModulesMutex);
+
+		auto candidates = mModules.equal_range(code.hash);
+		for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+		{
+			SpirvCode const &cachedCode = candidate->second.code;
+			if (cachedCode.wordCount == code.wordCount
+				&& memcmp(cachedCode.pWords, code.pWords, code.wordCount * sizeof(uint32_t)) == 0)
+			{
+				file.module = candidate->second.module;
+				return;
+			}
+		}
+	}
+
+	// Created without holding the lock, it is the slow part and vkCreateShaderModule needs no synchronization
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = code.wordCount * sizeof(uint32_t);
+	createInfo.pCode = code.pWords;
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(mLogicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+	{
+		throw std::runtime_error("[ERROR] Failed to create shader module!");
+	}
+
+	std::lock_guard<std::mutex> lock(mModulesMutex);
+
+	// Another thread may have created a module for the same content meanwhile, both are kept
+	mModules.emplace(code.hash, CachedModule{ code, shaderModule });
+	file.module = shaderModule;
+}
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "VulkanTexture.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <stdexcept>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "CpuProfiler.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandBuffers.h"
 #include "VulkanImage.h"
@@ -14,6 +17,8 @@ namespace vkTextureUtils
 {
 	stbi_uc *loadTextureImage(std::string fileName, int *pTexWidth, int *pTexHeight, int *pTexChannels)
 	{
+		PROFILE_SCOPE("Decode texture");
+
 		stbi_uc *pixels = stbi_load(fileName.c_str(), pTexWidth, pTexHeight, pTexChannels, STBI_rgb_alpha);
 
 		if (!pixels)
@@ -23,6 +28,89 @@ namespace vkTextureUtils
 
 		return pixels;
 	}
+
+	uint32_t computeMipLevels(uint32_t width, uint32_t height)
+	{
+		return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+	}
+
+	VkDeviceSize computeMipChainSize(uint32_t width, uint32_t height, uint32_t baseMip)
+	{
+		VkDeviceSize size = 0;
+		uint32_t mipLevels = computeMipLevels(width, height);
+
+		for (uint32_t level = baseMip; level < mipLevels; ++level)
+		{
+			size += static_cast<VkDeviceSize>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * 4;
+		}
+
+		return size;
+	}
+
+	/**
+	 * Halve an RGBA8 image mipLevel times with a 2x2 box filter. The edge texels are repeated for odd
+	 *  dimensions, and each level is max(1, size / 2) to match the blits in generateMipmaps.
+	 */
+	std::vector<unsigned char> downsampleImage(
+		unsigned char const *pixels,
+		uint32_t width,
+		uint32_t height,
+		uint32_t mipLevel,
+		uint32_t *pMipWidth,
+		uint32_t *pMipHeight )
+	{
+		std::vector<unsigned char> current(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+		for (uint32_t level = 0; level < mipLevel; ++level)
+		{
+			uint32_t nextWidth = std::max(width / 2, 1u);
+			uint32_t nextHeight = std::max(height / 2, 1u);
+			std::vector<unsigned char> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+			for (uint32_t y = 0; y < nextHeight; ++y)
+			{
+				uint32_t y0 = std::min(2 * y, height - 1);
+				uint32_t y1 = std::min(2 * y + 1, height - 1);
+
+				for (uint32_t x = 0; x < nextWidth; ++x)
+				{
+					uint32_t x0 = std::min(2 * x, width - 1);
+					uint32_t x1 = std::min(2 * x + 1, width - 1);
+
+					for (uint32_t c = 0; c < 4; ++c)
+					{
+						uint32_t sum = current[(y0 * width + x0) * 4 + c] + current[(y0 * width + x1) * 4 + c]
+							+ current[(y1 * width + x0) * 4 + c] + current[(y1 * width + x1) * 4 + c];
+
+						next[(y * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+					}
+				}
+			}
+
+			current.swap(next);
+			width = nextWidth;
+			height = nextHeight;
+		}
+
+		*pMipWidth = width;
+		*pMipHeight = height;
+
+		return current;
+	}
+
+	std::vector<unsigned char> loadTextureMip(
+		std::string const &fileName, uint32_t mipLevel, uint32_t *pMipWidth, uint32_t *pMipHeight)
+	{
+		int texWidth, texHeight, texChannels;
+		stbi_uc *pixels = loadTextureImage(fileName, &texWidth, &texHeight, &texChannels);
+
+		PROFILE_SCOPE("Downsample texture");
+		std::vector<unsigned char> mip = downsampleImage(pixels, texWidth, texHeight, mipLevel, pMipWidth, pMipHeight);
+
+		stbi_image_free(pixels);
+
+		return mip;
+	}
 }
 
 VulkanTexture::VulkanTexture(
@@ -31,11 +119,15 @@ VulkanTexture::VulkanTexture(
 	VkDevice logicalDevice,
 	VkMemoryPropertyFlags properties,
 	VkCommandPool commandPool,
-	VkQueue queue )
+	VkQueue queue,
+	VulkanSamplerCache *pSamplerCache )
 	: VulkanImage(physicalDevice, logicalDevice, commandPool, queue)
+	, mpSamplerCache(pSamplerCache)
 	, mFileName(fileName)
 {
-	createTextureImage(properties);
+	mProperties = properties;
+
+	createTextureImage(0);
 	createTextureImageView();
 	createTextureSampler();
 }
@@ -46,20 +138,174 @@ void VulkanTexture::lazyInit(
 	VkDevice logicalDevice,
 	VkMemoryPropertyFlags properties,
 	VkCommandPool commandPool,
-	VkQueue queue )
+	VkQueue queue,
+	VulkanSamplerCache *pSamplerCache,
+	VulkanDeletionQueue *pDeletionQueue,
+	uint32_t maxResidentExtent )
 {
 	mPhysicalDevice = physicalDevice;
 	mLogicalDevice = logicalDevice;
 	mCommandPool = commandPool;
 	mQueue = queue;
+	mpSamplerCache = pSamplerCache;
+	mpDeletionQueue = pDeletionQueue;
 	mFileName = fileName;
+	mProperties = properties;
 
-	createTextureImage(properties);
+	createTextureImage(maxResidentExtent);
 	createTextureImageView();
 	createTextureSampler();
 }
 
-void VulkanTexture::copyBufferToImage(VkBuffer buffer)
+/**
+ * Replace the resident mip chain with a new one whose finest level is baseMip. The pixels are the
+ *  RGBA8 contents of that level, e.g. from vkTextureUtils::loadTextureMip. The old image view is
+ *  destroyed once lastUsedValue completes, any descriptor referencing it has to be rewritten by the
+ *  caller before then.
+ *
+ * The upload is submitted without waiting, its staging buffer lives until the next frame completes.
+ *  Frames are submitted to the same queue, so the next frame's value covers the upload as well.
+ */
+void VulkanTexture::uploadResidentMips(unsigned char const *pixels, uint32_t baseMip, uint64_t lastUsedValue)
+{
+	VkImage oldImage = mImage;
+	VkImageView oldImageView = mImageView;
+	VkDeviceMemory oldMemory = mMemoryHandle;
+
+	mDeferredSubmitValue = lastUsedValue + 1;
+	createResidentImage(pixels, baseMip);
+	mDeferredSubmitValue = 0;
+
+	createTextureImageView();
+
+	retireImage(oldImage, oldImageView, oldMemory, lastUsedValue);
+}
+
+/**
+ * Evict the mip levels finer than newBaseMip. The remaining levels are copied on the GPU into a
+ *  smaller image, so this doesn't need to touch the source file.
+ */
+void VulkanTexture::trimResidentMips(uint32_t newBaseMip, uint64_t lastUsedValue)
+{
+	if (newBaseMip <= mResidentBaseMip || newBaseMip >= mMipLevels)
+	{
+		return;
+	}
+
+	VkImage oldImage = mImage;
+	VkImageView oldImageView = mImageView;
+	VkDeviceMemory oldMemory = mMemoryHandle;
+
+	uint32_t oldLevels = getResidentMipLevels();
+	uint32_t levelOffset = newBaseMip - mResidentBaseMip;
+	uint32_t newLevels = mMipLevels - newBaseMip;
+
+	createImage(
+		std::max(mWidth >> newBaseMip, 1u),
+		std::max(mHeight >> newBaseMip, 1u),
+		newLevels,
+		VK_FORMAT_R8G8B8A8_SRGB,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		mProperties
+	);
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(mLogicalDevice, mCommandPool);
+
+	std::array<VkImageMemoryBarrier, 2> barriers{};
+	for (VkImageMemoryBarrier &barrier : barriers)
+	{
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+	}
+
+	barriers[0].image = oldImage;
+	barriers[0].subresourceRange.levelCount = oldLevels;
+	barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	barriers[1].image = mImage;
+	barriers[1].subresourceRange.levelCount = newLevels;
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].srcAccessMask = 0;
+	barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		static_cast<uint32_t>(barriers.size()), barriers.data()
+	);
+
+	std::vector<VkImageCopy> regions(newLevels);
+	for (uint32_t i = 0; i < newLevels; ++i)
+	{
+		regions[i].srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		regions[i].srcSubresource.mipLevel = i + levelOffset;
+		regions[i].srcSubresource.baseArrayLayer = 0;
+		regions[i].srcSubresource.layerCount = 1;
+		regions[i].srcOffset = { 0, 0, 0 };
+
+		regions[i].dstSubresource = regions[i].srcSubresource;
+		regions[i].dstSubresource.mipLevel = i;
+		regions[i].dstOffset = { 0, 0, 0 };
+
+		regions[i].extent = {
+			std::max(mWidth >> (newBaseMip + i), 1u),
+			std::max(mHeight >> (newBaseMip + i), 1u),
+			1
+		};
+	}
+
+	vkCmdCopyImage(
+		commandBuffer,
+		oldImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(regions.size()), regions.data()
+	);
+
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		1, &barriers[1]
+	);
+
+	submitSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer, mpDeletionQueue, lastUsedValue + 1);
+
+	mResidentBaseMip = newBaseMip;
+	createTextureImageView();
+
+	// The copy reads the old image, so it lives until the next frame, which is submitted after the copy, completes
+	retireImage(oldImage, oldImageView, oldMemory, lastUsedValue + 1);
+}
+
+// Destroy a replaced image once the GPU is done with it. The texture must outlive the deletion queue's entries.
+void VulkanTexture::retireImage(VkImage image, VkImageView imageView, VkDeviceMemory memory, uint64_t lastUsedValue)
+{
+	mpDeletionQueue->push(lastUsedValue, [this, image, imageView, memory]() {
+		vkDestroyImageView(mLogicalDevice, imageView, nullptr);
+		vkDestroyImage(mLogicalDevice, image, nullptr);
+		freeMemory(memory);
+	});
+}
+
+void VulkanTexture::copyBufferToImage(VkBuffer buffer, uint32_t width, uint32_t height)
 {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(mLogicalDevice, mCommandPool);
 
@@ -75,7 +321,7 @@ void VulkanTexture::copyBufferToImage(VkBuffer buffer)
 	region.imageSubresource.layerCount = 1;
 
 	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = { mWidth, mHeight, 1 };
+	region.imageExtent = { width, height, 1 };
 
 	vkCmdCopyBufferToImage(
 		commandBuffer,
@@ -86,20 +332,51 @@ void VulkanTexture::copyBufferToImage(VkBuffer buffer)
 		&region
 	);
 
-	endSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer);
+	endCommands(commandBuffer);
 }
 
-void VulkanTexture::createTextureImage(VkMemoryPropertyFlags properties)
+void VulkanTexture::createTextureImage(uint32_t maxResidentExtent)
 {
 	int texWidth, texHeight, texChannels;
 
 	stbi_uc *pixels = vkTextureUtils::loadTextureImage(mFileName, &texWidth, &texHeight, &texChannels);
 
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
 	mWidth = texWidth;
 	mHeight = texHeight;
 
-	mMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+	mMipLevels = vkTextureUtils::computeMipLevels(mWidth, mHeight);
+
+	// Skip the levels that are larger than the requested resident extent
+	uint32_t baseMip = 0;
+	while (maxResidentExtent && baseMip + 1 < mMipLevels
+		&& std::max(mWidth >> baseMip, mHeight >> baseMip) > maxResidentExtent)
+	{
+		++baseMip;
+	}
+
+	if (baseMip == 0)
+	{
+		createResidentImage(pixels, 0);
+	}
+	else
+	{
+		uint32_t mipWidth, mipHeight;
+		std::vector<unsigned char> mipPixels = vkTextureUtils::downsampleImage(
+			pixels, mWidth, mHeight, baseMip, &mipWidth, &mipHeight);
+
+		createResidentImage(mipPixels.data(), baseMip);
+	}
+
+	stbi_image_free(pixels);
+}
+
+void VulkanTexture::createResidentImage(unsigned char const *pixels, uint32_t baseMip)
+{
+	uint32_t width = std::max(mWidth >> baseMip, 1u);
+	uint32_t height = std::max(mHeight >> baseMip, 1u);
+	uint32_t mipLevels = mMipLevels - baseMip;
+
+	VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * 4;
 
 	VulkanBuffer stagingBuffer
 	{
@@ -111,81 +388,92 @@ void VulkanTexture::createTextureImage(VkMemoryPropertyFlags properties)
 	};
 
 	// Send data to staging buffer
-	stagingBuffer.uploadData(pixels, imageSize);
-
-	stbi_image_free(pixels);
+	stagingBuffer.uploadData(const_cast<unsigned char *>(pixels), imageSize);
 
 	createImage(
-		texWidth,
-		texHeight,
-		mMipLevels,
+		width,
+		height,
+		mipLevels,
 		VK_FORMAT_R8G8B8A8_SRGB,
 		VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		properties
+		mProperties
 	);
 
 	// vkCmdCopyBufferToImage requires the image to be in the right layout first.
-	transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mMipLevels);
-	copyBufferToImage(stagingBuffer.getBufferHandle());
+	transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+	copyBufferToImage(stagingBuffer.getBufferHandle(), width, height);
 
-	stagingBuffer.cleanUp();
+	if (mDeferredSubmitValue)
+	{
+		// VulkanBuffer can't be copied into the deleter, so it takes the handles instead
+		VkBuffer buffer = stagingBuffer.getBufferHandle();
+		VkDeviceMemory memory = stagingBuffer.getMemoryHandle();
+		mpDeletionQueue->push(mDeferredSubmitValue, [this, buffer, memory]() {
+			vkDestroyBuffer(mLogicalDevice, buffer, nullptr);
+			freeMemory(memory);
+		});
+	}
+	else
+	{
+		stagingBuffer.cleanUp();
+	}
 
 	// Transition to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL while generating mipmaps
-	generateMipmaps();
+	generateMipmaps(width, height, mipLevels);
+
+	mResidentBaseMip = baseMip;
 }
 
 void VulkanTexture::createTextureImageView()
 {
-	createPersistentImageView(VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels);
+	createPersistentImageView(VK_IMAGE_ASPECT_COLOR_BIT, getResidentMipLevels());
 }
 
+/**
+ * Nearly every texture wants the same sampler, so the sampler comes from the cache instead of
+ *  being created per texture.
+ */
 void VulkanTexture::createTextureSampler()
 {
-	VkSamplerCreateInfo samplerInfo{};
-	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	SamplerDescription description{};
 
-	samplerInfo.magFilter = VK_FILTER_LINEAR; // For when oversampling
-	samplerInfo.minFilter = VK_FILTER_LINEAR; // For when undersampling
+	description.magFilter = VK_FILTER_LINEAR; // For when oversampling
+	description.minFilter = VK_FILTER_LINEAR; // For when undersampling
 
 	// What happen when going beyond the image dimension
-	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	description.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	description.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	description.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 
 	// Enable/Disable anisotropic filtering. Performance hit.
-	samplerInfo.anisotropyEnable = VK_TRUE;
+	description.anisotropyEnable = VK_TRUE;
 
-	// Query and use the maximum amount of texels calculate the final color. Hardware dependent.
-	VkPhysicalDeviceProperties properties{};
-	vkGetPhysicalDeviceProperties(mPhysicalDevice, &properties);
-	samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+	// Use the maximum amount of texels calculate the final color. Hardware dependent, the limit is queried once by the cache.
+	description.maxAnisotropy = mpSamplerCache->getLimits().maxSamplerAnisotropy;
 
 	// Specify which color to return when sampling beyond the image when in
 	//  clamp to border mode
-	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	description.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 
 	// Specify to use normalized u,v,w coordinates
-	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	description.unnormalizedCoordinates = VK_FALSE;
 
 	// Mainly for percentage-closer filtering
-	samplerInfo.compareEnable = VK_FALSE;
-	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	description.compareEnable = VK_FALSE;
+	description.compareOp = VK_COMPARE_OP_ALWAYS;
 
-	// Mipmapping
-	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	samplerInfo.mipLodBias = 0.0f;
-	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = static_cast<float>(mMipLevels);
+	// Mipmapping. maxLod isn't clamped to this texture's chain, the image view already limits sampling to the
+	//  resident levels. That keeps the sampler identical across textures of different sizes.
+	description.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	description.mipLodBias = 0.0f;
+	description.minLod = 0.0f;
+	description.maxLod = VK_LOD_CLAMP_NONE;
 
-
-	if (vkCreateSampler(mLogicalDevice, &samplerInfo, nullptr, &mTextureSampler) != VK_SUCCESS)
-	{
-		throw std::runtime_error("Failed to create texture sampler!");
-	}
+	mTextureSampler = mpSamplerCache->acquire(description);
 }
 
-void VulkanTexture::generateMipmaps()
+void VulkanTexture::generateMipmaps(uint32_t width, uint32_t height, uint32_t mipLevels)
 {
 	// Check if image format supports linear blitting
 	VkFormatProperties formatProperties;
@@ -208,10 +496,10 @@ void VulkanTexture::generateMipmaps()
 	barrier.subresourceRange.layerCount = 1;
 	barrier.subresourceRange.levelCount = 1;
 
-	int32_t mipWidth = mWidth;
-	int32_t mipHeight = mHeight;
+	int32_t mipWidth = width;
+	int32_t mipHeight = height;
 
-	for (uint32_t i = 1; i < mMipLevels; ++i)
+	for (uint32_t i = 1; i < mipLevels; ++i)
 	{
 		barrier.subresourceRange.baseMipLevel = i - 1;
 		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -268,7 +556,7 @@ void VulkanTexture::generateMipmaps()
 	}
 
 	// This is for the mip level 0 since it isn't handled by the loop
-	barrier.subresourceRange.baseMipLevel = mMipLevels - 1;
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
 	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -282,5 +570,5 @@ void VulkanTexture::generateMipmaps()
 		1, &barrier
 	);
 
-	endSingleTimeCommands(mLogicalDevice, mCommandPool, mQueue, commandBuffer);
+	endCommands(commandBuffer);
 }
\ No newline at end of file
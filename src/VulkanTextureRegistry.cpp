@@ -0,0 +1,104 @@
+#include "VulkanTextureRegistry.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void VulkanTextureRegistry::lazyInit(VkPhysicalDevice physicalDevice, uint32_t maxTextures, bool dynamicIndexingSupported)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	// A combined image sampler counts against both the sampler and the sampled image limits
+	mCapacity = std::min({
+		maxTextures,
+		properties.limits.maxPerStageDescriptorSamplers,
+		properties.limits.maxPerStageDescriptorSampledImages,
+		properties.limits.maxDescriptorSetSamplers,
+		properties.limits.maxDescriptorSetSampledImages
+	});
+
+	// Indexing a sampler array with a push constant needs shaderSampledImageArrayDynamicIndexing
+	if (!dynamicIndexingSupported)
+	{
+		mCapacity = std::min(mCapacity, 1u);
+	}
+
+	mSlots.assign(mCapacity, nullptr);
+	mFreeSlots.clear();
+	mTextureCount = 0;
+
+	// Hand out low indices first
+	for (uint32_t i = mCapacity; i > 0; --i)
+	{
+		mFreeSlots.push_back(i - 1);
+	}
+}
+
+uint32_t VulkanTextureRegistry::registerTexture(VulkanTexture const *pTexture)
+{
+	if (mFreeSlots.empty())
+	{
+		throw std::runtime_error("[ERROR] Texture registry is full!");
+	}
+
+	uint32_t index = mFreeSlots.back();
+	mFreeSlots.pop_back();
+
+	if (mTextureCount == 0)
+	{
+		mFallbackIndex = index;
+	}
+
+	mSlots[index] = pTexture;
+	++mTextureCount;
+
+	return index;
+}
+
+void VulkanTextureRegistry::unregisterTexture(uint32_t index)
+{
+	if (index >= mCapacity || !mSlots[index])
+	{
+		return;
+	}
+
+	mSlots[index] = nullptr;
+	mFreeSlots.push_back(index);
+	--mTextureCount;
+
+	// Promote any remaining texture to be the fallback
+	if (index == mFallbackIndex)
+	{
+		for (uint32_t i = 0; i < mCapacity; ++i)
+		{
+			if (mSlots[i])
+			{
+				mFallbackIndex = i;
+				break;
+			}
+		}
+	}
+}
+
+std::vector<VkDescriptorImageInfo> VulkanTextureRegistry::getImageInfos() const
+{
+	if (mTextureCount == 0)
+	{
+		throw std::runtime_error("[ERROR] Texture registry has no texture to bind!");
+	}
+
+	VulkanTexture const *pFallback = mSlots[mFallbackIndex];
+
+	std::vector<VkDescriptorImageInfo> imageInfos(mCapacity);
+
+	for (uint32_t i = 0; i < mCapacity; ++i)
+	{
+		VulkanTexture const *pTexture = mSlots[i] ? mSlots[i] : pFallback;
+
+		imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfos[i].imageView = pTexture->getTextureImageView();
+		imageInfos[i].sampler = pTexture->getTextureSampler();
+	}
+
+	return imageInfos;
+}
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "VulkanTextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+
+void VulkanTextureStreamer::lazyInit(
+	VkPhysicalDevice physicalDevice,
+	VkDevice logicalDevice,
+	VkCommandPool commandPool,
+	VkQueue queue,
+	VulkanSamplerCache *pSamplerCache,
+	VulkanDeletionQueue *pDeletionQueue,
+	VkDeviceSize memoryBudget,
+	uint32_t initialResidentExtent )
+{
+	mPhysicalDevice = physicalDevice;
+	mLogicalDevice = logicalDevice;
+	mCommandPool = commandPool;
+	mQueue = queue;
+	mpSamplerCache = pSamplerCache;
+	mpDeletionQueue = pDeletionQueue;
+	mMemoryBudget = memoryBudget;
+	mInitialResidentExtent = initialResidentExtent;
+
+	mStopWorker = false;
+	mWorker = std::thread(&VulkanTextureStreamer::workerLoop, this);
+}
+
+/**
+ * Load the coarse tail of a texture synchronously and return a handle for it. The handle stays
+ *  valid for the lifetime of the streamer.
+ */
+uint32_t VulkanTextureStreamer::addTexture(std::string const &fileName)
+{
+	std::shared_ptr<StreamedTexture> pStreamed = std::make_shared<StreamedTexture>();
+
+	pStreamed->texture.lazyInit(
+		fileName, mPhysicalDevice, mLogicalDevice, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		mCommandPool, mQueue, mpSamplerCache, mpDeletionQueue, mInitialResidentExtent);
+
+	pStreamed->coarsestBaseMip = pStreamed->texture.getResidentBaseMip();
+	pStreamed->requestedBaseMip = pStreamed->coarsestBaseMip;
+
+	mTextures.push_back(pStreamed);
+
+	return static_cast<uint32_t>(mTextures.size() - 1);
+}
+
+/**
+ * The finest mip worth sampling for a texture covering screenSpacePixels on screen. A texel per
+ *  pixel is the target, anything finer is only ever seen minified.
+ */
+uint32_t VulkanTextureStreamer::computeRequiredMip(uint32_t width, uint32_t height, float screenSpacePixels)
+{
+	uint32_t mipLevels = vkTextureUtils::computeMipLevels(width, height);
+
+	if (screenSpacePixels <= 1.0f)
+	{
+		return mipLevels - 1;
+	}
+
+	float ratio = static_cast<float>(std::max(width, height)) / screenSpacePixels;
+	if (ratio <= 1.0f)
+	{
+		return 0;
+	}
+
+	return std::min(static_cast<uint32_t>(std::floor(std::log2(ratio))), mipLevels - 1);
+}
+
+/**
+ * Record that a texture is visible this frame with the given screen space footprint, which is
+ *  the larger of its projected width and height in pixels. A texture drawn several times in a
+ *  frame gets the finest level any of its draws needs.
+ */
+void VulkanTextureStreamer::requestFootprint(uint32_t handle, float screenSpacePixels, uint64_t frameIndex)
+{
+	StreamedTexture &streamed = *mTextures[handle];
+
+	uint32_t requiredMip = std::min(
+		computeRequiredMip(streamed.texture.getWidth(), streamed.texture.getHeight(), screenSpacePixels),
+		streamed.coarsestBaseMip);
+
+	if (frameIndex != streamed.lastUsedFrame)
+	{
+		streamed.requestedBaseMip = requiredMip;
+	}
+	else
+	{
+		streamed.requestedBaseMip = std::min(streamed.requestedBaseMip, requiredMip);
+	}
+	streamed.lastUsedFrame = frameIndex;
+}
+
+/**
+ * Call once per frame from the thread that owns the queue. Finished decodes are uploaded here,
+ *  and textures that want finer levels than they have get queued for the worker.
+ */
+bool VulkanTextureStreamer::update(uint64_t lastUsedValue)
+{
+	PROFILE_SCOPE("Texture streamer update");
+
+	std::vector<StreamResult> results;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		results.swap(mResults);
+	}
+
+	bool imageViewsChanged = false;
+
+	for (StreamResult &result : results)
+	{
+		StreamedTexture &streamed = *mTextures[result.handle];
+		streamed.loadPending = false;
+
+		if (result.pixels.empty())
+		{
+			streamed.loadFailed = true;
+			continue;
+		}
+
+		// Something finer got uploaded in the meantime, or the result arrived too late to matter
+		if (result.baseMip >= streamed.texture.getResidentBaseMip() || result.baseMip < streamed.requestedBaseMip)
+		{
+			continue;
+		}
+
+		VkDeviceSize incomingSize = vkTextureUtils::computeMipChainSize(
+			streamed.texture.getWidth(), streamed.texture.getHeight(), result.baseMip) - getResidentSize(streamed);
+
+		bool evicted = false;
+		bool fits = makeRoom(incomingSize, result.handle, lastUsedValue, evicted);
+		imageViewsChanged |= evicted;
+
+		if (!fits)
+		{
+			continue;
+		}
+
+		streamed.texture.uploadResidentMips(result.pixels.data(), result.baseMip, lastUsedValue);
+		imageViewsChanged = true;
+	}
+
+	std::vector<StreamRequest> requests;
+
+	for (uint32_t handle = 0; handle < mTextures.size(); ++handle)
+	{
+		StreamedTexture &streamed = *mTextures[handle];
+
+		if (!streamed.loadPending && !streamed.loadFailed
+			&& streamed.requestedBaseMip < streamed.texture.getResidentBaseMip())
+		{
+			streamed.loadPending = true;
+			requests.push_back({ handle, streamed.requestedBaseMip, streamed.texture.getFileName() });
+		}
+	}
+
+	if (!requests.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRequests.insert(mRequests.end(), requests.begin(), requests.end());
+		}
+
+		mCondition.notify_one();
+	}
+
+	return imageViewsChanged;
+}
+
+/**
+ * Evict mip levels until incomingSize more bytes fit in the budget. Textures that hold finer levels
+ *  than they currently ask for go first, then the least recently used ones. Each eviction only
+ *  drops the single finest resident level, so a texture loses detail one level at a time.
+ *
+ * Returns false if the budget can't be met, in which case the eviction that did happen is kept.
+ *  evicted is set if any image got replaced.
+ */
+bool VulkanTextureStreamer::makeRoom(VkDeviceSize incomingSize, uint32_t excludedHandle, uint64_t lastUsedValue, bool &evicted)
+{
+	VkDeviceSize residentMemory = getResidentMemory();
+
+	while (residentMemory + incomingSize > mMemoryBudget)
+	{
+		uint32_t victim = std::numeric_limits<uint32_t>::max();
+		bool victimOverResident = false;
+		uint64_t victimLastUsed = std::numeric_limits<uint64_t>::max();
+
+		for (uint32_t handle = 0; handle < mTextures.size(); ++handle)
+		{
+			StreamedTexture const &streamed = *mTextures[handle];
+			uint32_t residentBaseMip = streamed.texture.getResidentBaseMip();
+
+			if (handle == excludedHandle || residentBaseMip >= streamed.coarsestBaseMip)
+			{
+				continue;
+			}
+
+			bool overResident = residentBaseMip < streamed.requestedBaseMip;
+
+			if ((overResident && !victimOverResident)
+				|| (overResident == victimOverResident && streamed.lastUsedFrame < victimLastUsed))
+			{
+				victim = handle;
+				victimOverResident = overResident;
+				victimLastUsed = streamed.lastUsedFrame;
+			}
+		}
+
+		if (victim == std::numeric_limits<uint32_t>::max())
+		{
+			return false;
+		}
+
+		StreamedTexture &streamed = *mTextures[victim];
+		VkDeviceSize sizeBefore = getResidentSize(streamed);
+
+		streamed.texture.trimResidentMips(streamed.texture.getResidentBaseMip() + 1, lastUsedValue);
+		evicted = true;
+
+		residentMemory -= sizeBefore - getResidentSize(streamed);
+	}
+
+	return true;
+}
+
+VkDeviceSize VulkanTextureStreamer::getResidentSize(StreamedTexture const &streamed) const
+{
+	return vkTextureUtils::computeMipChainSize(
+		streamed.texture.getWidth(), streamed.texture.getHeight(), streamed.texture.getResidentBaseMip());
+}
+
+VkDeviceSize VulkanTextureStreamer::getResidentMemory() const
+{
+	VkDeviceSize residentMemory = 0;
+
+	for (std::shared_ptr<StreamedTexture> const &pStreamed : mTextures)
+	{
+		residentMemory += getResidentSize(*pStreamed);
+	}
+
+	return residentMemory;
+}
+
+void VulkanTextureStreamer::workerLoop()
+{
+	CpuProfiler::get().setThreadName("Texture streamer");
+
+	while (true)
+	{
+		StreamRequest request;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this] { return mStopWorker || !mRequests.empty(); });
+
+			if (mStopWorker)
+			{
+				return;
+			}
+
+			request = std::move(mRequests.front());
+			mRequests.pop_front();
+		}
+
+		StreamResult result{ request.handle, request.baseMip, {} };
+
+		// A failed decode comes back with no pixels so update() can stop asking for this texture
+		try
+		{
+			uint32_t mipWidth, mipHeight;
+			result.pixels = vkTextureUtils::loadTextureMip(request.fileName, request.baseMip, &mipWidth, &mipHeight);
+		}
+		catch (std::exception const &)
+		{
+			result.pixels.clear();
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mResults.push_back(std::move(result));
+	}
+}
+
+void VulkanTextureStreamer::cleanUp()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopWorker = true;
+		mRequests.clear();
+		mResults.clear();
+	}
+
+	mCondition.notify_all();
+
+	if (mWorker.joinable())
+	{
+		mWorker.join();
+	}
+
+	for (std::shared_ptr<StreamedTexture> &pStreamed : mTextures)
+	{
+		pStreamed->texture.cleanUp();
+	}
+
+	mTextures.clear();
+}
\ No newline at end of file
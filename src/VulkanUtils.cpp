@@ -1,6 +1,8 @@
 #include "VulkanUtils.h"
 
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 namespace vkutils
 {
@@ -70,4 +72,30 @@ namespace vkutils
 	{
 		return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 	}
+
+	/**
+	 * Simple helper function to load in the SPIR-V bytecode generated from the shaders
+	 */
+	std::vector<char> readFile(const std::string &filename)
+	{
+		// We read from the end of the file, indicated by std::ios::ate.
+		std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+		if (!file.is_open()) {
+			throw std::runtime_error("[ERROR] Failed to open file!");
+		}
+
+		// We read from end of file so that we can use the read position to determine the
+		//  size of the file and allocate a buffer.
+		size_t fileSize = (size_t) file.tellg();
+		std::vector<char> buffer(fileSize);
+
+		// Seek back at the beginning of the file and read all of the bytes all of the bytes at once
+		file.seekg(0);
+		file.read(buffer.data(), fileSize);
+
+		file.close();
+
+		return buffer;
+	}
 }
\ No newline at end of file
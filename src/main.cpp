@@ -9,30 +9,66 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono> // Precise timekeeping
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
+#include <filesystem>
+#include <future>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "BenchmarkReport.h"
+#include "BenchmarkScenario.h"
+#include "Camera.h"
+#include "ChromeTrace.h"
+#include "CpuProfiler.h"
+#include "FramePacket.h"
+#include "FrameStageTimings.h"
+#include "MatrixMath.h"
 #include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "Scene.h"
+#include "ShaderCompiler.h"
+#include "ShaderReflection.h"
+#include "ShaderWatcher.h"
+#include "SpscQueue.h"
 #include "Vertex.h"
 #include "VulkanBaseApplication.h"
-#include "VulkanBuffer.h"
 #include "VulkanCommandBuffers.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanDescriptorAllocator.h"
 #include "VulkanDepthResources.h"
+#include "VulkanFrameSync.h"
+#include "VulkanGeometryPool.h"
+#include "VulkanGpuProfiler.h"
 #include "VulkanImage.h"
+#include "VulkanLayoutCache.h"
+#include "VulkanMemoryStats.h"
+#include "VulkanOffscreenTarget.h"
+#include "VulkanSamplerCache.h"
+#include "VulkanShaderLibrary.h"
 #include "VulkanTexture.h"
+#include "VulkanTextureRegistry.h"
+#include "VulkanTextureStreamer.h"
 #include "VulkanUtils.h"
 
+// Generated by the build from the compiled shaders, see embedShaders in utils.cmake
+#ifdef VULKAN_RENDERER_EMBEDDED_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
 #ifdef _MSC_VER
 constexpr char resource_dir[] = "../../resources/";
 #else
@@ -41,8 +77,48 @@ constexpr char resource_dir[] = "../resources/";
 
 const uint32_t WIDTH = 800, HEIGHT = 600;
 
-// How many frames should be processed concurrently
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// How many frames should be processed concurrently. Can be changed at runtime with the number keys 1 to MAX_FRAMES_IN_FLIGHT.
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+// How many frame packets the update thread may produce ahead of the render thread
+const uint32_t FRAME_PACKET_QUEUE_DEPTH = 2;
+
+// Written when T is pressed
+constexpr char TRACE_FILE_NAME[] = "frame_trace.json";
+
+// Headless runs render into this many offscreen images, standing in for swap chain images
+const uint32_t OFFSCREEN_IMAGE_COUNT = 3;
+const VkFormat OFFSCREEN_IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+// Frames rendered by a headless run when no frame count is given
+const uint32_t DEFAULT_HEADLESS_FRAME_COUNT = 300;
+
+// Frames left out of benchmark results while caches, pipelines and texture streaming settle
+const uint32_t DEFAULT_BENCHMARK_WARMUP_FRAMES = 30;
+
+// Render sizes a resize storm cycles through, relative to the requested size
+const std::array<float, 4> RESIZE_STORM_SCALES = { 0.5f, 0.75f, 1.25f, 1.0f };
+
+// Device memory the texture streamer may keep resident, and the size of the coarse mips loaded up front
+const VkDeviceSize TEXTURE_MEMORY_BUDGET = 256ull * 1024 * 1024;
+const uint32_t TEXTURE_INITIAL_RESIDENT_EXTENT = 128;
+
+// Upper bound on the size of the texture array every material indexes into
+const uint32_t MAX_BINDLESS_TEXTURES = 1024;
+
+// Initial size of the shared vertex and 16 bit index buffers, in elements. The pool grows past this as needed.
+const uint32_t GEOMETRY_POOL_VERTEX_CAPACITY = 256 * 1024;
+const uint32_t GEOMETRY_POOL_INDEX_CAPACITY = 1024 * 1024;
+
+// Compact the geometry pool once freed geometry has split its free space into this many ranges
+const size_t GEOMETRY_POOL_MAX_FREE_RANGES = 16;
+
+// GLSL sources in resources/shaders watched for hot reloading, and the SPIR-V each is compiled to by the build
+constexpr char VERT_SHADER_SOURCE[] = "simple.vert";
+constexpr char FRAG_SHADER_SOURCE[] = "simple.frag";
+constexpr char VERT_SHADER_BINARY[] = "vert.spv";
+constexpr char FRAG_SHADER_BINARY[] = "frag.spv";
 
 // List of required device extensions
 const std::vector<const char *> deviceExtensions = {
@@ -76,19 +152,69 @@ struct SwapChainSupportDetails
 	std::vector<VkPresentModeKHR> presentModes;
 };
 
-struct UniformBufferObject
+/**
+ * Set from the command line. In headless mode no window or surface is created and frames are rendered into
+ *  offscreen images, so the renderer can run on machines without a display, e.g. with Mesa lavapipe.
+ */
+struct ApplicationOptions
 {
-	glm::mat4 model;
-	glm::mat4 view;
-	glm::mat4 proj;
+	bool headless = false;
+	uint32_t frameCount = 0;		// Stop after this many frames, 0 means run until the window is closed
+	std::string screenshotPath;		// Headless only: write the last rendered frame to this PNG file
+	uint32_t width = WIDTH;
+	uint32_t height = HEIGHT;
+	BenchmarkScenario scenario;		// Workload to render, the baseline scene by default
+	std::string benchmarkPath;		// Write the results of the run to this JSON file
+	uint32_t warmupFrames = DEFAULT_BENCHMARK_WARMUP_FRAMES;
+	bool watchShaders = false;		// Recompile and reload the shaders when their sources are saved
 };
 
+/**
+ * The outcome of a shader hot reload, built on a worker thread. On success it holds a pipeline built from the
+ *  new SPIR-V, ready to replace the current one, otherwise the reason the current one stays.
+ */
+struct ShaderReload
+{
+	bool succeeded = false;
+	std::string log;	// Compiler output and errors
+	std::string vertShaderPath;
+	std::string fragShaderPath;
+	ShaderReflection reflection;
+	VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
+/**
+ * Per-draw data pushed straight into the command buffer, so drawing another object needs no buffer writes
+ *  or descriptor updates. The vertex stage reads the model view projection matrix and the fragment stage the material, each
+ *  through its own range. A material is currently just the slot of its texture in the texture registry.
+ *  The ranges cover 68 bytes, within the 128 bytes every device supports.
+ */
+struct DrawPushConstants
+{
+	glm::mat4 modelViewProj;
+	uint32_t materialIndex;
+};
+
+const uint32_t DRAW_PUSH_CONSTANTS_VERTEX_OFFSET = offsetof(DrawPushConstants, modelViewProj);
+const uint32_t DRAW_PUSH_CONSTANTS_VERTEX_SIZE = sizeof(glm::mat4);
+const uint32_t DRAW_PUSH_CONSTANTS_FRAGMENT_OFFSET = offsetof(DrawPushConstants, materialIndex);
+const uint32_t DRAW_PUSH_CONSTANTS_FRAGMENT_SIZE = sizeof(uint32_t);
+
 class HelloTriangleApplication
 {
 public:
+	explicit HelloTriangleApplication(const ApplicationOptions &options = ApplicationOptions())
+		: mOptions(options), mOffscreenExtent{ options.width, options.height }
+	{
+	}
+
 	void run()
 	{
-		initWindow();
+		CpuProfiler::get().setThreadName("Main");
+
+		if (!mOptions.headless) {
+			initWindow();
+		}
 		initVulkan();
 		mainLoop();
 		cleanup();
@@ -103,13 +229,15 @@ private:
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
 		// Create the actual window
-		window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
+		window = glfwCreateWindow(mOptions.width, mOptions.height, "Vulkan", nullptr, nullptr);
 
 		// Store the pointer to current instance of our main application for later use, i.e. window resize callback
 		glfwSetWindowUserPointer(window, this);
 
 		// Set up resize callback
 		glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+
+		glfwSetKeyCallback(window, keyCallback);
 	}
 
 	/**
@@ -118,21 +246,48 @@ private:
 	 */
 	std::vector<const char *> getRequiredExtensions()
 	{
-		uint32_t glfwExtensionCount = 0;
-		const char **glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		std::vector<const char *> extensions;
+
+		// Surface extensions are only needed to present to a window
+		if (!mOptions.headless) {
+			uint32_t glfwExtensionCount = 0;
+			const char **glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-		// Create a vector and fill it with content of glfwExtensions array. First parameter is the first element
-		//  of the array, while the second parameter is the last element.
-		std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+			// Fill the vector with content of glfwExtensions array. First parameter is the first element
+			//  of the array, while the second parameter is the last element.
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
 
 		if (enableValidationLayers) {
 			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 		}
 
+		// VK_KHR_timeline_semaphore depends on this on Vulkan 1.0. Without it, frame sync falls back to fences.
+		if (isInstanceExtensionAvailable(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+			extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+			mPhysicalDeviceProperties2Enabled = true;
+		}
+
 		return extensions;
 	}
 
+	bool isInstanceExtensionAvailable(const char *extensionName)
+	{
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+		for (const VkExtensionProperties &extension : availableExtensions) {
+			if (strcmp(extension.extensionName, extensionName) == 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	/**
 	 * This function has to be static because GLFW doesn't know how to properly refer to the current
 	 *  instance of our HelloTriangleApplication. A static member function has the benefit of can be used
@@ -151,6 +306,27 @@ private:
 		app->framebufferResized = true;	// Set the resize flag in the case of this callback function got called
 	}
 
+	/**
+	 * Number keys pick how many frames may be in flight, T writes a trace of the recent frames. Both are
+	 *  applied by the render loop between frames. P toggles CPU profiling scopes.
+	 */
+	static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+	{
+		if (action != GLFW_PRESS) {
+			return;
+		}
+
+		HelloTriangleApplication *app = reinterpret_cast<HelloTriangleApplication *>(glfwGetWindowUserPointer(window));
+
+		if (key >= GLFW_KEY_1 && key < GLFW_KEY_1 + static_cast<int>(MAX_FRAMES_IN_FLIGHT)) {
+			app->mRequestedFramesInFlight = static_cast<uint32_t>(key - GLFW_KEY_1 + 1);
+		} else if (key == GLFW_KEY_T) {
+			app->mTraceRequested = true;
+		} else if (key == GLFW_KEY_P) {
+			CpuProfiler::get().setEnabled(!CpuProfiler::get().isEnabled());
+		}
+	}
+
 	QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device)
 	{
 		QueueFamilyIndices indices;
@@ -170,11 +346,16 @@ private:
 				indices.graphicsFamily = i;
 			}
 
-			// Look for presenting queue family
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
-			if (presentSupport) {
-				indices.presentFamily = i;
+			// Look for presenting queue family. Without a surface nothing is presented, so the graphics queue stands in for
+			//  it and the offscreen images never change queue family.
+			if (mOptions.headless) {
+				indices.presentFamily = indices.graphicsFamily;
+			} else {
+				VkBool32 presentSupport = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+				if (presentSupport) {
+					indices.presentFamily = i;
+				}
 			}
 
 			if (indices.isComplete()) {
@@ -196,6 +377,8 @@ private:
 	 */
 	void createBaseApplication()
 	{
+		PROFILE_SCOPE("createBaseApplication");
+
 		VkApplicationInfo appInfo{};
 		appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
 		appInfo.pApplicationName = "Hello Triangle";
@@ -225,7 +408,8 @@ private:
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
 		// This is an interesting way to check off which required extension is available.
-		std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+		std::vector<const char *> requiredDeviceExtensions = getRequiredDeviceExtensions();
+		std::set<std::string> requiredExtensions(requiredDeviceExtensions.begin(), requiredDeviceExtensions.end());
 
 		for (const VkExtensionProperties &extension : availableExtensions) {
 			requiredExtensions.erase(extension.extensionName);
@@ -235,6 +419,16 @@ private:
 		return requiredExtensions.empty();
 	}
 
+	// A swap chain is only needed to present to a window
+	std::vector<const char *> getRequiredDeviceExtensions()
+	{
+		if (mOptions.headless) {
+			return {};
+		}
+
+		return deviceExtensions;
+	}
+
 	bool checkAdequateSwapChain(VkPhysicalDevice device)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
@@ -313,8 +507,9 @@ private:
 			return 0;
 		}
 
-		// Check for swap chain, this might not be the best logic flow
-		if (extensionsSupported && !checkAdequateSwapChain(device)) {
+		// Check for swap chain, this might not be the best logic flow. Headless runs render offscreen, which lets
+		//  software rasterizers like lavapipe qualify; they score lowest as they aren't discrete GPUs.
+		if (!mOptions.headless && extensionsSupported && !checkAdequateSwapChain(device)) {
 			return 0;
 		}
 
@@ -330,6 +525,8 @@ private:
 	 */
 	void pickPhysicalDevice()
 	{
+		PROFILE_SCOPE("pickPhysicalDevice");
+
 		uint32_t deviceCount = 0;
 		vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
 
@@ -359,6 +556,8 @@ private:
 
 	void createLogicalDevice()
 	{
+		PROFILE_SCOPE("createLogicalDevice");
+
 		QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
 		// We need to create multiple VkDeviceQueueCreateInfo structs to contain info for each queue from
@@ -378,9 +577,25 @@ private:
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 		// Specify the set of device features that we'll be using
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// Lets the fragment shader pick a texture from the bindless array with a push constant
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+		mDynamicTextureIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing == VK_TRUE;
+
+		std::vector<const char *> enabledExtensions = getRequiredDeviceExtensions();
+
+		// Frame synchronization runs on a timeline semaphore when the device has one. Devices exposing the
+		//  extension must support its timelineSemaphore feature, so no feature query is needed.
+		mTimelineSemaphoreEnabled = mPhysicalDeviceProperties2Enabled && VulkanFrameSync::isTimelineSupported(physicalDevice);
+
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
 
 		// Create a logical device
 		VkDeviceCreateInfo createInfo{};
@@ -388,8 +603,14 @@ private:
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+		if (mTimelineSemaphoreEnabled) {
+			enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+			createInfo.pNext = &timelineFeatures;
+		}
+
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		// These 2 fields enabledLayerCount and ppEnabledLayerNames are ignored by up-to-date implementation
 		//  of Vulkan, but it's still a good idea to set them for backward compatibility.
@@ -512,6 +733,13 @@ private:
 
 	void createSwapChain()
 	{
+		PROFILE_SCOPE("createSwapChain");
+
+		if (mOptions.headless) {
+			createOffscreenTargets();
+			return;
+		}
+
 		// Should these info be cached somewhere so we don't need to query this info every time
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
@@ -556,6 +784,10 @@ private:
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;	// Clipping for better performance, we don't care about obscured pixels.
 
+		// When recreating, hand over the retired swap chain so presentation can continue while it drains. It is
+		//  destroyed later through the deletion queue.
+		createInfo.oldSwapchain = swapChain;
+
 		// Actually create the swap chain
 		if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
 			throw std::runtime_error("[ERROR] Failed to create swap chain!");
@@ -568,6 +800,32 @@ private:
 
 		swapChainImageFormat = surfaceFormat.format;
 		swapChainExtent = extent;
+
+		// The update thread builds the projection from these
+		mViewportWidth.store(extent.width, std::memory_order_relaxed);
+		mViewportHeight.store(extent.height, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Headless stand-in for the swap chain. The offscreen images take the place of the swap chain images, so
+	 *  image views, framebuffers, descriptor sets and everything else sized by the image count work unchanged.
+	 */
+	void createOffscreenTargets()
+	{
+		mpOffscreenTargets.resize(OFFSCREEN_IMAGE_COUNT);
+		swapChainImages.resize(OFFSCREEN_IMAGE_COUNT);
+
+		for (uint32_t i = 0; i < OFFSCREEN_IMAGE_COUNT; ++i) {
+			mpOffscreenTargets[i] = std::make_shared<VulkanOffscreenTarget>();
+			mpOffscreenTargets[i]->lazyInit(physicalDevice, device, mOffscreenExtent.width, mOffscreenExtent.height, OFFSCREEN_IMAGE_FORMAT);
+			swapChainImages[i] = mpOffscreenTargets[i]->getImage();
+		}
+
+		swapChainImageFormat = OFFSCREEN_IMAGE_FORMAT;
+		swapChainExtent = mOffscreenExtent;
+
+		mViewportWidth.store(swapChainExtent.width, std::memory_order_relaxed);
+		mViewportHeight.store(swapChainExtent.height, std::memory_order_relaxed);
 	}
 
 	void createImageViewsForSwapChain()
@@ -587,6 +845,8 @@ private:
 	 */
 	void createRenderPass()
 	{
+		PROFILE_SCOPE("createRenderPass");
+
 		// Have a single color buffer attachment represented by one of the images from the swap chain
 		VkAttachmentDescription colorAttachment{};
 		colorAttachment.format = swapChainImageFormat;
@@ -596,12 +856,17 @@ private:
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;		// We don't care what previous layout the image was in
 		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;	// We want the image to be ready for presentation using the swap chain after rendering
 
+		// Offscreen images are never presented, only copied back to the host
+		if (mOptions.headless) {
+			colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		}
+
 		// Every subpass references one or more attachments with VkAttachmentReference struct
 		VkAttachmentReference colorAttachmentRef{};
 		colorAttachmentRef.attachment = 0;	// Directly referenced "layout(location = 0) out vec4 outColor" directive in the fragment shader
 		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;	// We intend to use attachment as a color buffer
 
-		VkAttachmentReference depthAttachmentReference = mDepthResources.getDepthAttachmentReference();
+		VkAttachmentReference depthAttachmentReference = mpDepthResources->getDepthAttachmentReference();
 
 		VkSubpassDescription subpass{};
 		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
@@ -617,199 +882,204 @@ private:
 		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, mDepthResources.getDepthAttachmentDescription(physicalDevice) };
+		std::vector<VkSubpassDependency> dependencies = { dependency };
+
+		// Offscreen images are copied back to the host after the pass, so its color writes have to be made visible to the copy
+		if (mOptions.headless) {
+			VkSubpassDependency readbackDependency{};
+			readbackDependency.srcSubpass = 0;
+			readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+			readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			dependencies.push_back(readbackDependency);
+		}
+
+		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, mpDepthResources->getDepthAttachmentDescription(physicalDevice) };
 		VkRenderPassCreateInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
 
 		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error("[ERROR] Failed to create render pass!");
 		}
 	}
 
-	// Create and bind descriptors for ubo and sampler
-	void createDescriptorSetLayout()
+	/**
+	 * Load the SPIR-V of both stages through the shader library and reflect their interface, which the descriptor set layout, the
+	 *  pipeline layout and the vertex input state are all built from.
+	 */
+	void loadShaders()
 	{
-		VkDescriptorSetLayoutBinding uboLayoutBinding{};
-		uboLayoutBinding.binding = 0; // Should match the descriptor in the vertex shader
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Type of descriptor is ubo
-		uboLayoutBinding.descriptorCount = 1; // Number of values in the array; we can bind an array of ubo's
-		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Vertex shader stage is going to reference this descriptor
-		uboLayoutBinding.pImmutableSamplers = nullptr; // For image sampling related descriptor
-
-		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-		samplerLayoutBinding.binding = 1;
-		samplerLayoutBinding.descriptorCount = 1;
-		samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
-		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Intend to use sampler descriptor in fragment shader
+		PROFILE_SCOPE("loadShaders");
 
-		std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+		mVertShaderPath = getShaderPath(VERT_SHADER_BINARY);
+		mFragShaderPath = getShaderPath(FRAG_SHADER_BINARY);
 
-		// All descriptor bindings are combined into a single VkDescriptorSetLayout
-		VkDescriptorSetLayoutCreateInfo layoutInfo{};
-		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-		layoutInfo.pBindings = bindings.data();
-
-		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &mDescriptorSetLayout) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to create descriptor set layout!");
-		}
+		// Preloaded right after device creation, this normally only waits for the worker to finish
+		mShaderReflection = reflectShaders(mVertShaderPath, mFragShaderPath);
 	}
 
 	/**
-	 * Descriptor sets can't be created directly, they must be allocated from a pool like command buffers.
+	 * The CPU side only has to agree with the shaders where it writes data itself, so that is checked here rather than left
+	 *  to the validation layers. Only reads the shader library and the texture registry's capacity, so the shader hot reload
+	 *  can call this from its worker thread.
 	 */
-	void createDescriptorPool()
+	ShaderReflection reflectShaders(const std::string &vertShaderPath, const std::string &fragShaderPath)
 	{
-		// Describe which descriptor types our descriptor sets are going to contain and how many
-		std::array <VkDescriptorPoolSize, 2> poolSizes{};
+		const SpirvCode &vertShaderCode = mShaderLibrary.getCode(vertShaderPath);
+		const SpirvCode &fragShaderCode = mShaderLibrary.getCode(fragShaderPath);
 
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
+		ShaderReflection reflection = ShaderReflection::reflect(vertShaderCode.pWords, vertShaderCode.wordCount);
+		reflection.merge(ShaderReflection::reflect(fragShaderCode.pWords, fragShaderCode.wordCount));
 
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
+		// The texture array's size is the specialization constant with constant_id = 0, see buildGraphicsPipeline
+		reflection.specialize(0, mTextureRegistry.getCapacity());
 
-		// Allocate one descriptor for every frame
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(swapChainImages.size()); // Specify the max number of descriptor sets may be allocated
+		if (reflection.getSetCount() != 1) {
+			throw std::runtime_error("[ERROR] The shaders must use exactly one descriptor set!");
+		}
 
-		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to create descriptor pool!");
+		if (!reflection.coversPushConstants(
+				VK_SHADER_STAGE_VERTEX_BIT, DRAW_PUSH_CONSTANTS_VERTEX_OFFSET, DRAW_PUSH_CONSTANTS_VERTEX_SIZE) ||
+			!reflection.coversPushConstants(
+				VK_SHADER_STAGE_FRAGMENT_BIT, DRAW_PUSH_CONSTANTS_FRAGMENT_OFFSET, DRAW_PUSH_CONSTANTS_FRAGMENT_SIZE)) {
+			throw std::runtime_error("[ERROR] The shaders' push constant blocks don't match DrawPushConstants!");
 		}
+
+		return reflection;
+	}
+
+	// Create descriptors for the texture array as the shaders declare it. The layout cache hands back the same layout for equal bindings.
+	void createDescriptorSetLayout()
+	{
+		mLayoutCache.lazyInit(device);
+
+		mDescriptorSetLayout = mLayoutCache.getDescriptorSetLayout(mShaderReflection.getDescriptorSetLayoutDescription(0));
 	}
 
 	/**
-	 * After a descriptor pool is created, we can go ahead and allocate the descriptor sets. We are
-	 *  going to create one descriptor set for each swap chain image, with the same layout. Need to store
-	 *  all copies of the same layout in one array because the function expects an array matching the
-	 *  number of sets.
-	 *
-	 * We don't need to explicitly clean up descriptor sets because they are freed when the descriptor pool
-	 *  is destroyed.
+	 * Descriptor sets can't be created directly, they must be allocated from a pool like command buffers. The
+	 *  allocator chains as many pools as needed, each sized for sets like ours: whatever the shaders bind, which
+	 *  is the texture array.
 	 */
-	void createDescriptorSets()
+	void createDescriptorAllocator()
 	{
-		std::vector<VkDescriptorSetLayout> layouts(swapChainImages.size(), mDescriptorSetLayout);
-		VkDescriptorSetAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = mDescriptorPool; // Descriptor pool to allocate the sets from
-		allocInfo.descriptorSetCount = static_cast<uint32_t>(swapChainImages.size()); // Number of sets to allocate
-		allocInfo.pSetLayouts = layouts.data(); // Descriptor layout to base the sets on
-
-		mDescriptorSets.resize(swapChainImages.size());
+		// Describe which descriptor types our descriptor sets are going to contain and how many
+		std::vector<VkDescriptorPoolSize> descriptorsPerSet;
 
-		if (vkAllocateDescriptorSets(device, &allocInfo, mDescriptorSets.data()) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to allocate descriptor sets!");
+		for (const ShaderDescriptorBinding &binding : mShaderReflection.descriptorBindings) {
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = binding.type;
+			poolSize.descriptorCount = binding.descriptorCount;
+			descriptorsPerSet.push_back(poolSize);
 		}
 
-		// Allocated sets still need to be populated/configured
-		for (size_t i = 0; i < swapChainImages.size(); ++i) {
-			// Info about the buffer object that descriptor refers to
-			VkDescriptorBufferInfo bufferInfo{};
-			bufferInfo.buffer = mpUniformBuffers[i]->getBufferHandle();
-			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(UniformBufferObject);
-
-			// Info about the image that descriptor refers to
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = mTexture.getTextureImageView();
-			imageInfo.sampler = mTexture.getTextureSampler();
-
-			// Tell Vulkan driver how configuration of descriptors is updated
-			std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-
-			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[0].dstSet = mDescriptorSets[i]; // Specify descriptor set to update
-			descriptorWrites[0].dstBinding = 0;
-			descriptorWrites[0].dstArrayElement = 0; // First index in the descriptor array to update; our descriptors aren't array
-			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Specify this descriptor refers to ubo
-			descriptorWrites[0].descriptorCount = 1; // How many descriptor want to update
-			descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[1].dstSet = mDescriptorSets[i];
-			descriptorWrites[1].dstBinding = 1;
-			descriptorWrites[1].dstArrayElement = 0;
-			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWrites[1].descriptorCount = 1;
-			descriptorWrites[1].pImageInfo = &imageInfo;
-
-			// Apply the update
-			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-		}
+		mDescriptorAllocator.lazyInit(device, descriptorsPerSet);
 	}
 
 	/**
-	 * Simple helper function to load in the SPIR-V bytecode generated from the shaders
+	 * Every draw reads the camera from its push constants, so one descriptor set holding the texture array serves
+	 *  every frame. It is taken from the allocator the first time a frame is rendered after the set was last
+	 *  retired, i.e. after start up and texture changes.
+	 *
+	 * We don't need to explicitly clean up descriptor sets because they are freed when their descriptor pool
+	 *  is reset or destroyed.
 	 */
-	static std::vector<char> readFile(const std::string &filename)
+	void resetDescriptorSet()
+	{
+		mDescriptorSet = VK_NULL_HANDLE;
+	}
+
+	VkDescriptorSet acquireDescriptorSet()
 	{
-		// We read from the end of the file, indicated by std::ios::ate.
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
+		PROFILE_SCOPE("acquireDescriptorSet");
 
-		if (!file.is_open()) {
-			throw std::runtime_error("[ERROR] Failed to open file!");
-		}
+		DescriptorSetDescription description;
+		description.layout = mDescriptorSetLayout;
 
-		// We read from end of file so that we can use the read position to determine the
-		//  size of the file and allocate a buffer.
-		size_t fileSize = (size_t) file.tellg();
-		std::vector<char> buffer(fileSize);
+		// Every slot of the texture array, with empty slots pointing at a fallback texture
+		description.bindImages(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mTextureRegistry.getImageInfos());
 
-		// Seek back at the beginning of the file and read all of the bytes all of the bytes at once
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
+		return mDescriptorAllocator.getDescriptorSet(description);
+	}
 
-		file.close();
+	// SPIR-V is compiled into the build tree by CMake builds, and checked in next to the sources for the Visual Studio project
+	static std::string getShaderPath(const char *fileName)
+	{
+#ifdef VULKAN_RENDERER_SHADER_DIR
+		return std::string(VULKAN_RENDERER_SHADER_DIR) + fileName;
+#else
+		return getShaderSourcePath(fileName);
+#endif
+	}
 
-		return buffer;
+	static std::string getShaderSourcePath(const char *fileName)
+	{
+		return std::string(resource_dir) + "shaders/" + fileName;
 	}
 
 	/**
-	 * SPIR-V bytecode must be wrapped in a VkShaderModule object before being passed to the
-	 *  graphics pipeline.
+	 * SPIR-V bytecode must be wrapped in a VkShaderModule object before being passed to the graphics pipeline.
+	 *  Mapping the files and creating the modules is done as soon as there is a device, on worker threads, and
+	 *  only once: the library keeps the modules for every later pipeline build. Shaders embedded in the executable
+	 *  are added under the paths they would otherwise be loaded from, so no file is read.
 	 */
-	VkShaderModule createShaderModule(const std::vector<char> &code)
+	void createShaderLibrary()
 	{
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
+		mShaderLibrary.lazyInit(device);
 
-		// Reinterpret cast from char pointer to an uint32_t pointer. Data stored in a std::vector
-		//  default allocator already takes care of data alignment requirements of uint32_t.
-		createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+#ifdef VULKAN_RENDERER_EMBEDDED_SHADERS
+		for (const EmbeddedShader &shader : EMBEDDED_SHADERS) {
+			mShaderLibrary.addEmbedded(getShaderPath(shader.fileName), shader.pWords, shader.wordCount);
+		}
+#else
+		mShaderLibrary.preload({ getShaderPath(VERT_SHADER_BINARY), getShaderPath(FRAG_SHADER_BINARY) });
+#endif
+	}
 
-		VkShaderModule shaderModule;
-		if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to create shader module!");
+	void createGraphicsPipeline()
+	{
+		PROFILE_SCOPE("createGraphicsPipeline");
+
+		// Pipeline layout, used to specify uniform values. It comes from the layout cache, so a recreated pipeline
+		//  keeps the layout the descriptor sets were bound with.
+		PipelineLayoutDescription layoutDescription;
+		layoutDescription.addSetLayout(mDescriptorSetLayout); // Specify the descriptor set layout for fragment shader to use the texture array
+
+		// Per-draw model view projection matrix for the vertex shader and material index for the fragment shader,
+		//  with the ranges each stage's push constant block declares
+		for (const VkPushConstantRange &range : mShaderReflection.pushConstantRanges) {
+			layoutDescription.addPushConstantRange(range.stageFlags, range.offset, range.size);
 		}
 
-		return shaderModule;
+		pipelineLayout = mLayoutCache.getPipelineLayout(layoutDescription);
+
+		graphicsPipeline = buildGraphicsPipeline(
+			mVertShaderPath, mFragShaderPath, mShaderReflection, renderPass, swapChainExtent, pipelineLayout);
 	}
 
 	/**
-	 * The loading and linking of SPIR-V bytecode for execution on the GPU.
-	 * Creates shader modules for vertex shader stage and fragment shader stage, then creates
+	 * The linking of SPIR-V bytecode for execution on the GPU.
+	 * Takes the shader modules for vertex shader stage and fragment shader stage from the library, then creates
 	 *  the pipeline shader stages, finally assigns the shader stages to a pipeline stage.
+	 *
+	 * Everything that depends on the swap chain is passed in, so the shader hot reload can build pipelines on its
+	 *  worker thread.
 	 */
-	void createGraphicsPipeline()
+	VkPipeline buildGraphicsPipeline(
+		const std::string &vertShaderPath, const std::string &fragShaderPath, const ShaderReflection &reflection,
+		VkRenderPass targetRenderPass, VkExtent2D extent, VkPipelineLayout layout)
 	{
-		std::vector<char> vertShaderCode = readFile(std::string(resource_dir) + "shaders/vert.spv");
-		std::vector<char> fragShaderCode = readFile(std::string(resource_dir) + "shaders/frag.spv");
-
-		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+		// Owned by the shader library, which created them once for every pipeline build
+		VkShaderModule vertShaderModule = mShaderLibrary.getShaderModule(vertShaderPath);
+		VkShaderModule fragShaderModule = mShaderLibrary.getShaderModule(fragShaderPath);
 
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
 		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -817,11 +1087,26 @@ private:
 		vertShaderStageInfo.module = vertShaderModule;
 		vertShaderStageInfo.pName = "main"; // Function to invoke in the shader, a.k.a the entrypoint
 
+		// The size of the texture array in the fragment shader is a specialization constant (constant_id = 0)
+		uint32_t textureArraySize = mTextureRegistry.getCapacity();
+
+		VkSpecializationMapEntry textureArraySizeEntry{};
+		textureArraySizeEntry.constantID = 0;
+		textureArraySizeEntry.offset = 0;
+		textureArraySizeEntry.size = sizeof(textureArraySize);
+
+		VkSpecializationInfo fragSpecializationInfo{};
+		fragSpecializationInfo.mapEntryCount = 1;
+		fragSpecializationInfo.pMapEntries = &textureArraySizeEntry;
+		fragSpecializationInfo.dataSize = sizeof(textureArraySize);
+		fragSpecializationInfo.pData = &textureArraySize;
+
 		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
 		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		fragShaderStageInfo.module = fragShaderModule;
 		fragShaderStageInfo.pName = "main";
+		fragShaderStageInfo.pSpecializationInfo = &fragSpecializationInfo;
 
 		VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
@@ -829,8 +1114,11 @@ private:
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
+		// Only the attributes the vertex shader reads, as it reads them
 		VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
-		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = Vertex::getAttributeDescriptions();
+		std::array<VkVertexInputAttributeDescription, 3> vertexAttributes = Vertex::getAttributeDescriptions();
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions =
+			reflection.selectVertexAttributes(vertexAttributes.data(), vertexAttributes.size());
 
 		vertexInputInfo.vertexBindingDescriptionCount = 1;
 		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
@@ -849,15 +1137,15 @@ private:
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
-		viewport.width = (float)swapChainExtent.width;
-		viewport.height = (float)swapChainExtent.height;
+		viewport.width = (float)extent.width;
+		viewport.height = (float)extent.height;
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
 
 		// Set the scissor rectangle to cover the entire framebuffer so the rasterizer doesn't discard anything
 		VkRect2D scissor{};
 		scissor.offset = {0, 0};
-		scissor.extent = swapChainExtent;
+		scissor.extent = extent;
 
 		VkPipelineViewportStateCreateInfo viewportState{};
 		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -920,18 +1208,6 @@ private:
 		colorBlending.blendConstants[2] = 0.0f;
 		colorBlending.blendConstants[3] = 0.0f;
 
-		// Create pipeline layout object. Used to specify uniform values
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &mDescriptorSetLayout; // Specify the descriptor set layout for vertex shader to use ubo
-		pipelineLayoutInfo.pushConstantRangeCount = 0;
-		pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to create pipeline layout!");
-		}
-
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		pipelineInfo.stageCount = 2;
@@ -944,29 +1220,236 @@ private:
 		pipelineInfo.pDepthStencilState = &depthStencil;
 		pipelineInfo.pColorBlendState = &colorBlending;
 		pipelineInfo.pDynamicState = nullptr; // In case you want to change some values during rendering, extremely limited
-		pipelineInfo.layout = pipelineLayout;
-		pipelineInfo.renderPass = renderPass;
+		pipelineInfo.layout = layout;
+		pipelineInfo.renderPass = targetRenderPass;
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Vulkan allows creation of new pipeline derived from existing pipeline
 		pipelineInfo.basePipelineIndex = -1;
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("[ERROR] Failed to create graphics pipeline!");
 		}
 
-		vkDestroyShaderModule(device, fragShaderModule, nullptr);
-		vkDestroyShaderModule(device, vertShaderModule, nullptr);
+		return pipeline;
+	}
+
+	/**
+	 * Shader hot reloading, with --watch-shaders. Saving either shader source compiles both again and builds a new pipeline
+	 *  on a worker thread, while frames keep being rendered with the current one. The new pipeline takes over between two
+	 *  frames. Sources that don't compile, or whose interface no longer fits the pipeline layout, keep the current pipeline.
+	 *  Every reload runs on the same worker, started by the first one.
+	 */
+	void createShaderWatcher()
+	{
+		if (!mOptions.watchShaders) {
+			return;
+		}
+
+		mShaderWatcher.lazyInit(getShaderSourcePath(""), { VERT_SHADER_SOURCE, FRAG_SHADER_SOURCE });
+		std::cout << "[INFO] Watching " << getShaderSourcePath("") << " for shader changes, compiling with "
+			<< shadercompiler::getCompilerPath() << std::endl;
+	}
+
+	// Called between frames: takes over a finished reload, and starts one for sources saved since the last
+	void updateShaderReload()
+	{
+		if (!mOptions.watchShaders) {
+			return;
+		}
+
+		if (!mShaderWatcher.poll().empty()) {
+			mShaderSourcesChanged = true;
+		}
+
+		if (mShaderReload.valid() && mShaderReload.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			applyShaderReload(mShaderReload.get());
+		}
+
+		// Saves during a reload are picked up by the next one
+		if (mShaderSourcesChanged && !mShaderReload.valid()) {
+			mShaderSourcesChanged = false;
+
+			uint32_t generation = ++mShaderReloadCount;
+			VkRenderPass currentRenderPass = renderPass;
+			VkExtent2D extent = swapChainExtent;
+			VkPipelineLayout layout = pipelineLayout;
+			ShaderReflection currentReflection = mShaderReflection;
+
+			std::packaged_task<ShaderReload()> task([this, generation, currentRenderPass, extent, layout, currentReflection]() {
+				return reloadShaders(generation, currentRenderPass, extent, layout, currentReflection);
+			});
+			mShaderReload = task.get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(mShaderReloadMutex);
+				mShaderReloadTask = std::move(task);
+			}
+
+			if (!mShaderReloadThread.joinable()) {
+				mStopShaderReloadThread = false;
+				mShaderReloadThread = std::thread(&HelloTriangleApplication::shaderReloadLoop, this);
+			} else {
+				mShaderReloadCondition.notify_one();
+			}
+		}
+	}
+
+	void shaderReloadLoop()
+	{
+		CpuProfiler::get().setThreadName("Shader reload");
+
+		while (true) {
+			std::packaged_task<ShaderReload()> task;
+			{
+				std::unique_lock<std::mutex> lock(mShaderReloadMutex);
+				mShaderReloadCondition.wait(lock, [this] { return mStopShaderReloadThread || mShaderReloadTask.valid(); });
+
+				// A reload submitted before the stop still runs, so finishShaderReload never waits on it forever
+				if (!mShaderReloadTask.valid()) {
+					return;
+				}
+
+				task = std::move(mShaderReloadTask);
+			}
+
+			task();
+		}
+	}
+
+	void stopShaderReloadThread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mShaderReloadMutex);
+			mStopShaderReloadThread = true;
+		}
+		mShaderReloadCondition.notify_one();
+
+		if (mShaderReloadThread.joinable()) {
+			mShaderReloadThread.join();
+		}
+	}
+
+	/**
+	 * Runs on the shader reload worker. The render pass and the pipeline layout it builds against stay alive until the
+	 *  reload is finished, see finishShaderReload. Each reload compiles to files of its own, as the shader library keeps
+	 *  the current pipeline's files mapped until they are replaced.
+	 */
+	ShaderReload reloadShaders(
+		uint32_t generation, VkRenderPass targetRenderPass, VkExtent2D extent, VkPipelineLayout layout,
+		const ShaderReflection &currentReflection)
+	{
+		PROFILE_SCOPE("reloadShaders");
+
+		ShaderReload reload;
+
+		try {
+			std::filesystem::path outputDirectory = std::filesystem::temp_directory_path() / "VulkanRenderer";
+			std::filesystem::create_directories(outputDirectory);
+
+			std::string suffix = "." + std::to_string(generation) + ".spv";
+			reload.vertShaderPath = (outputDirectory / (VERT_SHADER_SOURCE + suffix)).string();
+			reload.fragShaderPath = (outputDirectory / (FRAG_SHADER_SOURCE + suffix)).string();
+
+			if (!shadercompiler::compileGlsl(getShaderSourcePath(VERT_SHADER_SOURCE), reload.vertShaderPath, reload.log) ||
+				!shadercompiler::compileGlsl(getShaderSourcePath(FRAG_SHADER_SOURCE), reload.fragShaderPath, reload.log)) {
+				return reload;
+			}
+
+			reload.reflection = reflectShaders(reload.vertShaderPath, reload.fragShaderPath);
+
+			// The descriptor sets and push constants are laid out for the current interface
+			if (!reload.reflection.hasSameLayoutAs(currentReflection)) {
+				reload.log += "[ERROR] The shaders' descriptor bindings or push constants changed, restart to apply them!\n";
+				return reload;
+			}
+
+			reload.pipeline = buildGraphicsPipeline(
+				reload.vertShaderPath, reload.fragShaderPath, reload.reflection, targetRenderPass, extent, layout);
+			reload.succeeded = true;
+		} catch (const std::exception &thrownException) {
+			reload.log += std::string(thrownException.what()) + "\n";
+		}
+
+		return reload;
+	}
+
+	void applyShaderReload(ShaderReload reload)
+	{
+		if (!reload.log.empty()) {
+			std::cout << reload.log;
+		}
+
+		if (!reload.succeeded) {
+			// No pipeline was built from this reload's files, so they can go right away
+			removeReloadedShaders(reload.vertShaderPath, reload.fragShaderPath);
+
+			std::cout << "[WARNING] Shader reload failed, keeping the current pipeline" << std::endl;
+			return;
+		}
+
+		// Frames submitted so far were recorded with the current pipeline
+		VkDevice logicalDevice = device;
+		VkPipeline oldPipeline = graphicsPipeline;
+		mDeletionQueue.push(mFrameSync.getSubmittedValue(), [=]() {
+			vkDestroyPipeline(logicalDevice, oldPipeline, nullptr);
+		});
+
+		// The files shipped with the renderer stay, a previous reload's go with the pipeline built from them
+		if (mShadersReloaded) {
+			std::string oldVertShaderPath = mVertShaderPath;
+			std::string oldFragShaderPath = mFragShaderPath;
+			mDeletionQueue.push(mFrameSync.getSubmittedValue(), [this, oldVertShaderPath, oldFragShaderPath]() {
+				removeReloadedShaders(oldVertShaderPath, oldFragShaderPath);
+			});
+		}
+
+		graphicsPipeline = reload.pipeline;
+		mVertShaderPath = std::move(reload.vertShaderPath);
+		mFragShaderPath = std::move(reload.fragShaderPath);
+		mShaderReflection = std::move(reload.reflection);
+		mShadersReloaded = true;
+
+		std::cout << "[INFO] Shaders reloaded" << std::endl;
+	}
+
+	/**
+	 * Wait for a reload still running, before the render pass it builds against is retired. Its pipeline is taken over
+	 *  like any other, so a recreated swap chain gets a pipeline built from the reloaded shaders.
+	 */
+	void finishShaderReload()
+	{
+		if (mShaderReload.valid()) {
+			applyShaderReload(mShaderReload.get());
+		}
+	}
+
+	// Unmapped before they are deleted, Windows doesn't delete files that are still mapped
+	void removeReloadedShaders(const std::string &vertShaderPath, const std::string &fragShaderPath)
+	{
+		for (const std::string &path : { vertShaderPath, fragShaderPath }) {
+			if (path.empty()) {
+				continue;
+			}
+
+			mShaderLibrary.remove(path);
+
+			std::error_code error;
+			std::filesystem::remove(path, error); // A reload that failed to compile may not have written it
+		}
 	}
 
 	void createFramebuffers()
 	{
+		PROFILE_SCOPE("createFramebuffers");
+
 		swapChainFramebuffers.resize(swapChainImageViews.size());
 
 		for (size_t i = 0; i < swapChainImageViews.size(); ++i) {
 
 			std::array<VkImageView, 2> attachments = {
 				swapChainImageViews[i],
-				mDepthResources.getImageView()
+				mpDepthResources->getImageView()
 			};
 
 			VkFramebufferCreateInfo framebufferInfo{};
@@ -994,7 +1477,7 @@ private:
 		VkCommandPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();	// We record commands for drawing
-		poolInfo.flags = 0;	// We only record command buffers at the beginning of the program and execute them many times in the main loop
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;	// Command buffers are recorded again every frame from the frame packet
 
 		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
 			throw std::runtime_error("[ERROR] Failed to create command pool!");
@@ -1003,155 +1486,88 @@ private:
 
 	void createDepthResources()
 	{
-		mDepthResources.lazyInit(physicalDevice, device, commandPool, graphicsQueue, swapChainExtent.width, swapChainExtent.height);
+		mpDepthResources->lazyInit(physicalDevice, device, commandPool, graphicsQueue, swapChainExtent.width, swapChainExtent.height);
 	}
 
-	void loadTexture(std::string textureDir)
+	void createTextureStreamer()
 	{
-		mTexture.lazyInit(textureDir, physicalDevice, device, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, commandPool, graphicsQueue);
+		PROFILE_SCOPE("createTextureStreamer");
+
+		mSamplerCache.lazyInit(physicalDevice, device);
+
+		mTextureStreamer.lazyInit(
+			physicalDevice, device, commandPool, graphicsQueue, &mSamplerCache, &mDeletionQueue,
+			TEXTURE_MEMORY_BUDGET, TEXTURE_INITIAL_RESIDENT_EXTENT);
 	}
 
-	void loadModel(std::string modelDir)
+	void createTextureRegistry()
 	{
-		mMesh.lazyInit(modelDir, physicalDevice, device);
+		mTextureRegistry.lazyInit(physicalDevice, MAX_BINDLESS_TEXTURES, mDynamicTextureIndexing);
 	}
 
-	/**
-	 * Memory transfer between buffers requires command buffers, similar to drawing commands. Here,
-	 *  we must allocate a temporary command buffer. To optimize, a seperate command pool can be
-	 *  created for these short-lived command buffers.
-	 */
-	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+	void loadTexture(std::string textureDir)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
+		PROFILE_SCOPE("loadTexture");
+
+		uint32_t textureHandle = mTextureStreamer.addTexture(textureDir);
+		mTextureHandles.push_back(textureHandle);
+		mMaterialIndices.push_back(mTextureRegistry.registerTexture(&mTextureStreamer.getTexture(textureHandle)));
+	}
 
-		VkBufferCopy copyRegion{};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = size;	// Size of the buffer being copied
-		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+	void loadModel(std::string modelDir)
+	{
+		PROFILE_SCOPE("loadModel");
 
-		endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+		mMeshes.emplace_back();
+		mMeshes.back().lazyInit(modelDir, physicalDevice, device);
 	}
 
 	/**
-	 * This function utilizes a staging buffer to transfer the data from the CPU to an actual vertex buffer on
-	 *  the GPU. The reason for this because the vertex buffer would be allocated with a memory type that would
-	 *  be optimal for the graphics card to access (with VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT flag); however,
-	 *  this memory type is not accessible by the CPU. The staging buffer does have access to said memory type.
-	 *
-	 * The function is going to first create 2 buffers: a staging buffer and a vertex buffer. Pay attention to the
-	 *  VkMemoryPropertyFlags. The staging buffer uses the GPU memory that is visible to the host (the CPU), whereas
-	 *  the vertex buffer uses the device's dedicated local memory (as mentioned before). Then, the vertex data are
-	 *  copied from the CPU to the staging buffer. Finally, the vertex data are copied from the staging buffer to
-	 *  the vertex buffer.
+	 * One node per drawn copy of the mesh. Benchmark scenarios draw it several times, cycling through the
+	 *  loaded textures; the copies share the same transform so the scenarios keep measuring the same work.
 	 */
-	void createVertexBuffer()
+	void buildScene()
 	{
-		std::vector<Vertex> vertices = mMesh.getVertices();
-
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-		/* To create our staging buffer, we request to use a memory heap that
-		    is host coherent to ensure that mapped memory always matches the contents of
-		    the allocated memory. With this approach, performance might suffer
-		    slightly compared to explicit flushing. However, this is just a staging buffer
-		    so the performance hit doesn't matter.
-		*/
-		VulkanBuffer stagingBuffer{
-			/* VkDevice = */ device,
-			/* VkPhysicalDevice = */ physicalDevice,
-			/* VkDeviceSize = */ bufferSize,
-			/* VkBufferUsageFlags = */ VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			/* VkMemoryPropertyFlags = */ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		};
+		mScene.clear();
 
-		mpVertexBuffer = std::make_shared<VulkanBuffer>(
-			/* VkDevice = */ device,
-			/* VkPhysicalDevice = */ physicalDevice,
-			/* VkDeviceSize = */ bufferSize,
-			/* VkBufferUsageFlags = */ VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			/* VkMemoryPropertyFlags = */ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
-
-		//====================== Copy the vertex data to the staging buffer ======================
-		void *data;
-		// Map memory to access a region of a specified memory resource with an offset and size
-		vkMapMemory(device, stagingBuffer.getMemoryHandle(), 0, bufferSize, 0, &data);
-			memcpy(data, vertices.data(), (size_t) bufferSize);
-		vkUnmapMemory(device, stagingBuffer.getMemoryHandle());
-
-		//================== Transfer data from staging buffer to vertex buffer ==================
-		copyBuffer(stagingBuffer.getBufferHandle(), mpVertexBuffer->getBufferHandle(), bufferSize);
-
-		// Clean up staging buffer
-		stagingBuffer.cleanUp();
+		for (uint32_t i = 0; i < std::max(mOptions.scenario.instanceCount, 1u); ++i) {
+			uint32_t node = mScene.addNode();
+			mScene.setMesh(node, 0);
+			mScene.setMaterial(node, mMaterialIndices[i % mMaterialIndices.size()], mTextureHandles[i % mTextureHandles.size()]);
+		}
 	}
 
-	void createIndexBuffer()
+	void createGeometryPool()
 	{
-		std::vector<uint32_t> indices = mMesh.getIndices();
-
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-		VulkanBuffer stagingBuffer{
-			device,
-			physicalDevice,
-			bufferSize,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		};
-
-		mpIndexBuffer = std::make_shared<VulkanBuffer>(
-			device,
-			physicalDevice,
-			bufferSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
-
-		void *data;
-		vkMapMemory(device, stagingBuffer.getMemoryHandle(), 0, bufferSize, 0, &data);
-			memcpy(data, indices.data(), (size_t) bufferSize);
-		vkUnmapMemory(device, stagingBuffer.getMemoryHandle());
-
-		copyBuffer(stagingBuffer.getBufferHandle(), mpIndexBuffer->getBufferHandle(), bufferSize);
-
-		stagingBuffer.cleanUp();
+		mGeometryPool.lazyInit(
+			physicalDevice, device, commandPool, graphicsQueue, &mDeletionQueue, GEOMETRY_POOL_VERTEX_CAPACITY, GEOMETRY_POOL_INDEX_CAPACITY);
 	}
 
 	/**
-	 * We should have multiple uniform buffers due to the asynchronous nature of frame rendering in Vulkan.
-	 *  For instance, if we only have 1 ubo, and there are multiple frames reading from it. We don't want
-	 *  to update the ubo after frame 4 has been rendered while frame 2 is still in flight (also, it seems
-	 *  like doing update per frame is a terrible idea for Vulkan because of how many frames can be rendered
-	 *  at the same time).
-	 *
-	 * So, we are going to have as many ubo's as swap chain images, or one ubo per swap chain image.
+	 * Every mesh goes into the shared geometry pool, which stages the data through host visible memory into
+	 *  device local buffers. Draws then only differ in their first index and vertex offset.
 	 */
-	void createUniformBuffers()
+	void uploadMeshes()
 	{
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+		PROFILE_SCOPE("uploadMeshes");
 
-		mpUniformBuffers.resize(swapChainImages.size());
+		mGeometryHandles.clear();
 
-		for (std::shared_ptr<VulkanBuffer> &pUniformBuffer : mpUniformBuffers) {
-			pUniformBuffer = std::make_shared<VulkanBuffer>(
-				device,
-				physicalDevice,
-				bufferSize,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-			);
+		for (const Mesh &mesh : mMeshes) {
+			mGeometryHandles.push_back(mGeometryPool.addGeometry(
+				mesh.getVertices(), mesh.getIndexData(), mesh.getIndexType(), mFrameSync.getSubmittedValue()));
 		}
 	}
 
 	/**
-	 * Allocate and record the commands for each swap chain image. This is also where the draw call happens.
+	 * Allocate one command buffer per frame in flight. They are recorded every frame from the frame packet,
+	 *  once the fence says the GPU is done with the previous recording.
 	 */
 	void createCommandBuffers()
 	{
-		commandBuffers.resize(swapChainFramebuffers.size());
+		PROFILE_SCOPE("createCommandBuffers");
+
+		commandBuffers.resize(mFrameSync.getFramesInFlight());
 
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1162,150 +1578,368 @@ private:
 		if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
 			throw std::runtime_error("[ERROR] Failed to allocate command buffers!");
 		}
+	}
+
+	/**
+	 * Record the draw list of a frame packet into a command buffer, rendering into the given swap chain image.
+	 *  This is also where the draw calls happen.
+	 */
+	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameSlot, uint32_t imageIndex, const FramePacket &packet)
+	{
+		PROFILE_SCOPE("recordCommandBuffer");
 
-		for (size_t i = 0; i < commandBuffers.size(); ++i) {
-			VkCommandBufferBeginInfo beginInfo{};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = 0;
-			beginInfo.pInheritanceInfo = nullptr;
+		vkResetCommandBuffer(commandBuffer, 0);
 
-			// Start the recording of command buffer
-			if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-				throw std::runtime_error("[ERROR] Failed to start recording command buffer!");
-			}
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Recorded again before the next submission
+		beginInfo.pInheritanceInfo = nullptr;
 
-			VkRenderPassBeginInfo renderPassInfo{};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassInfo.renderPass = renderPass;
-			renderPassInfo.framebuffer = swapChainFramebuffers[i]; // Specify attachments to bind, the color attachment
-			renderPassInfo.renderArea.offset = { 0, 0 };
-			renderPassInfo.renderArea.extent = swapChainExtent;
+		// Start the recording of command buffer
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("[ERROR] Failed to start recording command buffer!");
+		}
 
-			std::array<VkClearValue, 2> clearValues; 
-			clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f }; // Load operation for color attachment: we clear color with 100% opacity black
-			clearValues[1].depthStencil = { 1.0f, 0 };
+		// Query resets have to happen outside the render pass
+		mGpuProfiler.beginFrame(commandBuffer, frameSlot, mFrameCount);
+		mGpuProfiler.beginScope(commandBuffer, "Frame");
 
-			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-			renderPassInfo.pClearValues = clearValues.data();
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = renderPass;
+		renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex]; // Specify attachments to bind, the color attachment
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = swapChainExtent;
 
-			// Our render pass commands are embedded in the primary command buffer itself. No secondary command buffers.
-			vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		std::array<VkClearValue, 2> clearValues; 
+		clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f }; // Load operation for color attachment: we clear color with 100% opacity black
+		clearValues[1].depthStencil = { 1.0f, 0 };
 
-				vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassInfo.pClearValues = clearValues.data();
 
-				// Bind the vertex buffer to the graphic pipeline
-				VkBuffer vertexBuffers[] = { mpVertexBuffer->getBufferHandle() };
-				VkDeviceSize offsets[] = { 0 };
-				vkCmdBindVertexBuffers(commandBuffers[i], 0, 1, vertexBuffers, offsets);
+		mGpuProfiler.beginScope(commandBuffer, "Main pass");
 
-				// Bind index buffer
-				vkCmdBindIndexBuffer(commandBuffers[i], mpIndexBuffer->getBufferHandle(), 0, VK_INDEX_TYPE_UINT32);
+		// Our render pass commands are embedded in the primary command buffer itself. No secondary command buffers.
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-				// Bind the right descriptor set for each swap chain image to the descriptor in the shader
-				// We also specify that we bind this descriptor set to the graphics pipeline, as opposed to compute pipeline
-				vkCmdBindDescriptorSets(
-					commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &mDescriptorSets[i], 0, nullptr);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
-				// Draw using the index buffer
-				vkCmdDrawIndexed(commandBuffers[i], static_cast<uint32_t>(mMesh.getIndices().size()), 1, 0, 0, 0);
+			// Bind the geometry pool's vertex buffer to the graphic pipeline, every mesh lives in it
+			VkBuffer vertexBuffers[] = { mGeometryPool.getVertexBuffer() };
+			VkDeviceSize offsets[] = { 0 };
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+			// The index buffer is bound per index type, so usually just once
+			VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
 
-			vkCmdEndRenderPass(commandBuffers[i]);
+			// Bind the descriptor set to the descriptor in the shader
+			// We also specify that we bind this descriptor set to the graphics pipeline, as opposed to compute pipeline
+			vkCmdBindDescriptorSets(
+				commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &mDescriptorSet, 0, nullptr);
 
-			// End the recording of command buffer
-			if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-				throw std::runtime_error("[ERROR] Failed to end recording command buffer!");
+			for (const DrawItem &drawItem : packet.drawList) {
+				const GeometryAllocation &geometry = mGeometryPool.getAllocation(mGeometryHandles[drawItem.meshIndex]);
+
+				if (geometry.indexType != boundIndexType) {
+					vkCmdBindIndexBuffer(commandBuffer, mGeometryPool.getIndexBuffer(geometry.indexType), 0, geometry.indexType);
+					boundIndexType = geometry.indexType;
+				}
+
+				// The draw's transform, and its material in the bindless texture array
+				DrawPushConstants pushConstants{};
+				pushConstants.modelViewProj = drawItem.modelViewProj;
+				pushConstants.materialIndex = drawItem.materialIndex;
+
+				// Each range is pushed with exactly the stage that declared it
+				const char *pPushConstants = reinterpret_cast<const char *>(&pushConstants);
+				vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+					DRAW_PUSH_CONSTANTS_VERTEX_OFFSET, DRAW_PUSH_CONSTANTS_VERTEX_SIZE, pPushConstants + DRAW_PUSH_CONSTANTS_VERTEX_OFFSET);
+				vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+					DRAW_PUSH_CONSTANTS_FRAGMENT_OFFSET, DRAW_PUSH_CONSTANTS_FRAGMENT_SIZE, pPushConstants + DRAW_PUSH_CONSTANTS_FRAGMENT_OFFSET);
+
+				// Draw using the index buffer
+				vkCmdDrawIndexed(
+					commandBuffer, drawItem.indexCount, 1, geometry.firstIndex + drawItem.firstIndex, geometry.vertexOffset + drawItem.vertexOffset, 0);
 			}
+
+		vkCmdEndRenderPass(commandBuffer);
+
+		mGpuProfiler.endScope(commandBuffer); // Main pass
+		mGpuProfiler.endScope(commandBuffer); // Frame
+		mGpuProfiler.endFrame();
+
+		// End the recording of command buffer
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("[ERROR] Failed to end recording command buffer!");
 		}
 	}
 
 	/**
-	 * Create semaphores for all the frames, each frame should have its own set of semaphores.
-	 * Also create fences for CPU-GPU synchronization.
+	 * Create semaphores for all the frames, each frame should have its own set of semaphores. Swap chain
+	 *  acquisition and presentation only work with binary semaphores.
+	 * CPU-GPU synchronization goes through mFrameSync, which tracks one value per submitted frame.
 	 */
 	void createSyncObjects()
 	{
-		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-		imagesInFlight.resize(swapChainImages.size(), VK_NULL_HANDLE);
+		uint32_t framesInFlight = mFrameSync.getFramesInFlight();
+
+		imageAvailableSemaphores.resize(framesInFlight);
+		renderFinishedSemaphores.resize(framesInFlight);
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo{};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;	// Initialize the fence to signaled state for the very first frame to be drawn
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		for (size_t i = 0; i < framesInFlight; ++i) {
 			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
 				throw std::runtime_error("[ERROR] Failed to create synchronization objects for a frame!");
 			}
 		}
 	}
 
-	void updateUniformBuffer(uint32_t currentImage)
+	void createFrameSync()
+	{
+		mFrameSync.lazyInit(device, mTimelineSemaphoreEnabled, DEFAULT_FRAMES_IN_FLIGHT);
+	}
+
+	void createGpuProfiler()
+	{
+		QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+
+		mGpuProfiler.lazyInit(physicalDevice, device, indices.graphicsFamily.value(), mFrameSync.getFramesInFlight());
+		mGpuProfiler.setKeepingSamples(!mOptions.benchmarkPath.empty());
+	}
+
+	/**
+	 * Dump the scopes the profilers still remember to a Chrome trace, viewable in chrome://tracing or
+	 *  ui.perfetto.dev.
+	 */
+	void writeTrace()
+	{
+		ChromeTraceWriter writer;
+		CpuProfiler::get().appendTraceEvents(writer);
+		mGpuProfiler.appendTraceEvents(writer);
+		writer.write(TRACE_FILE_NAME);
+
+		std::cout << "[INFO] Wrote " << writer.getEventCount() << " trace events to " << TRACE_FILE_NAME << std::endl;
+	}
+
+	void destroySyncObjects()
+	{
+		for (size_t i = 0; i < imageAvailableSemaphores.size(); ++i) {
+			vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
+			vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
+		}
+
+		imageAvailableSemaphores.clear();
+		renderFinishedSemaphores.clear();
+	}
+
+	/**
+	 * Per-frame semaphores and command buffers are sized by the number of frames in flight, so they are
+	 *  rebuilt once everything submitted so far has retired. The device wait also covers presentation,
+	 *  which still waits on the old render finished semaphores.
+	 */
+	void setFramesInFlight(uint32_t framesInFlight)
+	{
+		vkDeviceWaitIdle(device);
+
+		mFrameSync.setFramesInFlight(framesInFlight);
+		mGpuProfiler.setFramesInFlight(mFrameSync.getFramesInFlight());
+
+		destroySyncObjects();
+		vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+
+		createSyncObjects();
+		createCommandBuffers();
+
+		std::cout << "[INFO] Frames in flight: " << mFrameSync.getFramesInFlight() << std::endl;
+	}
+
+	/**
+	 * Runs on the update thread. Everything the render thread needs for a frame is computed here and handed
+	 *  over in a frame packet, so scene updates overlap with recording and submission of the previous frame.
+	 */
+	FramePacket buildFramePacket(uint64_t frameIndex)
+	{
+		PROFILE_SCOPE("buildFramePacket");
+
+		// The swap chain may be recreated at any point, so read the extent the render thread last published
+		float viewportWidth = static_cast<float>(mViewportWidth.load(std::memory_order_relaxed));
+		float viewportHeight = static_cast<float>(std::max(mViewportHeight.load(std::memory_order_relaxed), 1u));
+
+		// Only recomputes the matrices when the camera moved or the viewport changed shape
+		mCamera.setLookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		mCamera.setPerspective(glm::radians(45.0f), viewportWidth / viewportHeight, 0.1f, 10.0f);
+		bool cameraChanged = mCamera.update();
+
+		FramePacket packet;
+		packet.frameIndex = frameIndex;
+		packet.cameraPosition = mCamera.getPosition();
+
+		// Pixels covered by one unit at a distance of one. The projection's Y scale is negated for Vulkan, hence the minus.
+		float pixelsPerUnitAtOne = 0.5f * -mCamera.getProj()[1][1] * viewportHeight;
+
+		uint32_t changedNodeCount = mScene.updateWorldTransforms();
+
+		const std::vector<uint32_t> &meshIndices = mScene.getMeshIndices();
+		const std::vector<glm::mat4> &worldTransforms = mScene.getWorldTransforms();
+		const std::vector<uint32_t> &materialIndices = mScene.getMaterialIndices();
+		const std::vector<uint32_t> &textureHandles = mScene.getTextureHandles();
+
+		// The model view projection matrices are kept from frame to frame. A new camera invalidates all of them and
+		//  they are redone in one batch, otherwise only nodes that moved are.
+		if (cameraChanged || mModelViewProjs.size() != mScene.getNodeCount()) {
+			mModelViewProjs.resize(mScene.getNodeCount());
+			mathutils::multiplyMatrices(mCamera.getViewProj(), worldTransforms.data(), mModelViewProjs.data(), mModelViewProjs.size());
+		} else if (changedNodeCount > 0) {
+			const std::vector<uint8_t> &worldChanged = mScene.getWorldChangedFlags();
+			for (uint32_t node = 0; node < mScene.getNodeCount(); ++node) {
+				if (worldChanged[node]) {
+					mathutils::multiplyMatrices(mCamera.getViewProj(), &worldTransforms[node], &mModelViewProjs[node], 1);
+				}
+			}
+		}
+
+		packet.drawList.reserve(mScene.getNodeCount());
+
+		for (uint32_t node = 0; node < mScene.getNodeCount(); ++node) {
+			if (meshIndices[node] == Scene::NO_MESH) {
+				continue;
+			}
+
+			const Mesh &mesh = mMeshes[meshIndices[node]];
+			const glm::mat4 &world = worldTransforms[node];
+
+			// The bounding sphere in world space, scaled by the largest axis scale to stay conservative
+			glm::vec3 boundingCenter = glm::vec3(world * glm::vec4(mesh.getBoundingCenter(), 1.0f));
+			float scale = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+			float boundingRadius = mesh.getBoundingRadius() * scale;
+			float distance = std::max(glm::length(packet.cameraPosition - boundingCenter), 0.001f);
+
+			// The mesh's nearest point may be much closer than its center, so measure the LOD error from there.
+			//  The error is in model units, hence the scale.
+			float nearestDistance = std::max(distance - boundingRadius, 0.001f);
+			uint32_t lodIndex = MeshSimplifier::selectLod(mesh.getLods(), scale * pixelsPerUnitAtOne / nearestDistance);
+
+			DrawItem drawItem{};
+			drawItem.meshIndex = meshIndices[node];
+			drawItem.modelViewProj = mModelViewProjs[node];
+			drawItem.materialIndex = materialIndices[node];
+			drawItem.textureHandle = textureHandles[node];
+
+			// The projected diameter of the bounding sphere, in pixels, tells the streamer which texture mips are visible
+			drawItem.screenSpacePixels = 2.0f * boundingRadius * pixelsPerUnitAtOne / distance;
+
+			for (const MeshSection &section : mesh.getSections(lodIndex)) {
+				drawItem.firstIndex = section.firstIndex;
+				drawItem.indexCount = section.indexCount;
+				drawItem.vertexOffset = section.vertexOffset;
+				packet.drawList.push_back(drawItem);
+			}
+		}
+
+		return packet;
+	}
+
+	/**
+	 * The update thread's loop. The packet queue holds FRAME_PACKET_QUEUE_DEPTH packets; once it is full the update
+	 *  thread is that many frames ahead of the render thread and waits for it, the same way the render thread
+	 *  waits on frame sync when it gets too far ahead of the GPU.
+	 */
+	void updateLoop()
 	{
-		static auto startTime = std::chrono::high_resolution_clock::now();
+		CpuProfiler::get().setThreadName("Update");
 
-		auto currentTime = std::chrono::high_resolution_clock::now();
-		float timeElasped = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+		uint64_t frameIndex = 0;
 
-		UniformBufferObject ubo{};
-		//ubo.model = glm::rotate(glm::mat4(1.0f), timeElasped * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.model = glm::mat4(1.0f);
-		ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 10.0f);
+		while (!mStopUpdateThread.load(std::memory_order_acquire)) {
+			FrameStageTimings::Clock::time_point updateStart = FrameStageTimings::Clock::now();
 
-		// glm was original made for OpenGL, where Y coordinate of the clip coordinates is inverted, we need to flip
-		//  this dimension for Vulkan
-		ubo.proj[1][1] *= -1; // We flip the sign on the scaling factor of the Y axis in the projection matrix
+			FramePacket packet = buildFramePacket(frameIndex);
+			packet.updateMilliseconds =
+				std::chrono::duration<double, std::milli>(FrameStageTimings::Clock::now() - updateStart).count();
+
+			// Closed by stopUpdateThread
+			if (!mFramePackets.push(packet)) {
+				return;
+			}
 
-		void *data;
-		vkMapMemory(device, mpUniformBuffers[currentImage]->getMemoryHandle(), 0, sizeof(ubo), 0, &data);
-			memcpy(data, &ubo, sizeof(ubo));
-		vkUnmapMemory(device, mpUniformBuffers[currentImage]->getMemoryHandle());
+			++frameIndex;
+		}
 	}
 
 	/**
 	 * (1) Acquire an image from the swap chain
-	 * (2) Execute the command buffer with acquired image as attachment in the framebuffer
+	 * (2) Record the frame packet's draw list and execute it with acquired image as attachment in the framebuffer
 	 * (3) Return the image to the swap chain for presentation
 	 *
 	 * Some sort of concurrency is implemented in this function, i.e. GPU-GPU synchronization is done with 2 semaphores,
-	 *  and CPU-GPU synchronization is done with fences.
+	 *  and CPU-GPU synchronization is done with the frame values of mFrameSync.
 	 * This function now can also detect if the current swap chain is either suboptimal or out-of-date. In the case of
 	 *  the swap chain being out-of-date, the current swap chain will be cleaned up and a new swap chain is created.
 	 */
-	void drawFrame()
+	void drawFrame(const FramePacket &packet)
 	{
-		// Wait for the previous command buffer from previous frame to finish executing
-		vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+		PROFILE_SCOPE("drawFrame");
+
+		using Clock = FrameStageTimings::Clock;
+
+		mFrameTimings.record(FrameStage::Update, packet.updateMilliseconds);
+
+		for (const DrawItem &drawItem : packet.drawList) {
+			mTextureStreamer.requestFootprint(drawItem.textureHandle, drawItem.screenSpacePixels, packet.frameIndex);
+		}
+
+		// Swap in texture mips that finished streaming since the last frame
+		if (mTextureStreamer.update(mFrameSync.getSubmittedValue())) {
+			refreshTextureBindings();
+		}
+
+		// Wait for the frame that last used this frame's semaphores and command buffer to finish executing
+		Clock::time_point stageStart = Clock::now();
+		uint32_t currentFrame = mFrameSync.beginFrame();
+		mFrameTimings.record(FrameStage::FenceWait, stageStart);
+
+		// Destroy whatever the GPU has finished with, and recycle the descriptor pools it no longer reads
+		mDeletionQueue.collect(mFrameSync.getCompletedValue());
+		mDescriptorAllocator.collect(mFrameSync.getCompletedValue());
 
 		//============================ (1) Acquire an image from the swap chain =======================
+		stageStart = Clock::now();
 		uint32_t imageIndex;
-		VkResult acquireImageResult = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-		// If vkAcquireNextImageKHR indicates that the current swap chain is out-of-date, a new swap chain will be created
-		if (acquireImageResult == VK_ERROR_OUT_OF_DATE_KHR) {
-			recreateSwapChain();
-			return;
-		} else if (acquireImageResult != VK_SUCCESS && acquireImageResult != VK_SUBOPTIMAL_KHR) {
-			throw std::runtime_error("[ERROR] Failed to acquire swap chain image!");
+		if (mOptions.headless) {
+			// Offscreen images are simply used in turn
+			imageIndex = static_cast<uint32_t>(mFrameCount % swapChainImages.size());
+		} else {
+			VkResult acquireImageResult = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+			// If vkAcquireNextImageKHR indicates that the current swap chain is out-of-date, a new swap chain will be created
+			if (acquireImageResult == VK_ERROR_OUT_OF_DATE_KHR) {
+				mFrameTimings.record(FrameStage::Acquire, stageStart);
+				recreateSwapChain();
+				return;
+			} else if (acquireImageResult != VK_SUCCESS && acquireImageResult != VK_SUBOPTIMAL_KHR) {
+				throw std::runtime_error("[ERROR] Failed to acquire swap chain image!");
+			}
 		}
+		mFrameTimings.record(FrameStage::Acquire, stageStart);
 
-		// At this point, we know what swap chain we are going to use, so we are going to update ubo
-		updateUniformBuffer(imageIndex);
+		// Check if a previous frame is still rendering to this image. Frame value 0 is always complete.
+		stageStart = Clock::now();
+		mFrameSync.wait(mImageFrameValues[imageIndex]);
+		mFrameTimings.record(FrameStage::FenceWait, stageStart);
 
-		// Check if a previous frame is using this image, i.e. there is its fence to wait on
-		if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
-			vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+		if (mDescriptorSet == VK_NULL_HANDLE) {
+			mDescriptorSet = acquireDescriptorSet();
 		}
-		// Mark the image as now being used by this frame
-		imagesInFlight[imageIndex] = inFlightFences[currentFrame];
 
-		//=== (2) Execute the command buffer with acquired image as attachment in the framebuffer =====
+		//=== (2) Record the draw list and execute it with acquired image as attachment in the framebuffer ===
+		stageStart = Clock::now();
+		recordCommandBuffer(commandBuffers[currentFrame], currentFrame, imageIndex, packet);
+		mFrameTimings.record(FrameStage::Record, stageStart);
+
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -1315,16 +1949,28 @@ private:
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+		submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
 		VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
 		submitInfo.signalSemaphoreCount = 1;	// Semaphore to signal when command buffer(s) have finished execution
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(device, 1, &inFlightFences[currentFrame]);	// Manually reset the fence to unsignaled state before using the fence
+		// There is no acquire to wait for and no presentation to signal
+		if (mOptions.headless) {
+			submitInfo.waitSemaphoreCount = 0;
+			submitInfo.signalSemaphoreCount = 0;
+		}
+
+		stageStart = Clock::now();
+		// Mark the image as now being used by this frame
+		mImageFrameValues[imageIndex] = mFrameSync.submit(graphicsQueue, submitInfo);
+		mFrameTimings.record(FrameStage::Submit, stageStart);
+
+		mLastImageIndex = imageIndex;
 
-		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-			throw std::runtime_error("[ERROR] Failed to submit draw command buffer!");
+		if (mOptions.headless) {
+			endFrame();
+			return;
 		}
 
 		//=================== (3) Return the image to the swap chain for presentation =================
@@ -1339,7 +1985,9 @@ private:
 		presentInfo.pImageIndices = &imageIndex;
 		presentInfo.pResults = nullptr;
 
+		stageStart = Clock::now();
 		VkResult presentImageResult = vkQueuePresentKHR(presentQueue, &presentInfo);
+		mFrameTimings.record(FrameStage::Present, stageStart);
 
 		// This is similar to step (1) with a small difference that even if the swap chain is suboptimal, we still recreate the swap chain because
 		//  we want the best possible result.
@@ -1350,36 +1998,97 @@ private:
 			throw std::runtime_error("[ERROR] Failed to present swap chain image!");
 		}
 
-		// Advance to next frame. Ensure the frame index loops around the array every MAX_FRAMES_IN_FLIGHT enqueued frames
-		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		endFrame();
 	}
 
-	void cleanupSwapChain()
+	void endFrame()
 	{
-		mDepthResources.cleanUp();
+		++mFrameCount;
 
-		for (VkFramebuffer &framebuffer : swapChainFramebuffers) {
-			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		// Frame time is measured end to end, so waits for the update thread and the GPU count as well
+		FrameStageTimings::Clock::time_point frameEnd = FrameStageTimings::Clock::now();
+		if (!mOptions.benchmarkPath.empty()) {
+			if (mFrameCount > mOptions.warmupFrames) {
+				mBenchmarkReport.addFrameTime(std::chrono::duration<double, std::milli>(frameEnd - mLastFrameEnd).count());
+			}
+			collectGpuSamples();
 		}
+		mLastFrameEnd = frameEnd;
 
-		vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-
-		vkDestroyPipeline(device, graphicsPipeline, nullptr);
-		vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-		vkDestroyRenderPass(device, renderPass, nullptr);
+		mFrameTimings.endFrame();
+		if (mFrameTimings.shouldReport()) {
+			std::cout << mFrameTimings.report() << std::endl;
+			std::cout << mGpuProfiler.report() << std::endl;
+		}
+	}
 
-		for (VkImageView &imageView : swapChainImageViews) {
-			vkDestroyImageView(device, imageView, nullptr);
+	// GPU results are read back frames after they were recorded, so the warmup is told apart by the frame that recorded them
+	void collectGpuSamples()
+	{
+		for (const VulkanGpuProfiler::Sample &sample : mGpuProfiler.takeSamples()) {
+			if (sample.frameNumber >= mOptions.warmupFrames) {
+				mBenchmarkReport.addGpuTime(sample.name, sample.milliseconds);
+			}
 		}
+	}
 
-		vkDestroySwapchainKHR(device, swapChain, nullptr);
+	/**
+	 * The texture streamer replaced an image view. A descriptor set must not be updated while a submitted
+	 *  command buffer still uses it, so rather than rewriting the sets, drawFrame takes new ones. The old sets
+	 *  go back to the allocator once the frames submitted so far have completed.
+	 */
+	void refreshTextureBindings()
+	{
+		mDescriptorAllocator.retire(mFrameSync.getSubmittedValue());
+		resetDescriptorSet();
+	}
 
-		// We clean up uniform buffers here because it is dependent on the number of swap chain images
-		for (std::shared_ptr<VulkanBuffer> &pUniformBuffer : mpUniformBuffers) {
-			pUniformBuffer->cleanUp();
-		}
+	/**
+	 * Hand everything that depends on the swap chain to the deletion queue. Frames submitted so far may still
+	 *  use these objects, so they are destroyed once the last of them completes rather than right away.
+	 *  The swap chain handle itself stays valid until then, to be passed as oldSwapchain on recreation.
+	 */
+	void retireSwapChain()
+	{
+		uint64_t lastUsedValue = mFrameSync.getSubmittedValue();
+
+		VkDevice logicalDevice = device;
+		std::vector<VkFramebuffer> framebuffers = std::move(swapChainFramebuffers);
+		std::vector<VkImageView> imageViews = std::move(swapChainImageViews);
+		std::shared_ptr<VulkanDepthResources> pDepthResources = mpDepthResources;
+		VkPipeline oldPipeline = graphicsPipeline;
+		VkRenderPass oldRenderPass = renderPass;
+		VkSwapchainKHR oldSwapChain = swapChain;
+		std::vector<std::shared_ptr<VulkanOffscreenTarget>> pOffscreenTargets = std::move(mpOffscreenTargets);
+
+		mDeletionQueue.push(lastUsedValue, [=]() {
+			pDepthResources->cleanUp();
+
+			for (const std::shared_ptr<VulkanOffscreenTarget> &pOffscreenTarget : pOffscreenTargets) {
+				pOffscreenTarget->cleanUp();
+			}
+
+			for (VkFramebuffer framebuffer : framebuffers) {
+				vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+			}
 
-		vkDestroyDescriptorPool(device, mDescriptorPool, nullptr);
+			vkDestroyPipeline(logicalDevice, oldPipeline, nullptr);
+			vkDestroyRenderPass(logicalDevice, oldRenderPass, nullptr);
+
+			for (VkImageView imageView : imageViews) {
+				vkDestroyImageView(logicalDevice, imageView, nullptr);
+			}
+
+			// Headless mode has no swap chain, and doesn't enable the extension either
+			if (oldSwapChain != VK_NULL_HANDLE) {
+				vkDestroySwapchainKHR(logicalDevice, oldSwapChain, nullptr);
+			}
+		});
+
+		swapChainFramebuffers.clear();
+		swapChainImageViews.clear();
+		mpOffscreenTargets.clear();
+		mpDepthResources = std::make_shared<VulkanDepthResources>();
 	}
 
 	/**
@@ -1392,109 +2101,323 @@ private:
 	 */
 	void recreateSwapChain()
 	{
-		int width = 0, height = 0;
-		glfwGetFramebufferSize(window, &width, &height);
+		PROFILE_SCOPE("recreateSwapChain");
 
-		// Keep calling glfwGetFramebufferSize until the width or height are non-zero
-		while (!width || !height) {
+		// Offscreen images take their size from mOffscreenExtent instead of a window
+		if (!mOptions.headless) {
+			int width = 0, height = 0;
 			glfwGetFramebufferSize(window, &width, &height);
-			glfwWaitEvents();
+
+			// Keep calling glfwGetFramebufferSize until the width or height are non-zero
+			while (!width || !height) {
+				glfwGetFramebufferSize(window, &width, &height);
+				glfwWaitEvents();
+			}
 		}
 
-		vkDeviceWaitIdle(device); // Wait to make sure that we don't use resources that may still be in use
+		finishShaderReload();
 
-		cleanupSwapChain();
+		// No device wait: frames still in flight keep the old objects alive through the deletion queue
+		retireSwapChain();
 
 		createSwapChain();
+		mImageFrameValues.assign(swapChainImages.size(), 0); // The image count may change
 		createImageViewsForSwapChain(); // Image views are based directly on the number of swap chain images
 		createRenderPass(); // Render pass is dependent on the format of swap chain image. However, it's rare that image format would change during window resize
 
 		createGraphicsPipeline(); // Viewport and scissor rectangle size are specified during graphics pipeline creation
 		createDepthResources();
 		createFramebuffers();
-		createUniformBuffers();
-		createDescriptorPool();
-		createDescriptorSets();
-		createCommandBuffers();
 	}
 
 	void initVulkan()
 	{
+		PROFILE_SCOPE("initVulkan");
+
 		createBaseApplication();
 
-		createSurface();
+		if (!mOptions.headless) {
+			createSurface();
+		}
 		pickPhysicalDevice();
 		createLogicalDevice();
+		createShaderLibrary();
 
 		createSwapChain();
 		createImageViewsForSwapChain();
 		createRenderPass();
+		createTextureRegistry();
+		loadShaders();
 		createDescriptorSetLayout();
+		createDescriptorAllocator();
 
 		createGraphicsPipeline();
+		createShaderWatcher();
 		createDepthResources();
 		createFramebuffers();
 
 		createCommandPool();
 
-		loadTexture(std::string(resource_dir) + "textures/viking_room.png");
+		createTextureStreamer();
+		// The textures benchmark scenario loads the same image several times, as separate textures. Devices without dynamic
+		//  indexing, or with low descriptor limits, get as many as the registry holds.
+		uint32_t textureCount = std::max(mOptions.scenario.textureCount, 1u);
+		if (textureCount > mTextureRegistry.getCapacity()) {
+			std::cout << "[WARNING] The device fits " << mTextureRegistry.getCapacity() << " of the " << textureCount
+				<< " textures the scenario asks for, the instances share those" << std::endl;
+			textureCount = mTextureRegistry.getCapacity();
+		}
+		for (uint32_t i = 0; i < textureCount; ++i) {
+			loadTexture(std::string(resource_dir) + "textures/viking_room.png");
+		}
 		loadModel(std::string(resource_dir) + "models/viking_room.obj");
+		buildScene();
+
+		createGeometryPool();
+		uploadMeshes();
+		resetDescriptorSet();
 
-		createVertexBuffer();
-		createIndexBuffer();
-		createUniformBuffers();
-		createDescriptorPool();
-		createDescriptorSets();
+		createFrameSync();
+		createGpuProfiler();
+		mImageFrameValues.assign(swapChainImages.size(), 0);
 
 		createCommandBuffers();
 
 		createSyncObjects();
 	}
 
+	/**
+	 * The main thread is the render thread: GLFW wants its events polled here, and it owns every Vulkan object.
+	 *  Scene updates run on a separate update thread and arrive as frame packets.
+	 * Headless runs render a fixed number of frames, as do windowed runs given a frame count.
+	 */
 	void mainLoop()
 	{
-		while (!glfwWindowShouldClose(window)) {
-			glfwPollEvents();
-			drawFrame();
+		uint64_t frameCount = mOptions.frameCount;
+		if (mOptions.headless && !frameCount) {
+			frameCount = DEFAULT_HEADLESS_FRAME_COUNT;
 		}
 
+		// Allocation counts in benchmark results cover the frames rendered, not loading
+		VulkanMemoryStats::get().resetCounters();
+		mLastFrameEnd = FrameStageTimings::Clock::now();
+
+		mStopUpdateThread.store(false, std::memory_order_release);
+		mUpdateThread = std::thread(&HelloTriangleApplication::updateLoop, this);
+
+		try {
+			FramePacket packet;
+			while (mOptions.headless || !glfwWindowShouldClose(window)) {
+				if (frameCount && mFrameCount >= frameCount) {
+					break;
+				}
+
+				if (!mOptions.headless) {
+					glfwPollEvents();
+				}
+
+				if (mRequestedFramesInFlight && mRequestedFramesInFlight != mFrameSync.getFramesInFlight()) {
+					setFramesInFlight(mRequestedFramesInFlight);
+				}
+				mRequestedFramesInFlight = 0;
+
+				if (mTraceRequested) {
+					mTraceRequested = false;
+					writeTrace();
+				}
+
+				applyBenchmarkScenario();
+				updateShaderReload();
+
+				FrameStageTimings::Clock::time_point waitStart = FrameStageTimings::Clock::now();
+				mFramePackets.pop(packet);
+				mFrameTimings.record(FrameStage::PacketWait, waitStart);
+
+				drawFrame(packet);
+			}
+		} catch (...) {
+			// A joinable std::thread terminates the program when destroyed, so stop them before unwinding
+			stopUpdateThread();
+			stopShaderReloadThread();
+			throw;
+		}
+
+		stopUpdateThread();
+
 		// Wait for logical device to finish operations before cleanup
 		vkDeviceWaitIdle(device);
+
+		if (mOptions.headless) {
+			std::cout << mFrameTimings.report() << std::endl;
+			std::cout << mGpuProfiler.report() << std::endl;
+
+			if (!mOptions.screenshotPath.empty()) {
+				writeScreenshot(mOptions.screenshotPath);
+			}
+		}
+
+		if (!mOptions.benchmarkPath.empty()) {
+			writeBenchmarkReport(mOptions.benchmarkPath);
+		}
 	}
 
-	void cleanup()
+	/**
+	 * Inject the periodic load of the benchmark scenario between frames. Runs at most once per drawn frame,
+	 *  drawFrame may return without drawing while the swap chain is being recreated.
+	 */
+	void applyBenchmarkScenario()
 	{
-		cleanupSwapChain();
+		const BenchmarkScenario &scenario = mOptions.scenario;
 
-		mTexture.cleanUp();
+		if (mFrameCount == mLastScenarioFrame) {
+			return;
+		}
+		mLastScenarioFrame = mFrameCount;
 
-		vkDestroyDescriptorSetLayout(device, mDescriptorSetLayout, nullptr);
+		if (scenario.resizeInterval && mFrameCount % scenario.resizeInterval == 0) {
+			resizeForScenario();
+		}
 
-		mpIndexBuffer->cleanUp();
-		mpVertexBuffer->cleanUp();
+		if (scenario.uploadInterval && mFrameCount % scenario.uploadInterval == 0) {
+			reuploadGeometry();
+		}
+	}
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-			vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-			vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(device, inFlightFences[i], nullptr);
+	void resizeForScenario()
+	{
+		float scale = RESIZE_STORM_SCALES[mResizeCount++ % RESIZE_STORM_SCALES.size()];
+		uint32_t width = std::max(static_cast<uint32_t>(mOptions.width * scale), 1u);
+		uint32_t height = std::max(static_cast<uint32_t>(mOptions.height * scale), 1u);
+
+		if (mOptions.headless) {
+			mOffscreenExtent = { width, height };
+			recreateSwapChain();
+		} else {
+			// The resize callback picks this up like a resize by the user
+			glfwSetWindowSize(window, static_cast<int>(width), static_cast<int>(height));
+		}
+	}
+
+	/**
+	 * Upload every mesh again through the geometry pool. Frames in flight may still read the old geometry, so
+	 *  its ranges are only freed once they complete, and the pool is compacted when the frees fragment it.
+	 */
+	void reuploadGeometry()
+	{
+		PROFILE_SCOPE("reuploadGeometry");
+
+		uint64_t lastUsedValue = mFrameSync.getSubmittedValue();
+
+		for (size_t i = 0; i < mMeshes.size(); ++i) {
+			mGeometryPool.removeGeometry(mGeometryHandles[i], lastUsedValue);
+			mGeometryHandles[i] = mGeometryPool.addGeometry(
+				mMeshes[i].getVertices(), mMeshes[i].getIndexData(), mMeshes[i].getIndexType(), lastUsedValue);
+		}
+
+		if (mGeometryPool.getFreeRangeCount() > GEOMETRY_POOL_MAX_FREE_RANGES) {
+			mGeometryPool.compact(lastUsedValue);
+		}
+	}
+
+	// The device must be idle, so the GPU scopes of the last frames can be read back
+	void writeBenchmarkReport(const std::string &fileName)
+	{
+		mGpuProfiler.resolveAllFrames();
+		collectGpuSamples();
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+		mBenchmarkReport.setInfo("device", deviceProperties.deviceName);
+		mBenchmarkReport.setInfo("driverVersion", deviceProperties.driverVersion);
+		mBenchmarkReport.setInfo("headless", mOptions.headless ? 1.0 : 0.0);
+		mBenchmarkReport.setInfo("width", mOptions.width);
+		mBenchmarkReport.setInfo("height", mOptions.height);
+		mBenchmarkReport.setInfo("framesInFlight", mFrameSync.getFramesInFlight());
+		mBenchmarkReport.setInfo("timelineSemaphore", mFrameSync.isUsingTimeline() ? 1.0 : 0.0);
+		mBenchmarkReport.setInfo("warmupFrames", mOptions.warmupFrames);
+		mBenchmarkReport.setInfo("textureCount", mTextureRegistry.getTextureCount());
+
+		mBenchmarkReport.setMemoryStats(VulkanMemoryStats::get().getSnapshot());
+		mBenchmarkReport.write(fileName);
+
+		std::cout << "[INFO] Wrote " << mBenchmarkReport.getFrameCount() << " frames of benchmark results to " << fileName << std::endl;
+	}
+
+	// The device must be idle, so the last frame has finished rendering
+	void writeScreenshot(const std::string &fileName)
+	{
+		if (!mFrameCount) {
+			throw std::runtime_error("[ERROR] No frame was rendered to write a screenshot of!");
+		}
+
+		mpOffscreenTargets[mLastImageIndex]->writePng(fileName, commandPool, graphicsQueue);
+
+		std::cout << "[INFO] Wrote " << fileName << std::endl;
+	}
+
+	void stopUpdateThread()
+	{
+		mStopUpdateThread.store(true, std::memory_order_release);
+		mFramePackets.close();
+		if (mUpdateThread.joinable()) {
+			mUpdateThread.join();
 		}
+	}
+
+	void cleanup()
+	{
+		finishShaderReload();
+		stopShaderReloadThread();
+		mShaderWatcher.cleanUp();
+
+		retireSwapChain();
+		mDeletionQueue.flush(); // The device is idle at this point, so everything can go
+
+		mTextureStreamer.cleanUp();
+		mSamplerCache.cleanUp();
+
+		mDescriptorAllocator.cleanUp();
+		mLayoutCache.cleanUp();
+		if (mShadersReloaded) {
+			removeReloadedShaders(mVertShaderPath, mFragShaderPath);
+		}
+		mShaderLibrary.cleanUp();
+
+		mGeometryPool.cleanUp();
+
+		vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+
+		destroySyncObjects();
+		mFrameSync.cleanUp();
+		mGpuProfiler.cleanUp();
 
 		vkDestroyCommandPool(device, commandPool, nullptr);
 		vkDestroyDevice(device, nullptr);
-		vkDestroySurfaceKHR(instance, surface, nullptr);
+		if (surface != VK_NULL_HANDLE) {
+			vkDestroySurfaceKHR(instance, surface, nullptr);
+		}
 
 		baseApp.cleanUp();
 
-		glfwDestroyWindow(window);
-		glfwTerminate();
+		if (!mOptions.headless) {
+			glfwDestroyWindow(window);
+			glfwTerminate();
+		}
 	}
 
-	GLFWwindow *window;
+	ApplicationOptions mOptions;
+	BenchmarkReport mBenchmarkReport{ mOptions.scenario };
+	FrameStageTimings::Clock::time_point mLastFrameEnd;
+	uint64_t mLastScenarioFrame = 0;	// Frame count when the benchmark scenario was last applied
+	uint32_t mResizeCount = 0;
+
+	GLFWwindow *window = nullptr;
 
 	VulkanBaseApplication baseApp;
 	VkInstance instance;
 
-	VkSurfaceKHR surface;	// Connect between Vulkan and window system
+	VkSurfaceKHR surface = VK_NULL_HANDLE;	// Connect between Vulkan and window system
 
 	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 	VkDevice device;		// Logical device handle
@@ -1502,16 +2425,34 @@ private:
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
 
-	VkSwapchainKHR swapChain;
+	VkSwapchainKHR swapChain = VK_NULL_HANDLE;
 	std::vector<VkImage> swapChainImages;	// Handles of images in the swap chain
 	VkFormat swapChainImageFormat;
 	VkExtent2D swapChainExtent;
 	std::vector<VkImageView> swapChainImageViews;
+	std::vector<std::shared_ptr<VulkanOffscreenTarget>> mpOffscreenTargets;	// Take the place of the swap chain images in headless mode
+	uint32_t mLastImageIndex = 0;	// Image the last submitted frame rendered to
+	VkExtent2D mOffscreenExtent;	// Size of the offscreen images, the swap chain extent in headless mode
 
 	VkRenderPass renderPass;
 
-	VkDescriptorSetLayout mDescriptorSetLayout;
-	VkPipelineLayout pipelineLayout;
+	VulkanShaderLibrary mShaderLibrary;
+	std::string mVertShaderPath;	// SPIR-V the current pipeline was built from
+	std::string mFragShaderPath;
+	ShaderReflection mShaderReflection;	// Of both stages, merged
+	ShaderWatcher mShaderWatcher;
+	bool mShadersReloaded = false;	// mVertShaderPath and mFragShaderPath were compiled by a reload
+	std::future<ShaderReload> mShaderReload;	// Valid while a reload is running
+	std::thread mShaderReloadThread;	// Started by the first reload
+	std::mutex mShaderReloadMutex;
+	std::condition_variable mShaderReloadCondition;
+	std::packaged_task<ShaderReload()> mShaderReloadTask;	// Waiting for the worker, guarded by mShaderReloadMutex
+	bool mStopShaderReloadThread = false;
+	bool mShaderSourcesChanged = false;	// Saved since the running reload started
+	uint32_t mShaderReloadCount = 0;
+	VulkanLayoutCache mLayoutCache;
+	VkDescriptorSetLayout mDescriptorSetLayout;	// Owned by mLayoutCache
+	VkPipelineLayout pipelineLayout;	// Owned by mLayoutCache
 	VkPipeline graphicsPipeline;
 
 	std::vector<VkFramebuffer> swapChainFramebuffers;
@@ -1521,32 +2462,101 @@ private:
 
 	std::vector<VkSemaphore> imageAvailableSemaphores;	// Signals an image has been acquired and ready for rendering
 	std::vector<VkSemaphore> renderFinishedSemaphores;	// Signals rendering has finished and presentation can happen
-	std::vector<VkFence> inFlightFences;				// To perform CPU-GPU synchronization
-	std::vector<VkFence> imagesInFlight;				// Keep track which swap chain image the frame in flight is using
-	size_t currentFrame = 0;	// Keeps track of current frame so that we use the correct semaphore objects
+	VulkanFrameSync mFrameSync;							// To perform CPU-GPU synchronization
+	VulkanDeletionQueue mDeletionQueue;					// Objects waiting for the GPU to finish with them
+	std::vector<uint64_t> mImageFrameValues;			// Keep track which frame last rendered to each swap chain image
+	uint32_t mRequestedFramesInFlight = 0;				// Set from the key callback, 0 when there's no request
+	bool mTraceRequested = false;
+	VulkanGpuProfiler mGpuProfiler;
+	uint64_t mFrameCount = 0;	// Total number of frames drawn
+
+	bool mPhysicalDeviceProperties2Enabled = false;
+	bool mTimelineSemaphoreEnabled = false;
 
 	bool framebufferResized = false;
 
+	// Frame pipeline between the update thread and the render thread
+	SpscQueue<FramePacket> mFramePackets{ FRAME_PACKET_QUEUE_DEPTH };
+	std::thread mUpdateThread;
+	std::atomic<bool> mStopUpdateThread{ false };
+	std::atomic<uint32_t> mViewportWidth{ WIDTH };	// Swap chain extent as seen by the update thread
+	std::atomic<uint32_t> mViewportHeight{ HEIGHT };
+	FrameStageTimings mFrameTimings;
+
 	// There must be a better way for "delayed" initialization
-	std::shared_ptr<VulkanBuffer> mpVertexBuffer = nullptr;
-	std::shared_ptr<VulkanBuffer> mpIndexBuffer = nullptr;
-	std::vector<std::shared_ptr<VulkanBuffer>> mpUniformBuffers;	// Multiple uniform buffers
+	VulkanGeometryPool mGeometryPool;
+	std::vector<uint32_t> mGeometryHandles;	// Pool handle of each mesh in mMeshes, only used by the render thread
 
-	VkDescriptorPool mDescriptorPool;
-	std::vector<VkDescriptorSet> mDescriptorSets;
+	VulkanDescriptorAllocator mDescriptorAllocator;
+	VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;	// VK_NULL_HANDLE until the next frame is rendered
 
-	VulkanTexture mTexture;
+	VulkanSamplerCache mSamplerCache;
+	VulkanTextureStreamer mTextureStreamer;
+	std::vector<uint32_t> mTextureHandles;
 
-	VulkanDepthResources mDepthResources;
+	VulkanTextureRegistry mTextureRegistry;
+	std::vector<uint32_t> mMaterialIndices;	// Registry slot of each texture in mTextureHandles
+	bool mDynamicTextureIndexing = false;
 
-	Mesh mMesh;
+	std::shared_ptr<VulkanDepthResources> mpDepthResources = std::make_shared<VulkanDepthResources>();
+
+	std::vector<Mesh> mMeshes;	// Loaded before the update thread starts and never changed after
+	Scene mScene;	// Only touched by the update thread once it runs
+	Camera mCamera;	// Update thread
+	std::vector<glm::mat4> mModelViewProjs;	// Update thread, the camera's view projection times each scene node's world matrix
 };
 
-int main()
+/**
+ * Usage: [--headless] [--frames N] [--screenshot file.png] [--width W] [--height H]
+ *  [--scenario baseline|instances|textures|resize-storm|upload-burst] [--benchmark results.json] [--warmup N]
+ *  [--watch-shaders]
+ */
+ApplicationOptions parseOptions(int argc, char **argv)
 {
-	HelloTriangleApplication app;
+	ApplicationOptions options;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--headless") {
+			options.headless = true;
+		} else if (argument == "--frames" && hasValue) {
+			options.frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (argument == "--screenshot" && hasValue) {
+			options.screenshotPath = argv[++i];
+		} else if (argument == "--width" && hasValue) {
+			options.width = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (argument == "--height" && hasValue) {
+			options.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (argument == "--scenario" && hasValue) {
+			options.scenario = BenchmarkScenario::fromName(argv[++i]);
+		} else if (argument == "--benchmark" && hasValue) {
+			options.benchmarkPath = argv[++i];
+		} else if (argument == "--warmup" && hasValue) {
+			options.warmupFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (argument == "--watch-shaders") {
+			options.watchShaders = true;
+		} else {
+			throw std::runtime_error("[ERROR] Unknown argument " + argument + "!");
+		}
+	}
+
+	if (!options.width || !options.height) {
+		throw std::runtime_error("[ERROR] Width and height must be greater than 0!");
+	}
 
+	if (!options.screenshotPath.empty() && !options.headless) {
+		throw std::runtime_error("[ERROR] Screenshots are only supported in headless mode!");
+	}
+
+	return options;
+}
+
+int main(int argc, char **argv)
+{
 	try {
+		HelloTriangleApplication app(parseOptions(argc, argv));
 		app.run();
 	} catch (const std::exception &thrownException) {
 		std::cerr << thrownException.what() << std::endl;
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChromeTrace.h"
+#include "CpuProfiler.h"
+#include "TestJson.h"
+#include "TestUtils.h"
+
+namespace
+{
+	std::vector<ChromeTraceEvent> exportEvents()
+	{
+		ChromeTraceWriter writer;
+		CpuProfiler::get().appendTraceEvents(writer);
+
+		testjson::Value trace;
+		CHECK(testjson::parse(writer.toJson(), trace));
+
+		std::vector<ChromeTraceEvent> events;
+		testjson::Value const *pTraceEvents = trace.find("traceEvents");
+		if (!CHECK(pTraceEvents && pTraceEvents->type == testjson::Value::Type::Array))
+		{
+			return events;
+		}
+
+		// Read back from the JSON, so every test also checks the writer
+		for (testjson::Value const &value : pTraceEvents->array)
+		{
+			testjson::Value const *pPhase = value.find("ph");
+			if (!pPhase || pPhase->string != "X")
+			{
+				continue;
+			}
+
+			ChromeTraceEvent event;
+			event.name = value.find("name")->string;
+			event.category = value.find("cat")->string;
+			event.threadId = static_cast<uint32_t>(value.find("tid")->number);
+			event.timestampMicroseconds = value.find("ts")->number;
+			event.durationMicroseconds = value.find("dur")->number;
+			events.push_back(event);
+		}
+
+		return events;
+	}
+
+	std::vector<ChromeTraceEvent> findEvents(std::vector<ChromeTraceEvent> const &events, std::string const &name)
+	{
+		std::vector<ChromeTraceEvent> found;
+		std::copy_if(events.begin(), events.end(), std::back_inserter(found),
+			[&name](ChromeTraceEvent const &event) { return event.name == name; });
+		return found;
+	}
+
+	void testNestedScopes()
+	{
+		CpuProfiler::get().clear();
+
+		{
+			CpuProfileScope outer("outer");
+			{
+				CpuProfileScope inner("inner");
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		std::vector<ChromeTraceEvent> events = exportEvents();
+		std::vector<ChromeTraceEvent> outer = findEvents(events, "outer");
+		std::vector<ChromeTraceEvent> inner = findEvents(events, "inner");
+
+		if (!CHECK(outer.size() == 1 && inner.size() == 1))
+		{
+			return;
+		}
+
+		CHECK(outer[0].category == "cpu");
+		CHECK(outer[0].threadId == inner[0].threadId);
+
+		// The trace is written with three decimals, one nanosecond of slack covers the rounding
+		double const epsilon = 0.001;
+		CHECK(inner[0].timestampMicroseconds >= outer[0].timestampMicroseconds - epsilon);
+		CHECK(inner[0].timestampMicroseconds + inner[0].durationMicroseconds <=
+			outer[0].timestampMicroseconds + outer[0].durationMicroseconds + epsilon);
+		CHECK(inner[0].durationMicroseconds >= 2000.0);
+		CHECK(outer[0].durationMicroseconds >= 3000.0);
+	}
+
+	void testThreadBuffers()
+	{
+		CpuProfiler::get().clear();
+
+		int const threadCount = 4;
+		int const scopesPerThread = 100;
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([i]() {
+				CpuProfiler::get().setThreadName("Worker " + std::to_string(i));
+
+				for (int j = 0; j < scopesPerThread; ++j)
+				{
+					CpuProfileScope scope("worker");
+				}
+			});
+		}
+
+		{
+			CpuProfileScope scope("main");
+		}
+
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		// The threads have exited, their buffers must still be exported
+		ChromeTraceWriter writer;
+		CpuProfiler::get().appendTraceEvents(writer);
+
+		testjson::Value trace;
+		if (!CHECK(testjson::parse(writer.toJson(), trace)))
+		{
+			return;
+		}
+
+		std::vector<std::string> threadNames;
+		for (testjson::Value const &value : trace.find("traceEvents")->array)
+		{
+			if (value.find("ph")->string == "M")
+			{
+				threadNames.push_back(value.find("args")->find("name")->string);
+			}
+		}
+
+		for (int i = 0; i < threadCount; ++i)
+		{
+			CHECK(std::count(threadNames.begin(), threadNames.end(), "Worker " + std::to_string(i)) == 1);
+		}
+
+		std::vector<ChromeTraceEvent> events = exportEvents();
+		std::vector<ChromeTraceEvent> workerEvents = findEvents(events, "worker");
+		std::vector<ChromeTraceEvent> mainEvents = findEvents(events, "main");
+
+		CHECK(workerEvents.size() == threadCount * scopesPerThread);
+		if (!CHECK(mainEvents.size() == 1))
+		{
+			return;
+		}
+
+		// Each worker got a track of its own, separate from the main thread's
+		std::vector<uint32_t> threadIds;
+		for (ChromeTraceEvent const &event : workerEvents)
+		{
+			CHECK(event.threadId != mainEvents[0].threadId);
+			threadIds.push_back(event.threadId);
+		}
+
+		std::sort(threadIds.begin(), threadIds.end());
+		threadIds.erase(std::unique(threadIds.begin(), threadIds.end()), threadIds.end());
+		CHECK(threadIds.size() == threadCount);
+
+		for (uint32_t threadId : threadIds)
+		{
+			CHECK(std::count_if(workerEvents.begin(), workerEvents.end(),
+				[threadId](ChromeTraceEvent const &event) { return event.threadId == threadId; }) == scopesPerThread);
+		}
+	}
+
+	void testRingBufferOverwritesOldest()
+	{
+		CpuProfiler::get().clear();
+
+		// On a thread of its own so no earlier test's scopes are in the ring
+		std::thread thread([]() {
+			CpuProfiler::get().setThreadName("Ring");
+
+			CpuProfiler::Clock::time_point now = CpuProfiler::Clock::now();
+			for (int i = 0; i < 10; ++i)
+			{
+				CpuProfiler::get().record("oldest", now, now);
+			}
+			for (size_t i = 0; i < CpuProfiler::EVENTS_PER_THREAD; ++i)
+			{
+				CpuProfiler::get().record("newest", now, now);
+			}
+		});
+		thread.join();
+
+		std::vector<ChromeTraceEvent> events = exportEvents();
+		CHECK(findEvents(events, "oldest").empty());
+		CHECK(findEvents(events, "newest").size() == CpuProfiler::EVENTS_PER_THREAD);
+	}
+
+	void testDisabled()
+	{
+		CpuProfiler::get().clear();
+		CpuProfiler::get().setEnabled(false);
+
+		{
+			CpuProfileScope scope("disabled");
+		}
+
+		CpuProfiler::get().setEnabled(true);
+
+		CHECK(findEvents(exportEvents(), "disabled").empty());
+	}
+
+	void testJsonEscaping()
+	{
+		ChromeTraceWriter writer;
+		writer.setThreadName(7, "Thread \"7\"");
+
+		ChromeTraceEvent event;
+		event.name = "C:\\shaders\\simple.frag\n\tline\x01";
+		event.category = "gpu";
+		event.threadId = 7;
+		event.timestampMicroseconds = 1.5;
+		event.durationMicroseconds = 0.25;
+		writer.addEvent(event);
+
+		testjson::Value trace;
+		if (!CHECK(testjson::parse(writer.toJson(), trace)))
+		{
+			return;
+		}
+
+		testjson::Value const *pTraceEvents = trace.find("traceEvents");
+		if (!CHECK(pTraceEvents && pTraceEvents->array.size() == 2))
+		{
+			return;
+		}
+
+		CHECK(pTraceEvents->array[0].find("args")->find("name")->string == "Thread \"7\"");
+		CHECK(pTraceEvents->array[1].find("name")->string == event.name);
+		CHECK(pTraceEvents->array[1].find("ts")->number == 1.5);
+		CHECK(pTraceEvents->array[1].find("dur")->number == 0.25);
+		CHECK(trace.find("displayTimeUnit")->string == "ms");
+
+		ChromeTraceWriter emptyWriter;
+		CHECK(testjson::parse(emptyWriter.toJson(), trace));
+	}
+}
+
+int main()
+{
+	testNestedScopes();
+	testThreadBuffers();
+	testRingBufferOverwritesOldest();
+	testDisabled();
+	testJsonEscaping();
+
+	return testutils::finish();
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MeshletBuilder.h"
+#include "TestUtils.h"
+
+namespace
+{
+	struct TestMesh
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// size x size quads in the z = 0 plane, two counter clockwise triangles each, so every front face looks down +z
+	TestMesh makeGrid(uint32_t size)
+	{
+		TestMesh mesh;
+
+		for (uint32_t y = 0; y <= size; ++y)
+		{
+			for (uint32_t x = 0; x <= size; ++x)
+			{
+				Vertex vertex{};
+				vertex.position = glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				uint32_t corner = y * (size + 1) + x;
+				uint32_t quad[4] = { corner, corner + 1, corner + size + 2, corner + size + 1 };
+
+				mesh.indices.insert(mesh.indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+			}
+		}
+
+		return mesh;
+	}
+
+	uint32_t maxVertexCount(MeshletData const &data)
+	{
+		uint32_t count = 0;
+		for (Meshlet const &meshlet : data.meshlets)
+		{
+			count = std::max(count, meshlet.vertexCount);
+		}
+		return count;
+	}
+
+	void testGrid()
+	{
+		TestMesh grid = makeGrid(32);
+
+		MeshletData data = MeshletBuilder::build(grid.vertices, grid.indices);
+		CHECK(MeshletBuilder::validate(data, grid.vertices, grid.indices).empty());
+		CHECK(data.meshlets.size() > 1);
+
+		// Every meshlet but the last was closed because the next triangle didn't fit
+		for (size_t i = 0; i + 1 < data.meshlets.size(); ++i)
+		{
+			CHECK(data.meshlets[i].vertexCount > MeshletBuilder::MAX_VERTICES - 3 ||
+				data.meshlets[i].triangleCount == MeshletBuilder::MAX_TRIANGLES);
+		}
+
+		// Other limits, validated against the same ones
+		uint32_t limits[][2] = { { 16, 8 }, { 32, 64 }, { 128, 256 } };
+		for (uint32_t const *limit : limits)
+		{
+			MeshletData limited = MeshletBuilder::build(grid.vertices, grid.indices, limit[0], limit[1]);
+			CHECK(MeshletBuilder::validate(limited, grid.vertices, grid.indices, limit[0], limit[1]).empty());
+		}
+	}
+
+	void testValidateFindsErrors()
+	{
+		TestMesh grid = makeGrid(8);
+		MeshletData data = MeshletBuilder::build(grid.vertices, grid.indices);
+
+		MeshletData swapped = data;
+		std::swap(swapped.triangleIndices[0], swapped.triangleIndices[1]);
+		CHECK(!MeshletBuilder::validate(swapped, grid.vertices, grid.indices).empty());
+
+		MeshletData shrunk = data;
+		shrunk.bounds[0].radius *= 0.5f;
+		CHECK(!MeshletBuilder::validate(shrunk, grid.vertices, grid.indices).empty());
+
+		MeshletData truncated = data;
+		truncated.meshlets.back().triangleCount -= 1;
+		CHECK(!MeshletBuilder::validate(truncated, grid.vertices, grid.indices).empty());
+
+		// Valid meshlets, but for larger limits than the ones checked
+		CHECK(!MeshletBuilder::validate(data, grid.vertices, grid.indices, 16, 8).empty());
+	}
+
+	void testSmallestVertexLimit()
+	{
+		TestMesh grid = makeGrid(4);
+
+		// Neighbouring triangles share two vertices, so each needs one more than 3 allow
+		MeshletData data = MeshletBuilder::build(grid.vertices, grid.indices, 3, MeshletBuilder::MAX_TRIANGLES);
+		CHECK(MeshletBuilder::validate(data, grid.vertices, grid.indices, 3, MeshletBuilder::MAX_TRIANGLES).empty());
+		CHECK(data.meshlets.size() == grid.indices.size() / 3);
+	}
+
+	void testLargestVertexLimit()
+	{
+		// 289 vertices, so the first meshlet fills all 256 local indices
+		TestMesh grid = makeGrid(16);
+
+		MeshletData data = MeshletBuilder::build(grid.vertices, grid.indices, 256, 1024);
+		CHECK(MeshletBuilder::validate(data, grid.vertices, grid.indices, 256, 1024).empty());
+		CHECK(maxVertexCount(data) == 256);
+
+		// Separate triangles of 3, then 2 and 2 vertices, the last of which repeats the vertex that gets local index 255
+		TestMesh separate;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			Vertex vertex{};
+			vertex.position = glm::vec3(static_cast<float>(i % 16), static_cast<float>(i / 16), static_cast<float>(i % 3));
+			separate.vertices.push_back(vertex);
+		}
+		for (uint32_t i = 0; i < 252; ++i)
+		{
+			separate.indices.push_back(i);
+		}
+		separate.indices.insert(separate.indices.end(), { 252, 253, 253, 254, 255, 255 });
+
+		MeshletData separateData = MeshletBuilder::build(separate.vertices, separate.indices, 256, 1024);
+		CHECK(MeshletBuilder::validate(separateData, separate.vertices, separate.indices, 256, 1024).empty());
+		CHECK(separateData.meshlets.size() == 1);
+	}
+
+	void testInvalidLimits()
+	{
+		TestMesh grid = makeGrid(2);
+
+		uint32_t limits[][2] = { { 2, 1 }, { 257, 1 }, { 64, 0 } };
+		for (uint32_t const *limit : limits)
+		{
+			bool thrown = false;
+			try
+			{
+				MeshletBuilder::build(grid.vertices, grid.indices, limit[0], limit[1]);
+			}
+			catch (std::runtime_error const &)
+			{
+				thrown = true;
+			}
+			CHECK(thrown);
+		}
+	}
+
+	void testDegenerateTriangles()
+	{
+		TestMesh grid = makeGrid(2);
+
+		// A repeated vertex, a triangle of one vertex and three collinear vertices
+		std::vector<uint32_t> indices = { 0, 0, 1, 4, 4, 4, 0, 1, 2 };
+		indices.insert(indices.end(), grid.indices.begin(), grid.indices.end());
+
+		for (uint32_t maxVertices : { 3u, 4u, 64u })
+		{
+			MeshletData data = MeshletBuilder::build(grid.vertices, indices, maxVertices, MeshletBuilder::MAX_TRIANGLES);
+			CHECK(MeshletBuilder::validate(data, grid.vertices, indices, maxVertices, MeshletBuilder::MAX_TRIANGLES).empty());
+		}
+
+		// A repeated vertex only takes one slot, so 0, 0, 1 and 4, 4, 4 share a meshlet of 3 vertices
+		MeshletData data = MeshletBuilder::build(grid.vertices, indices, 3, MeshletBuilder::MAX_TRIANGLES);
+		CHECK(data.meshlets[0].triangleCount == 2);
+		CHECK(data.meshlets[0].vertexCount == 3);
+
+		// Nothing of the first meshlet can be rasterized, so its cone must not cull
+		CHECK(data.bounds[0].coneCutoff == 1.0f);
+		CHECK(!MeshletBuilder::isBackfacing(data.bounds[0], glm::vec3(0.5f, 0.0f, -10.0f)));
+	}
+
+	void testBackfacingCone()
+	{
+		TestMesh grid = makeGrid(4);
+
+		MeshletData data = MeshletBuilder::build(grid.vertices, grid.indices);
+		if (!CHECK(data.meshlets.size() == 1))
+		{
+			return;
+		}
+
+		MeshletBounds const &bounds = data.bounds[0];
+		CHECK(bounds.coneAxis.z > 0.999f);
+		CHECK(bounds.coneCutoff < 1e-3f);
+
+		// Every triangle faces +z
+		CHECK(MeshletBuilder::isBackfacing(bounds, glm::vec3(2.0f, 2.0f, -10.0f)));
+		CHECK(MeshletBuilder::isBackfacing(bounds, glm::vec3(-20.0f, 30.0f, -100.0f)));
+		CHECK(!MeshletBuilder::isBackfacing(bounds, glm::vec3(2.0f, 2.0f, 10.0f)));
+		CHECK(!MeshletBuilder::isBackfacing(bounds, glm::vec3(-20.0f, 30.0f, 1.0f)));
+
+		// Seen edge on, or from inside the bounding sphere, part of the cluster may face the camera
+		CHECK(!MeshletBuilder::isBackfacing(bounds, glm::vec3(50.0f, 2.0f, 0.0f)));
+		CHECK(!MeshletBuilder::isBackfacing(bounds, glm::vec3(2.0f, 2.0f, -0.5f)));
+
+		// The same grid twice, the second copy facing -z, spans every direction and can never be culled
+		TestMesh doubleSided = grid;
+		for (size_t i = 0; i < grid.indices.size(); i += 3)
+		{
+			doubleSided.indices.insert(doubleSided.indices.end(), { grid.indices[i], grid.indices[i + 2], grid.indices[i + 1] });
+		}
+
+		MeshletData doubleSidedData = MeshletBuilder::build(doubleSided.vertices, doubleSided.indices);
+		CHECK(MeshletBuilder::validate(doubleSidedData, doubleSided.vertices, doubleSided.indices).empty());
+		for (MeshletBounds const &doubleSidedBounds : doubleSidedData.bounds)
+		{
+			CHECK(!MeshletBuilder::isBackfacing(doubleSidedBounds, glm::vec3(2.0f, 2.0f, -10.0f)));
+			CHECK(!MeshletBuilder::isBackfacing(doubleSidedBounds, glm::vec3(2.0f, 2.0f, 10.0f)));
+		}
+	}
+}
+
+int main()
+{
+	testGrid();
+	testValidateFindsErrors();
+	testSmallestVertexLimit();
+	testLargestVertexLimit();
+	testInvalidLimits();
+	testDegenerateTriangles();
+	testBackfacingCone();
+
+	return testutils::finish();
+}
\ No newline at end of file
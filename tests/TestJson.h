@@ -0,0 +1,325 @@
+#pragma once
+
+#ifndef TEST_JSON_H
+#define TEST_JSON_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A strict JSON reader for checking the files the renderer writes. parse fails on anything RFC 8259
+ *  doesn't allow, like raw control characters in strings or trailing commas. \u escapes are decoded
+ *  as UTF-8.
+ */
+namespace testjson
+{
+	struct Value
+	{
+		enum class Type { Null, Boolean, Number, String, Array, Object };
+
+		Type type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<Value> array;
+		std::map<std::string, Value> object;
+
+		// The member called key, or nullptr if this isn't an object or has no such member
+		Value const *find(std::string const &key) const
+		{
+			auto it = object.find(key);
+			return type == Type::Object && it != object.end() ? &it->second : nullptr;
+		}
+	};
+
+	class Parser
+	{
+	public:
+		explicit Parser(std::string const &text) : mText(text) {}
+
+		bool parse(Value &value)
+		{
+			skipWhitespace();
+			if (!parseValue(value))
+			{
+				return false;
+			}
+
+			skipWhitespace();
+			return mPosition == mText.size();
+		}
+
+	private:
+		bool parseValue(Value &value)
+		{
+			if (mPosition >= mText.size())
+			{
+				return false;
+			}
+
+			switch (mText[mPosition])
+			{
+			case '{':	return parseObject(value);
+			case '[':	return parseArray(value);
+			case '"':	value.type = Value::Type::String; return parseString(value.string);
+			case 't':	value.type = Value::Type::Boolean; value.boolean = true; return consume("true");
+			case 'f':	value.type = Value::Type::Boolean; value.boolean = false; return consume("false");
+			case 'n':	value.type = Value::Type::Null; return consume("null");
+			default:	return parseNumber(value);
+			}
+		}
+
+		bool parseObject(Value &value)
+		{
+			value.type = Value::Type::Object;
+			++mPosition;
+
+			skipWhitespace();
+			if (peek() == '}')
+			{
+				++mPosition;
+				return true;
+			}
+
+			for (;;)
+			{
+				std::string key;
+				Value member;
+
+				skipWhitespace();
+				if (peek() != '"' || !parseString(key))
+				{
+					return false;
+				}
+
+				skipWhitespace();
+				if (!consume(":"))
+				{
+					return false;
+				}
+
+				skipWhitespace();
+				if (!parseValue(member))
+				{
+					return false;
+				}
+				value.object[key] = member;
+
+				skipWhitespace();
+				if (consume("}"))
+				{
+					return true;
+				}
+				if (!consume(","))
+				{
+					return false;
+				}
+			}
+		}
+
+		bool parseArray(Value &value)
+		{
+			value.type = Value::Type::Array;
+			++mPosition;
+
+			skipWhitespace();
+			if (peek() == ']')
+			{
+				++mPosition;
+				return true;
+			}
+
+			for (;;)
+			{
+				Value element;
+
+				skipWhitespace();
+				if (!parseValue(element))
+				{
+					return false;
+				}
+				value.array.push_back(element);
+
+				skipWhitespace();
+				if (consume("]"))
+				{
+					return true;
+				}
+				if (!consume(","))
+				{
+					return false;
+				}
+			}
+		}
+
+		bool parseString(std::string &string)
+		{
+			++mPosition;
+
+			while (mPosition < mText.size())
+			{
+				char c = mText[mPosition++];
+
+				if (c == '"')
+				{
+					return true;
+				}
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					return false;
+				}
+				if (c != '\\')
+				{
+					string += c;
+					continue;
+				}
+
+				if (mPosition >= mText.size())
+				{
+					return false;
+				}
+
+				switch (mText[mPosition++])
+				{
+				case '"':	string += '"'; break;
+				case '\\':	string += '\\'; break;
+				case '/':	string += '/'; break;
+				case 'b':	string += '\b'; break;
+				case 'f':	string += '\f'; break;
+				case 'n':	string += '\n'; break;
+				case 'r':	string += '\r'; break;
+				case 't':	string += '\t'; break;
+				case 'u':
+					if (!parseCodeUnit(string))
+					{
+						return false;
+					}
+					break;
+				default:
+					return false;
+				}
+			}
+
+			return false;
+		}
+
+		// Surrogate pairs aren't combined, the renderer only escapes control characters
+		bool parseCodeUnit(std::string &string)
+		{
+			if (mPosition + 4 > mText.size())
+			{
+				return false;
+			}
+
+			uint32_t code = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				char c = mText[mPosition++];
+				code <<= 4;
+
+				if (c >= '0' && c <= '9')		code |= c - '0';
+				else if (c >= 'a' && c <= 'f')	code |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F')	code |= c - 'A' + 10;
+				else							return false;
+			}
+
+			if (code < 0x80)
+			{
+				string += static_cast<char>(code);
+			}
+			else if (code < 0x800)
+			{
+				string += static_cast<char>(0xc0 | (code >> 6));
+				string += static_cast<char>(0x80 | (code & 0x3f));
+			}
+			else
+			{
+				string += static_cast<char>(0xe0 | (code >> 12));
+				string += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				string += static_cast<char>(0x80 | (code & 0x3f));
+			}
+
+			return true;
+		}
+
+		// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+		bool parseNumber(Value &value)
+		{
+			size_t begin = mPosition;
+
+			consume("-");
+			if (!consume("0") && !skipDigits())
+			{
+				return false;
+			}
+
+			if (consume(".") && !skipDigits())
+			{
+				return false;
+			}
+
+			if (peek() == 'e' || peek() == 'E')
+			{
+				++mPosition;
+				if (!consume("+"))
+				{
+					consume("-");
+				}
+				if (!skipDigits())
+				{
+					return false;
+				}
+			}
+
+			value.type = Value::Type::Number;
+			value.number = std::strtod(mText.substr(begin, mPosition - begin).c_str(), nullptr);
+			return true;
+		}
+
+		bool skipDigits()
+		{
+			size_t begin = mPosition;
+			while (peek() >= '0' && peek() <= '9')
+			{
+				++mPosition;
+			}
+			return mPosition > begin;
+		}
+
+		void skipWhitespace()
+		{
+			while (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r')
+			{
+				++mPosition;
+			}
+		}
+
+		bool consume(char const *token)
+		{
+			std::string::size_type length = std::char_traits<char>::length(token);
+			if (mText.compare(mPosition, length, token) != 0)
+			{
+				return false;
+			}
+
+			mPosition += length;
+			return true;
+		}
+
+		char peek() const { return mPosition < mText.size() ? mText[mPosition] : '\0'; }
+
+		std::string const &mText;
+		size_t mPosition = 0;
+	};
+
+	// Whether text is exactly one valid JSON value, which is returned in value
+	inline bool parse(std::string const &text, Value &value)
+	{
+		return Parser(text).parse(value);
+	}
+}
+
+#endif // TEST_JSON_H
\ No newline at end of file
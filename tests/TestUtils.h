@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/**
+ * Checks for the CTest executables in tests/. Each executable is a plain main that calls its test
+ *  functions and returns testutils::finish(), which fails the test if any CHECK failed. A failed
+ *  CHECK is printed and the test carries on, so one run reports every failure.
+ */
+namespace testutils
+{
+	inline int &failureCount()
+	{
+		static int count = 0;
+		return count;
+	}
+
+	inline bool check(bool passed, char const *expression, char const *file, int line)
+	{
+		if (!passed)
+		{
+			std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+			++failureCount();
+		}
+
+		return passed;
+	}
+
+	inline int finish()
+	{
+		if (failureCount() > 0)
+		{
+			std::cerr << failureCount() << " check(s) failed" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	// Tests without a device make up Vulkan handles. Non-dispatchable handles are pointers or 64 bit
+	//  integers depending on the platform, so they are converted through their bits.
+	template<typename Handle>
+	Handle makeHandle(uint64_t value)
+	{
+		Handle handle{};
+		std::memcpy(&handle, &value, sizeof(handle));
+		return handle;
+	}
+
+	template<typename Handle>
+	uint64_t handleValue(Handle handle)
+	{
+		uint64_t value = 0;
+		std::memcpy(&value, &handle, sizeof(handle));
+		return value;
+	}
+}
+
+// Evaluates to whether the condition held, so a test can skip checks that depend on it
+#define CHECK(condition) testutils::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+#endif // TEST_UTILS_H
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <vector>
+
+#include "TestUtils.h"
+#include "VulkanLayoutCache.h"
+
+/**
+ * The cache is tested without a device: the test defines the four Vulkan functions it calls, which
+ *  hand out made up handles and count what is still alive.
+ */
+namespace
+{
+	uint64_t nextHandle = 1;
+	int liveSetLayouts = 0;
+	int livePipelineLayouts = 0;
+	std::vector<uint32_t> createdPushConstantRangeCounts;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorSetLayout(
+	VkDevice, VkDescriptorSetLayoutCreateInfo const *, VkAllocationCallbacks const *, VkDescriptorSetLayout *pSetLayout)
+{
+	*pSetLayout = testutils::makeHandle<VkDescriptorSetLayout>(nextHandle++);
+	++liveSetLayouts;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout, VkAllocationCallbacks const *)
+{
+	--liveSetLayouts;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(
+	VkDevice, VkPipelineLayoutCreateInfo const *pCreateInfo, VkAllocationCallbacks const *, VkPipelineLayout *pPipelineLayout)
+{
+	createdPushConstantRangeCounts.push_back(pCreateInfo->pushConstantRangeCount);
+	*pPipelineLayout = testutils::makeHandle<VkPipelineLayout>(nextHandle++);
+	++livePipelineLayouts;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineLayout(VkDevice, VkPipelineLayout, VkAllocationCallbacks const *)
+{
+	--livePipelineLayouts;
+}
+
+namespace
+{
+	void testBindingOrder()
+	{
+		DescriptorSetLayoutDescription forward;
+		forward.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 16, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+
+		DescriptorSetLayoutDescription backward;
+		backward.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 16, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		CHECK(forward == backward);
+		CHECK(DescriptorSetLayoutDescriptionHash()(forward) == DescriptorSetLayoutDescriptionHash()(backward));
+
+		if (CHECK(backward.bindings.size() == 3))
+		{
+			CHECK(backward.bindings[0].binding == 0);
+			CHECK(backward.bindings[1].binding == 1);
+			CHECK(backward.bindings[2].binding == 4);
+		}
+	}
+
+	void testBindingInequality()
+	{
+		DescriptorSetLayoutDescription base;
+		base.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescription otherBinding;
+		otherBinding.addBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescription otherType;
+		otherType.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescription otherCount;
+		otherCount.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescription otherStages;
+		otherStages.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+		DescriptorSetLayoutDescription otherFlags = base;
+		otherFlags.flags = 1;
+
+		DescriptorSetLayoutDescription moreBindings = base;
+		moreBindings.addBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescriptionHash hash;
+		for (DescriptorSetLayoutDescription const *pOther : { &otherBinding, &otherType, &otherCount, &otherStages, &otherFlags, &moreBindings })
+		{
+			CHECK(!(base == *pOther));
+			// Not required of a hash, but these differences should all change it
+			CHECK(hash(base) != hash(*pOther));
+		}
+
+		DescriptorSetLayoutDescription copy = base;
+		CHECK(copy == base);
+		CHECK(hash(copy) == hash(base));
+		CHECK(DescriptorSetLayoutDescription() == DescriptorSetLayoutDescription());
+	}
+
+	void testPushConstantRangeOrder()
+	{
+		VkDescriptorSetLayout set0 = testutils::makeHandle<VkDescriptorSetLayout>(100);
+		VkDescriptorSetLayout set1 = testutils::makeHandle<VkDescriptorSetLayout>(101);
+
+		// Two stages at the same offset, so the ranges are sorted by stage as well
+		PipelineLayoutDescription forward;
+		forward.addSetLayout(set0).addSetLayout(set1)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, 16)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 64, 4);
+
+		PipelineLayoutDescription backward;
+		backward.addSetLayout(set0).addSetLayout(set1)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 64, 4)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, 16)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64);
+
+		CHECK(forward == backward);
+		CHECK(PipelineLayoutDescriptionHash()(forward) == PipelineLayoutDescriptionHash()(backward));
+
+		// Set layouts are in set order, which does matter
+		PipelineLayoutDescription swappedSets;
+		swappedSets.addSetLayout(set1).addSetLayout(set0)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, 16)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 64, 4);
+
+		CHECK(!(forward == swappedSets));
+		CHECK(PipelineLayoutDescriptionHash()(forward) != PipelineLayoutDescriptionHash()(swappedSets));
+
+		PipelineLayoutDescription otherSize = forward;
+		otherSize.pushConstantRanges.back().size = 8;
+		CHECK(!(forward == otherSize));
+		CHECK(PipelineLayoutDescriptionHash()(forward) != PipelineLayoutDescriptionHash()(otherSize));
+
+		PipelineLayoutDescription fewerRanges;
+		fewerRanges.addSetLayout(set0).addSetLayout(set1)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64);
+		CHECK(!(forward == fewerRanges));
+	}
+
+	void testCacheSharesLayouts()
+	{
+		VulkanLayoutCache cache;
+		cache.lazyInit(VK_NULL_HANDLE);
+
+		DescriptorSetLayoutDescription forward;
+		forward.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+		DescriptorSetLayoutDescription backward;
+		backward.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		DescriptorSetLayoutDescription other;
+		other.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+
+		VkDescriptorSetLayout setLayout = cache.getDescriptorSetLayout(forward);
+		CHECK(cache.getDescriptorSetLayout(backward) == setLayout);
+		CHECK(cache.getDescriptorSetLayout(other) != setLayout);
+		CHECK(cache.getDescriptorSetLayoutCount() == 2);
+
+		PipelineLayoutDescription first;
+		first.addSetLayout(setLayout)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64)
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 64, 4);
+
+		// As a rebuilt pipeline would ask for it, with the set layout looked up again
+		PipelineLayoutDescription second;
+		second.addSetLayout(cache.getDescriptorSetLayout(backward))
+			.addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 64, 4)
+			.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, 64);
+
+		createdPushConstantRangeCounts.clear();
+		VkPipelineLayout pipelineLayout = cache.getPipelineLayout(first);
+		CHECK(cache.getPipelineLayout(second) == pipelineLayout);
+		CHECK(cache.getPipelineLayoutCount() == 1);
+		CHECK(createdPushConstantRangeCounts.size() == 1 && createdPushConstantRangeCounts[0] == 2);
+
+		CHECK(liveSetLayouts == 2);
+		CHECK(livePipelineLayouts == 1);
+
+		cache.cleanUp();
+		CHECK(liveSetLayouts == 0);
+		CHECK(livePipelineLayouts == 0);
+		CHECK(cache.getDescriptorSetLayoutCount() == 0);
+		CHECK(cache.getPipelineLayoutCount() == 0);
+	}
+}
+
+int main()
+{
+	testBindingOrder();
+	testBindingInequality();
+	testPushConstantRangeOrder();
+	testCacheSharesLayouts();
+
+	return testutils::finish();
+}
\ No newline at end of file
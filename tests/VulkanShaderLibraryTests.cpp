@@ -0,0 +1,158 @@
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "VulkanShaderLibrary.h"
+
+/**
+ * Like the layout cache test, this runs without a device: the two module functions the library calls
+ *  are defined here, and track which made up modules are still alive.
+ */
+namespace
+{
+	uint64_t nextHandle = 1;
+	std::set<uint64_t> liveModules;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(
+	VkDevice, VkShaderModuleCreateInfo const *, VkAllocationCallbacks const *, VkShaderModule *pShaderModule)
+{
+	uint64_t value = nextHandle++;
+	*pShaderModule = testutils::makeHandle<VkShaderModule>(value);
+	liveModules.insert(value);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyShaderModule(VkDevice, VkShaderModule shaderModule, VkAllocationCallbacks const *)
+{
+	liveModules.erase(testutils::handleValue(shaderModule));
+}
+
+namespace
+{
+	// The header of a SPIR-V module followed by one word that makes it distinct
+	std::string writeSpirv(std::string const &name, uint32_t content)
+	{
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / "VulkanShaderLibraryTests";
+		std::filesystem::create_directories(directory);
+
+		std::string path = (directory / name).string();
+		uint32_t const words[] = { 0x07230203, 0x00010000, 0, 1, 0, content };
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<char const *>(words), sizeof(words));
+
+		return path;
+	}
+
+	void testSharedModules()
+	{
+		std::string first = writeSpirv("first.spv", 1);
+		std::string same = writeSpirv("same.spv", 1);
+		std::string other = writeSpirv("other.spv", 2);
+
+		VulkanShaderLibrary library;
+		library.lazyInit(VK_NULL_HANDLE);
+		library.preload({ first, same, other });
+
+		CHECK(library.getShaderModule(first) == library.getShaderModule(same));
+		CHECK(library.getShaderModule(first) != library.getShaderModule(other));
+		CHECK(library.getFileCount() == 3);
+		CHECK(library.getModuleCount() == 2);
+		CHECK(liveModules.size() == 2);
+
+		library.cleanUp();
+		CHECK(library.getFileCount() == 0);
+		CHECK(liveModules.empty());
+	}
+
+	void testRemove()
+	{
+		std::string first = writeSpirv("first.spv", 3);
+		std::string same = writeSpirv("same.spv", 3);
+		std::string other = writeSpirv("other.spv", 4);
+
+		VulkanShaderLibrary library;
+		library.lazyInit(VK_NULL_HANDLE);
+
+		VkShaderModule shared = library.getShaderModule(first);
+		library.getShaderModule(same);
+		library.getShaderModule(other);
+
+		// The module the first file brought is still used by the other file with its content
+		library.remove(first);
+		CHECK(library.getFileCount() == 2);
+		CHECK(library.getModuleCount() == 2);
+		CHECK(liveModules.count(testutils::handleValue(shared)) == 1);
+
+		// Unmapped, so on every platform it can be deleted now
+		CHECK(std::filesystem::remove(first));
+
+		// The cache must now compare against the remaining file's words. The removed ones are unmapped, and a
+		//  new mapping of other content likely takes their place.
+		std::string different = writeSpirv("different.spv", 5);
+		library.getShaderModule(different);
+
+		std::string again = writeSpirv("again.spv", 3);
+		CHECK(library.getShaderModule(again) == shared);
+		CHECK(library.getModuleCount() == 3);
+
+		library.remove(same);
+		library.remove(again);
+		library.remove(different);
+		CHECK(library.getModuleCount() == 1);
+		CHECK(liveModules.count(testutils::handleValue(shared)) == 0);
+
+		// Files the library doesn't know are ignored, failed loads have no module to destroy
+		library.remove(first);
+		std::string missing = (std::filesystem::temp_directory_path() / "VulkanShaderLibraryTests" / "missing.spv").string();
+		library.preload({ missing });
+		library.remove(missing);
+		CHECK(library.getFileCount() == 1);
+
+		library.remove(other);
+		CHECK(library.getFileCount() == 0);
+		CHECK(library.getModuleCount() == 0);
+		CHECK(liveModules.empty());
+
+		library.cleanUp();
+	}
+
+	void testRemoveEmbedded()
+	{
+		static uint32_t const words[] = { 0x07230203, 0x00010000, 0, 1, 0, 5 };
+
+		VulkanShaderLibrary library;
+		library.lazyInit(VK_NULL_HANDLE);
+		library.addEmbedded("embedded.spv", words, sizeof(words) / sizeof(words[0]));
+
+		CHECK(library.getCode("embedded.spv").pWords == words);
+
+		library.remove("embedded.spv");
+		CHECK(library.getFileCount() == 0);
+		CHECK(liveModules.empty());
+
+		// The name can be taken again once removed
+		library.addEmbedded("embedded.spv", words, sizeof(words) / sizeof(words[0]));
+		CHECK(library.getShaderModule("embedded.spv") != VK_NULL_HANDLE);
+		CHECK(library.getModuleCount() == 1);
+
+		library.cleanUp();
+		CHECK(liveModules.empty());
+	}
+}
+
+int main()
+{
+	testSharedModules();
+	testRemove();
+	testRemoveEmbedded();
+
+	std::error_code error;
+	std::filesystem::remove_all(std::filesystem::temp_directory_path() / "VulkanShaderLibraryTests", error);
+
+	return testutils::finish();
+}
\ No newline at end of file
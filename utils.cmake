@@ -25,9 +25,144 @@ function(findVulkan)
 		set(VULKAN_SDK "VULKAN_SDK-NOTFOUND")
 	endif()
 
-	# TODO: Add glsl compiler program
+	findGlslCompiler()
 endfunction(findVulkan)
 
+# Find glslc, or glslangValidator, from the Vulkan SDK or the PATH and export it as GLSL_COMPILER. spirv-opt, which
+#  sets specialization constants' default values for shader variants, is exported as SPIRV_OPTIMIZER.
+function(findGlslCompiler)
+	set(SDK_BIN_DIRS "$ENV{VULKAN_SDK}/bin" "$ENV{VULKAN_SDK}/Bin")
+
+	find_program(GLSL_COMPILER NAMES glslc glslangValidator HINTS ${SDK_BIN_DIRS} DOC "GLSL to SPIR-V compiler")
+	find_program(SPIRV_OPTIMIZER NAMES spirv-opt HINTS ${SDK_BIN_DIRS} DOC "SPIR-V optimizer")
+
+	if(NOT GLSL_COMPILER)
+		message(STATUS "No GLSL compiler found, shaders use the SPIR-V checked in next to their sources")
+	endif()
+endfunction(findGlslCompiler)
+
+# Compile a GLSL shader to SPIR-V in the build tree, as part of building target. Call it once per variant of a shader,
+#  each with its own output name:
+#
+#  addShader(target SOURCE path/simple.frag OUTPUT frag_alpha.spv
+#      DEFINES ALPHA_TEST=1       # Preprocessor definitions
+#      SPEC_CONSTANTS 0=16)       # New default values of specialization constants, by constant_id
+#
+# The SPIR-V goes to ${CMAKE_BINARY_DIR}/shaders, which target loads its shaders from. Without a compiler the
+#  SPIR-V checked in next to the source under the output name is copied there instead, so variants need one.
+function(addShader target)
+	cmake_parse_arguments(SHADER "" "SOURCE;OUTPUT" "DEFINES;SPEC_CONSTANTS" ${ARGN})
+
+	if(NOT SHADER_SOURCE OR NOT SHADER_OUTPUT)
+		message(FATAL_ERROR "addShader needs a SOURCE and an OUTPUT.")
+	endif()
+
+	if(NOT DEFINED GLSL_COMPILER)
+		findGlslCompiler()
+	endif()
+
+	set(SHADER_OUTPUT_DIR "${CMAKE_BINARY_DIR}/shaders")
+	set(OUTPUT_FILE "${SHADER_OUTPUT_DIR}/${SHADER_OUTPUT}")
+
+	if(GLSL_COMPILER)
+		set(COMPILER_ARGS "")
+		get_filename_component(COMPILER_NAME "${GLSL_COMPILER}" NAME_WE)
+		if(COMPILER_NAME STREQUAL "glslangValidator")
+			list(APPEND COMPILER_ARGS "-V")
+		endif()
+		foreach(DEFINITION ${SHADER_DEFINES})
+			list(APPEND COMPILER_ARGS "-D${DEFINITION}")
+		endforeach()
+
+		set(COMMANDS COMMAND "${GLSL_COMPILER}" ${COMPILER_ARGS} "${SHADER_SOURCE}" -o "${OUTPUT_FILE}")
+
+		if(SHADER_SPEC_CONSTANTS)
+			if(NOT SPIRV_OPTIMIZER)
+				message(FATAL_ERROR "${SHADER_OUTPUT} sets specialization constants, which needs spirv-opt.")
+			endif()
+
+			string(REPLACE "=" ":" SPEC_CONSTANT_VALUES "${SHADER_SPEC_CONSTANTS}")
+			string(REPLACE ";" " " SPEC_CONSTANT_VALUES "${SPEC_CONSTANT_VALUES}")
+			list(APPEND COMMANDS COMMAND "${SPIRV_OPTIMIZER}" "--set-spec-const-default-value=${SPEC_CONSTANT_VALUES}"
+				"${OUTPUT_FILE}" -o "${OUTPUT_FILE}")
+		endif()
+
+		# The hot reload compiles with the same compiler
+		target_compile_definitions(${target} PRIVATE "VULKAN_RENDERER_GLSL_COMPILER=\"${GLSL_COMPILER}\"")
+	else()
+		if(SHADER_DEFINES OR SHADER_SPEC_CONSTANTS)
+			message(FATAL_ERROR "${SHADER_OUTPUT} is a shader variant, which needs a GLSL compiler.")
+		endif()
+
+		get_filename_component(SOURCE_DIR "${SHADER_SOURCE}" DIRECTORY)
+		set(COMMANDS COMMAND ${CMAKE_COMMAND} -E copy "${SOURCE_DIR}/${SHADER_OUTPUT}" "${OUTPUT_FILE}")
+	endif()
+
+	add_custom_command(
+		OUTPUT "${OUTPUT_FILE}"
+		COMMAND ${CMAKE_COMMAND} -E make_directory "${SHADER_OUTPUT_DIR}"
+		${COMMANDS}
+		DEPENDS "${SHADER_SOURCE}"
+		COMMENT "Compiling shader ${SHADER_OUTPUT}"
+		VERBATIM
+	)
+
+	# Being a source of target is what makes building target run the command
+	target_sources(${target} PRIVATE "${OUTPUT_FILE}")
+	target_compile_definitions(${target} PRIVATE "VULKAN_RENDERER_SHADER_DIR=\"${SHADER_OUTPUT_DIR}/\"")
+	set_property(TARGET ${target} APPEND PROPERTY SHADER_OUTPUTS "${OUTPUT_FILE}")
+endfunction(addShader)
+
+# Compile every shader added to target so far into it, as the word arrays of a generated EmbeddedShaders.h, so that
+#  it doesn't read them at start up. See embedShaders.cmake.
+function(embedShaders target)
+	get_property(SHADER_FILES TARGET ${target} PROPERTY SHADER_OUTPUTS)
+	set(SHADER_OUTPUT_DIR "${CMAKE_BINARY_DIR}/shaders")
+	set(HEADER_FILE "${SHADER_OUTPUT_DIR}/EmbeddedShaders.h")
+
+	add_custom_command(
+		OUTPUT "${HEADER_FILE}"
+		COMMAND ${CMAKE_COMMAND} "-DSHADER_FILES=${SHADER_FILES}" "-DHEADER_FILE=${HEADER_FILE}"
+			-P "${PROJECT_SOURCE_DIR}/embedShaders.cmake"
+		DEPENDS ${SHADER_FILES} "${PROJECT_SOURCE_DIR}/embedShaders.cmake"
+		COMMENT "Embedding shaders in EmbeddedShaders.h"
+		VERBATIM
+	)
+
+	target_sources(${target} PRIVATE "${HEADER_FILE}")
+	target_include_directories(${target} PRIVATE "${SHADER_OUTPUT_DIR}")
+	target_compile_definitions(${target} PRIVATE VULKAN_RENDERER_EMBEDDED_SHADERS)
+endfunction(embedShaders)
+
+# Build a CTest executable from the given sources. Tests build only the renderer sources they exercise, and neither
+#  Vulkan nor GLFW, so they run without a GPU or a display:
+#
+#  addTest(MeshletBuilderTests SOURCES tests/MeshletBuilderTests.cpp src/MeshletBuilder.cpp
+#      GLM                        # Sources use glm
+#      VULKAN_HEADERS)            # Sources include vulkan.h for its types, nothing is linked
+function(addTest name)
+	cmake_parse_arguments(TEST "GLM;VULKAN_HEADERS" "" "SOURCES" ${ARGN})
+
+	add_executable(${name} ${TEST_SOURCES})
+	target_include_directories(${name} PRIVATE "${PROJECT_SOURCE_DIR}/include" "${PROJECT_SOURCE_DIR}/tests")
+
+	if(TEST_GLM)
+		linkGLM(${name})
+	endif()
+
+	if(TEST_VULKAN_HEADERS)
+		if(NOT DEFINED Vulkan_INCLUDE_DIR)
+			findVulkan()
+		endif()
+		target_include_directories(${name} PRIVATE ${Vulkan_INCLUDE_DIR})
+	endif()
+
+	find_package(Threads REQUIRED)
+	target_link_libraries(${name} PRIVATE Threads::Threads)
+
+	add_test(NAME ${name} COMMAND ${name})
+endfunction(addTest)
+
 function(setupVulkan target)
 	if(NOT DEFINED Vulkan_INCLUDE_DIR OR NOT DEFINED Vulkan_LIBRARY)
 		findVulkan()